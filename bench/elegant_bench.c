@@ -0,0 +1,360 @@
+/*
+ * Elegant - Benchmark harness
+ *
+ * Times the collection and memory hot paths across input sizes and prints
+ * one JSON document on stdout (progress goes to stderr):
+ *
+ *   elegant_bench [--filter SUBSTRING] [--max-size N] [--min-time-ms MS]
+ *
+ * Each case is run in batches that double until a batch takes at least the
+ * minimum time; the last batch is reported. Allocation counts cover every
+ * allocation the library makes through its allocator.
+ */
+
+#define _POSIX_C_SOURCE 200112L  /* clock_gettime */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/* Counting allocator layered over libc */
+static size_t bench_allocs;
+static size_t bench_alloc_bytes;
+
+static void* bench_alloc(void* ctx, size_t size) {
+    (void)ctx;
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return elegant_libc_allocator.alloc(elegant_libc_allocator.ctx, size);
+}
+
+static void* bench_calloc(void* ctx, size_t size) {
+    (void)ctx;
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return elegant_libc_allocator.calloc(elegant_libc_allocator.ctx, size);
+}
+
+static void* bench_alloc_aligned(void* ctx, size_t size, size_t alignment) {
+    (void)ctx;
+    bench_allocs++;
+    bench_alloc_bytes += size;
+    return elegant_libc_allocator.alloc_aligned(elegant_libc_allocator.ctx, size, alignment);
+}
+
+static void* bench_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    (void)ctx;
+    bench_allocs++;
+    if (new_size > old_size) bench_alloc_bytes += new_size - old_size;
+    return elegant_libc_allocator.realloc(elegant_libc_allocator.ctx, ptr, old_size, new_size);
+}
+
+static void bench_free(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    elegant_libc_allocator.free(elegant_libc_allocator.ctx, ptr, size);
+}
+
+static const elegant_allocator_t bench_allocator = {
+    bench_alloc, bench_calloc, bench_alloc_aligned, bench_realloc, bench_free, NULL
+};
+
+/* Shared inputs for one size */
+typedef struct bench_input {
+    size_t size;
+    elegant_array_t* ints;
+    elegant_array_t* ints2;
+    elegant_array_t* doubles;
+} bench_input_t;
+
+static volatile long bench_sink;
+
+/* Callbacks */
+static int inc_int(int x) { return x + 1; }
+static int is_even_int(int x) { return (x & 1) == 0; }
+static int add_int(int a, int b) { return a + b; }
+static double scale_double(double x) { return x * 1.5; }
+static int positive_double(double x) { return x > 0.0; }
+static double add_double(double a, double b) { return a + b; }
+
+static void* inc_generic(void* p) {
+    static int out;
+    out = *(int*)p + 1;
+    return &out;
+}
+
+static void inc_into(void* out, void* in) {
+    *(int*)out = *(int*)in + 1;
+}
+
+static int is_even_generic(void* p) {
+    return (*(int*)p & 1) == 0;
+}
+
+static void* add_generic(void* acc, void* x) {
+    static int out;
+    out = *(int*)acc + *(int*)x;
+    return &out;
+}
+
+/* Cases: one operation per call */
+static size_t run_map_int(const bench_input_t* in) {
+    elegant_array_destroy(elegant_map_int(in->ints, inc_int));
+    return in->size;
+}
+
+static size_t run_filter_int(const bench_input_t* in) {
+    elegant_array_destroy(elegant_filter_int(in->ints, is_even_int));
+    return in->size;
+}
+
+static size_t run_reduce_int(const bench_input_t* in) {
+    bench_sink += elegant_reduce_int(in->ints, add_int, 0);
+    return in->size;
+}
+
+static size_t run_map_double(const bench_input_t* in) {
+    elegant_array_destroy(elegant_map_double(in->doubles, scale_double));
+    return in->size;
+}
+
+static size_t run_filter_double(const bench_input_t* in) {
+    elegant_array_destroy(elegant_filter_double(in->doubles, positive_double));
+    return in->size;
+}
+
+static size_t run_reduce_double(const bench_input_t* in) {
+    bench_sink += (long)elegant_reduce_double(in->doubles, add_double, 0.0);
+    return in->size;
+}
+
+static size_t run_map_generic(const bench_input_t* in) {
+    elegant_array_destroy(elegant_map_generic(in->ints, inc_generic, sizeof(int)));
+    return in->size;
+}
+
+static size_t run_map_into_generic(const bench_input_t* in) {
+    elegant_array_destroy(elegant_map_into_generic(in->ints, inc_into, sizeof(int), sizeof(int)));
+    return in->size;
+}
+
+static size_t run_filter_generic(const bench_input_t* in) {
+    elegant_array_destroy(elegant_filter_generic(in->ints, is_even_generic, sizeof(int)));
+    return in->size;
+}
+
+static size_t run_reduce_generic(const bench_input_t* in) {
+    int initial = 0;
+    int* result = elegant_reduce_generic(in->ints, add_generic, &initial, sizeof(int));
+    if (result) {
+        bench_sink += *result;
+        if (result != &initial) free(result);
+    }
+    return in->size;
+}
+
+static size_t run_concat(const bench_input_t* in) {
+    elegant_array_destroy(elegant_concat_arrays(2, in->ints, in->ints2));
+    return 2 * in->size;
+}
+
+static size_t run_zip(const bench_input_t* in) {
+    elegant_array_destroy(elegant_zip(in->ints, in->ints2, add_generic, sizeof(int)));
+    return in->size;
+}
+
+static size_t run_take(const bench_input_t* in) {
+    elegant_array_destroy(elegant_take(in->ints, in->size / 2));
+    return in->size / 2;
+}
+
+static size_t run_drop(const bench_input_t* in) {
+    elegant_array_destroy(elegant_drop(in->ints, in->size / 2));
+    return in->size - in->size / 2;
+}
+
+/* size = arrays created inside one scope */
+static size_t run_scope(const bench_input_t* in) {
+    ELEGANT_SCOPE {
+        for (size_t i = 0; i < in->size; i++) {
+            elegant_array_create(sizeof(int), 4);
+        }
+    }
+    return in->size;
+}
+
+static size_t run_arena_scope(const bench_input_t* in) {
+    ELEGANT_ARENA_SCOPE {
+        for (size_t i = 0; i < in->size; i++) {
+            elegant_array_create(sizeof(int), 4);
+        }
+    }
+    return in->size;
+}
+
+/* size = block bytes; one element per allocation */
+static size_t run_libc_malloc(const bench_input_t* in) {
+    char* p = malloc(in->size);
+    if (p) p[0] = 1;
+    free(p);
+    return 1;
+}
+
+static size_t run_safe_malloc(const bench_input_t* in) {
+    char* p = elegant_safe_malloc(in->size);
+    if (p) p[0] = 1;
+    elegant_safe_free(p);
+    return 1;
+}
+
+typedef struct bench_case {
+    const char* name;
+    size_t (*run)(const bench_input_t* in);  /* returns elements processed */
+    size_t max_size;                         /* 0 for every size */
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    { "map_int",          run_map_int,          0 },
+    { "filter_int",       run_filter_int,       0 },
+    { "reduce_int",       run_reduce_int,       0 },
+    { "map_double",       run_map_double,       0 },
+    { "filter_double",    run_filter_double,    0 },
+    { "reduce_double",    run_reduce_double,    0 },
+    { "map_generic",      run_map_generic,      0 },
+    { "map_into_generic", run_map_into_generic, 0 },
+    { "filter_generic",   run_filter_generic,   0 },
+    { "reduce_generic",   run_reduce_generic,   0 },
+    { "concat",           run_concat,           0 },
+    { "zip",              run_zip,              0 },
+    { "take",             run_take,             0 },
+    { "drop",             run_drop,             0 },
+    { "scope",            run_scope,            100000 },
+    { "arena_scope",      run_arena_scope,      100000 },
+    { "libc_malloc",      run_libc_malloc,      0 },
+    { "safe_malloc",      run_safe_malloc,      0 },
+};
+
+static const size_t bench_sizes[] = { 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool bench_input_init(bench_input_t* in, size_t size) {
+    in->size = size;
+    in->ints = elegant_array_create_uninit(sizeof(int), size);
+    in->ints2 = elegant_array_create_uninit(sizeof(int), size);
+    in->doubles = elegant_array_create_uninit(sizeof(double), size);
+    if (!in->ints || !in->ints2 || !in->doubles) return false;
+
+    int* a = elegant_array_get_mutable_data(in->ints);
+    int* b = elegant_array_get_mutable_data(in->ints2);
+    double* d = elegant_array_get_mutable_data(in->doubles);
+    for (size_t i = 0; i < size; i++) {
+        a[i] = (int)i;
+        b[i] = (int)(size - i);
+        d[i] = (double)i - (double)size / 2;
+    }
+    return true;
+}
+
+static void bench_input_free(bench_input_t* in) {
+    elegant_array_destroy(in->ints);
+    elegant_array_destroy(in->ints2);
+    elegant_array_destroy(in->doubles);
+}
+
+static void bench_run_case(const bench_case_t* c, const bench_input_t* in,
+                           uint64_t min_time_ns, bool* first) {
+    size_t elements = c->run(in);  /* warm-up */
+    size_t iterations = 1;
+    uint64_t elapsed;
+    size_t allocs, bytes;
+
+    for (;;) {
+        bench_allocs = 0;
+        bench_alloc_bytes = 0;
+        uint64_t start = bench_now();
+        for (size_t i = 0; i < iterations; i++) {
+            c->run(in);
+        }
+        elapsed = bench_now() - start;
+        allocs = bench_allocs;
+        bytes = bench_alloc_bytes;
+        if (elapsed >= min_time_ns || iterations >= ((size_t)1 << 30)) break;
+        iterations *= 2;
+    }
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    printf("%s\n    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %zu, "
+           "\"ns_per_op\": %.1f, \"ns_per_element\": %.3f, "
+           "\"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}",
+           *first ? "" : ",", c->name, in->size, iterations,
+           ns_per_op, elements ? ns_per_op / (double)elements : 0.0,
+           (double)allocs / (double)iterations, (double)bytes / (double)iterations);
+    *first = false;
+    fprintf(stderr, "  %-18s %9zu  %12.1f ns/op  %8.3f ns/element\n", c->name, in->size,
+            ns_per_op, elements ? ns_per_op / (double)elements : 0.0);
+}
+
+static void bench_usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--filter SUBSTRING] [--max-size N] [--min-time-ms MS]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    size_t max_size = 10000000;
+    uint64_t min_time_ns = 100 * 1000000u;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            min_time_ns = strtoull(argv[++i], NULL, 10) * 1000000u;
+        } else {
+            bench_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    elegant_set_memory_mode(ELEGANT_MEMORY_STACK_ARENA);
+
+    printf("{\n  \"library\": \"elegant\",\n  \"version\": \"%d.%d.%d\",\n"
+           "  \"timestamp\": %lld,\n  \"min_time_ms\": %llu,\n  \"results\": [",
+           ELEGANT_VERSION_MAJOR, ELEGANT_VERSION_MINOR, ELEGANT_VERSION_PATCH,
+           (long long)time(NULL), (unsigned long long)(min_time_ns / 1000000u));
+
+    bool first = true;
+    size_t case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+
+    for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+        size_t size = bench_sizes[s];
+        if (size > max_size) break;
+
+        bench_input_t in;
+        if (!bench_input_init(&in, size)) {
+            fprintf(stderr, "Elegant: Failed to allocate benchmark input of %zu elements\n", size);
+            bench_input_free(&in);
+            return 1;
+        }
+
+        elegant_set_allocator(&bench_allocator);
+        for (size_t c = 0; c < case_count; c++) {
+            const bench_case_t* bc = &bench_cases[c];
+            if (bc->max_size && size > bc->max_size) continue;
+            if (filter && !strstr(bc->name, filter)) continue;
+            bench_run_case(bc, &in, min_time_ns, &first);
+        }
+        elegant_set_allocator(NULL);
+
+        bench_input_free(&in);
+    }
+
+    printf("\n  ]\n}\n");
+    return 0;
+}
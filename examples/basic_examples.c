@@ -170,14 +170,14 @@ void example_memory_modes(void) {
     elegant_array_t* shared_arr = elegant_create_array_int(10, 20, 30);
     printf("Created shared array, memory: %zu bytes\n", elegant_get_allocated_bytes());
     
-    elegant_array_t* view1 = elegant_array_copy(shared_arr);  // Increases ref count
-    elegant_array_t* view2 = elegant_array_copy(shared_arr);  // Increases ref count
+    elegant_array_t* view1 = elegant_array_copy(shared_arr);  // Shares the payload
+    elegant_array_t* view2 = elegant_array_copy(shared_arr);  // Shares the payload
     printf("Created 2 views, memory: %zu bytes\n", elegant_get_allocated_bytes());
     
-    elegant_array_destroy(view1);  // Decreases ref count
+    elegant_array_destroy(view1);  // Releases its share
     printf("Destroyed view1, memory: %zu bytes\n", elegant_get_allocated_bytes());
     
-    elegant_array_destroy(view2);  // Decreases ref count
+    elegant_array_destroy(view2);  // Releases its share
     printf("Destroyed view2, memory: %zu bytes\n", elegant_get_allocated_bytes());
     
     elegant_array_destroy(shared_arr);  // Actually frees memory
@@ -175,7 +175,12 @@ int test_memory_management(void) {
     elegant_array_t* copy1 = elegant_array_copy(arr);
     elegant_array_t* copy2 = elegant_array_copy(arr);
     
-    TEST_ASSERT(arr == copy1 && arr == copy2, "Reference counting shares same pointer");
+    TEST_ASSERT(arr != copy1 && copy1 != copy2, "Copies are separate handles");
+    TEST_ASSERT(ELEGANT_GET(copy1, 2, int) == 3, "Copy shares the source's elements");
+    
+    ELEGANT_SET(copy1, 0, 42, int);
+    TEST_ASSERT(ELEGANT_GET(arr, 0, int) == 1 && ELEGANT_GET(copy2, 0, int) == 1,
+                "Writing a copy leaves the others unchanged");
     
     elegant_array_destroy(copy1);
     elegant_array_destroy(copy2);
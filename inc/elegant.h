@@ -45,8 +45,19 @@ extern "C" {
 #endif
 
 /* Configuration macros */
+
+/* Default length limit for new arrays, 0 for none; see elegant_set_max_array_size */
 #ifndef ELEGANT_MAX_ARRAY_SIZE
-#define ELEGANT_MAX_ARRAY_SIZE 1000
+#define ELEGANT_MAX_ARRAY_SIZE 0
+#endif
+
+/* Payloads of this size or more get their own huge-page aligned buffer */
+#ifndef ELEGANT_HUGE_PAGE_SIZE
+#define ELEGANT_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+#ifndef ELEGANT_CACHE_LINE_SIZE
+#define ELEGANT_CACHE_LINE_SIZE 64
 #endif
 
 #ifndef ELEGANT_MAX_STACK_ALLOC
@@ -57,7 +68,8 @@ extern "C" {
 typedef enum {
     ELEGANT_MEMORY_STACK_ARENA = 0,
     ELEGANT_MEMORY_REFERENCE_COUNTING = 1,
-    ELEGANT_MEMORY_GARBAGE_COLLECTION = 2
+    ELEGANT_MEMORY_GARBAGE_COLLECTION = 2,
+    ELEGANT_MEMORY_SHARED_REFERENCE_COUNTING = 3  /* reference counting, atomic refcounts */
 } elegant_memory_mode_t;
 
 /* Global memory mode (thread-local) */
@@ -68,32 +80,143 @@ void elegant_set_memory_mode(elegant_memory_mode_t mode);
 elegant_memory_mode_t elegant_get_memory_mode(void);
 size_t elegant_get_allocated_bytes(void);
 
+struct elegant_arena;
+struct elegant_allocator;
+
 /* Array structure - internal representation */
-typedef struct {
+typedef struct elegant_array {
     void* data;
     size_t length;
     size_t element_size;
     size_t capacity;
-    int ref_count;
+    int ref_count;                 /* Atomic when memory_mode is SHARED_REFERENCE_COUNTING */
+    unsigned int flags;            /* ELEGANT_ARRAY_* storage flags */
+    elegant_memory_mode_t memory_mode; /* Mode the array was created under */
     void (*destructor)(void*);
+    struct elegant_array* parent;  /* Retained owner of data for views, NULL if data is owned */
+    struct elegant_array* payload; /* Hidden header its views and copies hold, until it is written */
+    size_t block_size;             /* Bytes of the header's own block once data has spilled out */
+    struct elegant_arena* arena;   /* Scope arena holding header and data, NULL if heap-owned */
+    const struct elegant_allocator* allocator; /* Owner of the block(s), NULL for arena arrays */
 } elegant_array_t;
 
+/* Array storage flags */
+#define ELEGANT_ARRAY_INLINE_DATA 0x1u  /* data shares the header's allocation */
+#define ELEGANT_ARRAY_SPILLED     0x2u  /* data outgrew the header's allocation */
+#define ELEGANT_ARRAY_MAPPED      0x4u  /* data is a private file mapping, unmapped on destroy */
+#define ELEGANT_ARRAY_READONLY    0x8u  /* mapped pages not yet made writable */
+#define ELEGANT_ARRAY_RANDOM_ACCESS 0x10u  /* no read-ahead hints on scans */
+#define ELEGANT_ARRAY_GC_MARK     0x20u  /* reached in the collector's current cycle */
+#define ELEGANT_ARRAY_GC_TRACED   0x40u  /* collected view holding no reference on its owner */
+#define ELEGANT_ARRAY_SCOPED      0x80u  /* registered with a scope frame, which owns its reference */
+#define ELEGANT_ARRAY_PAYLOAD     0x100u /* hidden header keeping a shared payload alive for its readers */
+
+/* Runtime length limit (process-wide), 0 for none */
+void elegant_set_max_array_size(size_t max_length);
+size_t elegant_get_max_array_size(void);
+
 /* Core array operations */
 elegant_array_t* elegant_array_create(size_t element_size, size_t length);
+elegant_array_t* elegant_array_create_uninit(size_t element_size, size_t length);
 void elegant_array_destroy(elegant_array_t* arr);
+/* O(1) copy-on-write copy where possible: the payload is shared until either side is written */
 elegant_array_t* elegant_array_copy(elegant_array_t* arr);
 void* elegant_array_get_data(elegant_array_t* arr);
+void* elegant_array_get_mutable_data(elegant_array_t* arr);
 size_t elegant_array_get_length(elegant_array_t* arr);
 
+/*
+ * Speculative outputs: room for `capacity` elements, filled in one pass and
+ * then trimmed to the produced length. Large unused tails are handed back.
+ */
+elegant_array_t* elegant_array_create_output(size_t element_size, size_t capacity);
+void elegant_array_finish_output(elegant_array_t* arr, size_t length);
+
+/*
+ * Growable arrays: appends grow capacity geometrically (amortized O(1)).
+ * Views are detached and sources still being read are copied first. Return 0, or EINVAL/ENOMEM with arr unchanged.
+ */
+int elegant_array_reserve(elegant_array_t* arr, size_t capacity);
+int elegant_array_push(elegant_array_t* arr, const void* element);
+int elegant_array_extend(elegant_array_t* arr, const void* elements, size_t count);
+int elegant_array_extend_array(elegant_array_t* arr, elegant_array_t* other);
+int elegant_array_shrink_to_fit(elegant_array_t* arr);
+
+/*
+ * Builders accumulate elements in a bare buffer from the current allocator;
+ * finish hands the buffer to a new array without copying and resets the builder.
+ */
+typedef struct elegant_array_builder {
+    char* data;
+    size_t length;
+    size_t capacity;
+    size_t element_size;
+    const struct elegant_allocator* allocator;
+} elegant_array_builder_t;
+
+void elegant_builder_init(elegant_array_builder_t* builder, size_t element_size, size_t capacity);
+int elegant_builder_reserve(elegant_array_builder_t* builder, size_t additional);
+int elegant_builder_extend(elegant_array_builder_t* builder, const void* elements, size_t count);
+elegant_array_t* elegant_builder_finish(elegant_array_builder_t* builder);
+void elegant_builder_discard(elegant_array_builder_t* builder);
+
+static inline int elegant_builder_push(elegant_array_builder_t* builder, const void* element) {
+    if (builder->length == builder->capacity) {
+        int err = elegant_builder_reserve(builder, 1);
+        if (err) return err;
+    }
+    memcpy(builder->data + builder->length * builder->element_size, element, builder->element_size);
+    builder->length++;
+    return 0;
+}
+
+/*
+ * Memory-mapped arrays: data points into a private, read-only mapping of
+ * the whole file (a trailing partial element is dropped). The first
+ * mutable access makes it writable; the kernel then copies only written
+ * pages and the file is never modified. Scans hint sequential read-ahead.
+ */
+#define ELEGANT_MAP_WILLNEED 0x1u  /* start reading the whole file in now */
+#define ELEGANT_MAP_POPULATE 0x2u  /* fault every page in before returning */
+#define ELEGANT_MAP_RANDOM   0x4u  /* skip read-ahead hints on scans */
+
+elegant_array_t* elegant_array_map_file(const char* path, size_t element_size, unsigned int flags);
+/*
+ * `length` elements from a page-aligned offset of an open file; fd may be
+ * closed after. Fails with EINVAL if the range runs past the end of the file.
+ */
+elegant_array_t* elegant_array_map_fd(int fd, size_t offset, size_t element_size,
+                                      size_t length, unsigned int flags);
+bool elegant_array_is_mapped(const elegant_array_t* arr);
+void elegant_array_advise_scan(const elegant_array_t* arr);
+
+/*
+ * Zero-copy views: share the source's payload until either side is written.
+ * The source is left as it was, so several threads may slice it at once.
+ */
+elegant_array_t* elegant_array_slice(elegant_array_t* arr, size_t offset, size_t length);
+bool elegant_array_is_view(const elegant_array_t* arr);
+
 /* Include sub-headers */
 #include "elegant_core.h"
 #include "elegant_collection.h"
+#include "elegant_simd.h"
+#include "elegant_parallel.h"
 #include "elegant_advanced.h"
 #include "elegant_memory.h"
 #include "elegant_maybe.h"
 #include "elegant_either.h"
 #include "elegant_scope.h"
 #include "elegant_safety.h"
+#include "elegant_serialize.h"
+#include "elegant_stream.h"
+#include "elegant_stats.h"
+#include "elegant_inline.h"
+#include "elegant_table.h"
+#include "elegant_sort.h"
+#include "elegant_group.h"
+#include "elegant_pipeline.h"
+#include "elegant_reduce.h"
 
 #ifdef __cplusplus
 }
@@ -49,8 +49,10 @@ elegant_array_t* elegant_reverse_int(elegant_array_t* arr);
     _multiply_partial; \
 })
 
-/* Chaining macro for elegant function composition */
-#define CHAIN(arr, ...) elegant_chain_operations(arr, ##__VA_ARGS__)
+/* Maximum number of stages accepted by one CHAIN call */
+#ifndef ELEGANT_CHAIN_MAX_OPS
+#define ELEGANT_CHAIN_MAX_OPS 32
+#endif
 
 /* Array processing chain helpers */
 typedef struct {
@@ -62,6 +64,39 @@ typedef struct {
     } op;
 } chain_operation_t;
 
+/* Chain stage constructors - each yields a chain_operation_t* for CHAIN */
+#define CHAIN_OP_MAP(expr) (&(chain_operation_t){ \
+    .type = CHAIN_MAP, \
+    .op.map.func = ({ int _chain_map(int x) { return (expr); } _chain_map; }) \
+})
+#define CHAIN_OP_FILTER(cond) (&(chain_operation_t){ \
+    .type = CHAIN_FILTER, \
+    .op.filter.predicate = ({ int _chain_filter(int x) { return (cond); } _chain_filter; }) \
+})
+#define CHAIN_OP_TAKE(count) (&(chain_operation_t){ .type = CHAIN_TAKE, .op.take_drop.n = (count) })
+#define CHAIN_OP_DROP(count) (&(chain_operation_t){ .type = CHAIN_DROP, .op.take_drop.n = (count) })
+
+/*
+ * Lazy fused pipeline: the stages are applied to each element in a single
+ * pass with one output allocation, and the pass stops as soon as a TAKE
+ * stage is exhausted.
+ *
+ *   AUTO(out, CHAIN(arr, CHAIN_OP_MAP(x * 3), CHAIN_OP_FILTER(x % 2), CHAIN_OP_TAKE(10)));
+ */
+#define CHAIN(arr, ...) elegant_chain_operations(arr, ##__VA_ARGS__, NULL)
+
+#define CHAIN_REDUCE_INT(arr, expr, initial, ...) ({ \
+    int _reduce_func(int acc, int x) { return (expr); } \
+    elegant_chain_reduce_int((arr), _reduce_func, (initial), ##__VA_ARGS__, NULL); \
+})
+
+/* Variadic forms take chain_operation_t* stages terminated by NULL */
 elegant_array_t* elegant_chain_operations(elegant_array_t* arr, ...);
+int elegant_chain_reduce_int(elegant_array_t* arr, int (*func)(int, int), int initial, ...);
+
+/* Descriptor forms run a prebuilt array of stages */
+elegant_array_t* elegant_chain_run(elegant_array_t* arr, const chain_operation_t* ops, size_t count);
+int elegant_chain_reduce_run(elegant_array_t* arr, const chain_operation_t* ops, size_t count,
+                             int (*func)(int, int), int initial);
 
 #endif /* ELEGANT_COLLECTION_ADVANCED_H */
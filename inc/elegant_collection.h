@@ -8,21 +8,24 @@
 
 /* Core generic function implementations */
 elegant_array_t* elegant_map_generic(elegant_array_t* src, void* (*func)(void*), size_t element_size);
+/* Mapper writes its result straight into the destination slot */
+elegant_array_t* elegant_map_into_generic(elegant_array_t* src, void (*func)(void* out, void* in),
+                                          size_t src_element_size, size_t dst_element_size);
 elegant_array_t* elegant_filter_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size);
 void* elegant_reduce_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size);
 void* elegant_fold_left_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size);
 void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size);
 
 /* Generic MAP macro - works with any type */
-#define MAP(arr, expr, type) ({ \
-    void* _map_func(void* elem_ptr) { \
-        type x = *(type*)elem_ptr; \
-        static __thread type _temp_result; \
-        _temp_result = (expr); \
-        return &_temp_result; \
+#define MAP(arr, expr, type) MAP_TO(arr, expr, type, type)
+
+/* MAP_TO - map into a different element type, e.g. record -> field */
+#define MAP_TO(arr, expr, in_type, out_type) ({ \
+    void _map_func(void* out_ptr, void* elem_ptr) { \
+        in_type x = *(in_type*)elem_ptr; \
+        *(out_type*)out_ptr = (expr); \
     } \
-    elegant_array_t* _result = elegant_map_generic((arr), _map_func, sizeof(type)); \
-    _result; \
+    elegant_map_into_generic((arr), _map_func, sizeof(in_type), sizeof(out_type)); \
 })
 
 /* Generic FILTER macro - works with any type */
@@ -34,10 +37,79 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
     elegant_filter_generic((arr), _filter_func, sizeof(type)); \
 })
 
+/*
+ * Destination variants: results go into dst's existing capacity and its
+ * length is set, so steady-state loops never allocate. Return 0, EINVAL,
+ * or ENOSPC when dst is too small; FILTER needs room for every source
+ * element. dst may be the source array itself for in-place updates.
+ */
+int elegant_map_into_array(elegant_array_t* dst, elegant_array_t* src, void (*func)(void* out, void* in),
+                           size_t src_element_size, size_t dst_element_size);
+int elegant_filter_into_array(elegant_array_t* dst, elegant_array_t* src, int (*predicate)(void*), size_t element_size);
+
+#define MAP_INTO(dst, arr, expr, type) MAP_TO_INTO(dst, arr, expr, type, type)
+
+#define MAP_TO_INTO(dst, arr, expr, in_type, out_type) ({ \
+    void _map_func(void* out_ptr, void* elem_ptr) { \
+        in_type x = *(in_type*)elem_ptr; \
+        *(out_type*)out_ptr = (expr); \
+    } \
+    elegant_map_into_array((dst), (arr), _map_func, sizeof(in_type), sizeof(out_type)); \
+})
+
+#define FILTER_INTO(dst, arr, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_filter_into_array((dst), (arr), _filter_func, sizeof(type)); \
+})
+
+#define MAP_INPLACE(arr, expr, type) ({ \
+    elegant_array_t* _inplace_arr = (arr); \
+    MAP_INTO(_inplace_arr, _inplace_arr, expr, type); \
+})
+
+#define FILTER_INPLACE(arr, predicate, type) ({ \
+    elegant_array_t* _inplace_arr = (arr); \
+    FILTER_INTO(_inplace_arr, _inplace_arr, predicate, type); \
+})
+
+/*
+ * Selection outputs for FILTER: a vector of passing indices (size_t) or a
+ * bitmap with bit i of word i/64 set when element i passes (uint64_t).
+ * GATHER/COMPRESS materialise them later, or not at all.
+ */
+#define ELEGANT_BITMAP_WORDS(length) (((length) + 63) / 64)
+
+elegant_array_t* elegant_filter_select_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size);
+elegant_array_t* elegant_filter_bitmap_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size);
+elegant_array_t* elegant_array_gather(elegant_array_t* src, elegant_array_t* selection);
+elegant_array_t* elegant_array_compress(elegant_array_t* src, elegant_array_t* bitmap);
+
+#define FILTER_SELECT(arr, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_filter_select_generic((arr), _filter_func, sizeof(type)); \
+})
+
+#define FILTER_BITMAP(arr, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_filter_bitmap_generic((arr), _filter_func, sizeof(type)); \
+})
+
+#define GATHER(arr, selection) elegant_array_gather((arr), (selection))
+#define COMPRESS(arr, bitmap) elegant_array_compress((arr), (bitmap))
+
 /* Generic REDUCE macro - works with any type */
 #define REDUCE(arr, func_expr, initial, type) ({ \
     void* _reduce_func(void* acc_ptr, void* elem_ptr) { \
-        static type _temp_result; \
+        static __thread type _temp_result; \
         type acc = *(type*)acc_ptr; \
         type x = *(type*)elem_ptr; \
         _temp_result = (func_expr); \
@@ -45,13 +117,15 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
     } \
     type _initial = (initial); \
     type* _result = (type*)elegant_reduce_generic((arr), _reduce_func, &_initial, sizeof(type)); \
-    _result ? *_result : _initial; \
+    type _value = _result ? *_result : _initial; \
+    if (_result && _result != &_initial) free(_result); \
+    _value; \
 })
 
 /* FOLD_LEFT - fold from left to right */
 #define FOLD_LEFT(arr, func_expr, initial, type) ({ \
     void* _fold_func(void* acc_ptr, void* elem_ptr) { \
-        static type _temp_result; \
+        static __thread type _temp_result; \
         type acc = *(type*)acc_ptr; \
         type x = *(type*)elem_ptr; \
         _temp_result = (func_expr); \
@@ -59,13 +133,15 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
     } \
     type _initial = (initial); \
     type* _result = (type*)elegant_fold_left_generic((arr), _fold_func, &_initial, sizeof(type)); \
-    _result ? *_result : _initial; \
+    type _value = _result ? *_result : _initial; \
+    if (_result && _result != &_initial) free(_result); \
+    _value; \
 })
 
 /* FOLD_RIGHT - fold from right to left */
 #define FOLD_RIGHT(arr, func_expr, initial, type) ({ \
     void* _fold_func(void* elem_ptr, void* acc_ptr) { \
-        static type _temp_result; \
+        static __thread type _temp_result; \
         type x = *(type*)elem_ptr; \
         type acc = *(type*)acc_ptr; \
         _temp_result = (func_expr); \
@@ -73,7 +149,9 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
     } \
     type _initial = (initial); \
     type* _result = (type*)elegant_fold_right_generic((arr), _fold_func, &_initial, sizeof(type)); \
-    _result ? *_result : _initial; \
+    type _value = _result ? *_result : _initial; \
+    if (_result && _result != &_initial) free(_result); \
+    _value; \
 })
 
 /* PIPE operator for function composition - supports up to 5 functions */
@@ -127,7 +205,8 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
 
 #define REDUCE_INT(arr, expr, initial) ({ \
     int _reduce_func(int acc, int x) { return (expr); } \
-    elegant_reduce_int((arr), _reduce_func, (initial)); \
+    ELEGANT_IS_SUM_EXPR(expr) ? elegant_sum_int((arr), (initial)) : \
+        elegant_reduce_int((arr), _reduce_func, (initial)); \
 })
 #define REDUCE_FLOAT(arr, expr, initial) ({ \
     float _reduce_func(float acc, float x) { return (expr); } \
@@ -162,9 +241,104 @@ elegant_array_t* elegant_reverse(elegant_array_t* arr);
 /* ZIP - combine two arrays element-wise */
 elegant_array_t* elegant_zip(elegant_array_t* arr1, elegant_array_t* arr2, void* (*combiner)(void*, void*), size_t result_element_size);
 
+/*
+ * Batched ZIP family: the callback gets a tile of `count` consecutive
+ * elements from every input and output, and the macros loop over it with
+ * typed pointers, so the compiler sees plain array loops it can vectorize.
+ */
+#ifndef ELEGANT_ZIP_TILE_BYTES
+#define ELEGANT_ZIP_TILE_BYTES (16 * 1024)  /* one tile's rows over all arrays */
+#endif
+#define ELEGANT_ZIP_MAX_ARRAYS 8            /* inputs of a zip, outputs of an unzip */
+
+typedef void (*elegant_zip_batch_t)(void* const* out, const void* const* in, size_t count);
+
+/* Zips the common prefix of the inputs; element_sizes (may be NULL) are checked against them */
+elegant_array_t* elegant_zip_batch(elegant_array_t* const* inputs, const size_t* element_sizes, size_t count,
+                                   elegant_zip_batch_t batch, size_t result_element_size);
+int elegant_zip_batch_into(elegant_array_t* dst, elegant_array_t* const* inputs, const size_t* element_sizes,
+                           size_t count, elegant_zip_batch_t batch, size_t result_element_size);
+/* Fills outputs[0..count) with new arrays, or leaves them NULL and returns EINVAL/ENOMEM */
+int elegant_unzip_batch(elegant_array_t* src, size_t element_size, elegant_array_t** outputs,
+                        const size_t* output_sizes, size_t count, elegant_zip_batch_t batch);
+
 #define ZIP(arr1, arr2, expr, type1, type2, result_type) ({ \
-    result_type _zip_func(type1 a, type2 b) { return (expr); } \
-    elegant_zip((arr1), (arr2), (void*(*)(void*,void*))_zip_func, sizeof(result_type)); \
+    void _zip_batch(void* const* _zip_out, const void* const* _zip_in, size_t _zip_count) { \
+        const type1* _zip_a = (const type1*)_zip_in[0]; \
+        const type2* _zip_b = (const type2*)_zip_in[1]; \
+        result_type* _zip_r = (result_type*)_zip_out[0]; \
+        for (size_t _zip_i = 0; _zip_i < _zip_count; _zip_i++) { \
+            type1 a = _zip_a[_zip_i]; \
+            type2 b = _zip_b[_zip_i]; \
+            (void)a; (void)b; \
+            _zip_r[_zip_i] = (expr); \
+        } \
+    } \
+    elegant_array_t* _zip_arrays[] = { (arr1), (arr2) }; \
+    const size_t _zip_sizes[] = { sizeof(type1), sizeof(type2) }; \
+    elegant_zip_batch(_zip_arrays, _zip_sizes, 2, _zip_batch, sizeof(result_type)); \
+})
+
+/* ZIP3 - as ZIP, with a third input as c */
+#define ZIP3(arr1, arr2, arr3, expr, type1, type2, type3, result_type) ({ \
+    void _zip_batch(void* const* _zip_out, const void* const* _zip_in, size_t _zip_count) { \
+        const type1* _zip_a = (const type1*)_zip_in[0]; \
+        const type2* _zip_b = (const type2*)_zip_in[1]; \
+        const type3* _zip_c = (const type3*)_zip_in[2]; \
+        result_type* _zip_r = (result_type*)_zip_out[0]; \
+        for (size_t _zip_i = 0; _zip_i < _zip_count; _zip_i++) { \
+            type1 a = _zip_a[_zip_i]; \
+            type2 b = _zip_b[_zip_i]; \
+            type3 c = _zip_c[_zip_i]; \
+            (void)a; (void)b; (void)c; \
+            _zip_r[_zip_i] = (expr); \
+        } \
+    } \
+    elegant_array_t* _zip_arrays[] = { (arr1), (arr2), (arr3) }; \
+    const size_t _zip_sizes[] = { sizeof(type1), sizeof(type2), sizeof(type3) }; \
+    elegant_zip_batch(_zip_arrays, _zip_sizes, 3, _zip_batch, sizeof(result_type)); \
+})
+
+/* UNZIP - split each element x into two new arrays; out1/out2 are elegant_array_t** */
+#define UNZIP(arr, expr1, expr2, type, type1, type2, out1, out2) ({ \
+    void _zip_batch(void* const* _zip_out, const void* const* _zip_in, size_t _zip_count) { \
+        const type* _zip_x = (const type*)_zip_in[0]; \
+        type1* _zip_r1 = (type1*)_zip_out[0]; \
+        type2* _zip_r2 = (type2*)_zip_out[1]; \
+        for (size_t _zip_i = 0; _zip_i < _zip_count; _zip_i++) { \
+            type x = _zip_x[_zip_i]; \
+            (void)x; \
+            _zip_r1[_zip_i] = (expr1); \
+            _zip_r2[_zip_i] = (expr2); \
+        } \
+    } \
+    elegant_array_t* _zip_outputs[2]; \
+    const size_t _zip_sizes[] = { sizeof(type1), sizeof(type2) }; \
+    int _zip_err = elegant_unzip_batch((arr), sizeof(type), _zip_outputs, _zip_sizes, 2, _zip_batch); \
+    *(out1) = _zip_outputs[0]; \
+    *(out2) = _zip_outputs[1]; \
+    _zip_err; \
+})
+
+int elegant_zip_into_array(elegant_array_t* dst, elegant_array_t* arr1, elegant_array_t* arr2,
+                           void* (*combiner)(void*, void*), size_t result_element_size);
+
+/* ZIP_INTO - zip into dst's existing capacity, see MAP_INTO */
+#define ZIP_INTO(dst, arr1, arr2, expr, type1, type2, result_type) ({ \
+    void _zip_batch(void* const* _zip_out, const void* const* _zip_in, size_t _zip_count) { \
+        const type1* _zip_a = (const type1*)_zip_in[0]; \
+        const type2* _zip_b = (const type2*)_zip_in[1]; \
+        result_type* _zip_r = (result_type*)_zip_out[0]; \
+        for (size_t _zip_i = 0; _zip_i < _zip_count; _zip_i++) { \
+            type1 a = _zip_a[_zip_i]; \
+            type2 b = _zip_b[_zip_i]; \
+            (void)a; (void)b; \
+            _zip_r[_zip_i] = (expr); \
+        } \
+    } \
+    elegant_array_t* _zip_arrays[] = { (arr1), (arr2) }; \
+    const size_t _zip_sizes[] = { sizeof(type1), sizeof(type2) }; \
+    elegant_zip_batch_into((dst), _zip_arrays, _zip_sizes, 2, _zip_batch, sizeof(result_type)); \
 })
 
 /* TAKE - take first n elements */
@@ -175,19 +349,29 @@ elegant_array_t* elegant_drop(elegant_array_t* arr, size_t n);
 
 /* FIND - find first element matching predicate (returns pointer or NULL) */
 #define FIND(arr, predicate, type) ({ \
-    int _find_func(type x) { return (predicate); } \
-    void* _result = elegant_find_generic((arr), (int(*)(void*))_find_func, sizeof(type)); \
-    _result ? (type*)_result : NULL; \
+    int _find_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    (type*)elegant_find_generic((arr), _find_func, sizeof(type)); \
 })
 
 void* elegant_find_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size);
 
-/* CONCAT - concatenate multiple arrays into a new array */
+/*
+ * CONCAT - concatenate arrays into a new one. NULL or empty entries are
+ * skipped; the rest must share an element size. Outputs of
+ * ELEGANT_CONCAT_PARALLEL_MIN bytes or more are copied on the thread pool.
+ */
+#ifndef ELEGANT_CONCAT_PARALLEL_MIN
+#define ELEGANT_CONCAT_PARALLEL_MIN (1024 * 1024)  /* bytes */
+#endif
+
+elegant_array_t* elegant_concat_array_list(elegant_array_t* const* arrays, size_t count);
 elegant_array_t* elegant_concat_arrays(size_t count, ...);
 
-#define ELEGANT_CONCAT(...) elegant_concat_arrays( \
-    sizeof((elegant_array_t*[]){__VA_ARGS__}) / sizeof(elegant_array_t*), \
-    __VA_ARGS__)
+#define ELEGANT_CONCAT(...) elegant_concat_array_list((elegant_array_t*[]){__VA_ARGS__}, \
+    sizeof((elegant_array_t*[]){__VA_ARGS__}) / sizeof(elegant_array_t*))
 
 /* Helper functions for array operations */
 elegant_array_t* elegant_map_int(elegant_array_t* src, int (*func)(int));
@@ -36,6 +36,7 @@ elegant_array_t* elegant_create_array_impl(size_t element_size, void* data, size
 /* Array accessor macros */
 #define ELEGANT_LENGTH(arr) elegant_array_get_length(arr)
 #define ELEGANT_RAW_PTR(arr) elegant_array_get_data(arr)
+#define ELEGANT_MUTABLE_PTR(arr) elegant_array_get_mutable_data(arr)
 
 /* Type-generic array element access */
 #define ELEGANT_GET(arr, index, type) \
@@ -43,16 +44,27 @@ elegant_array_t* elegant_create_array_impl(size_t element_size, void* data, size
 
 #define ELEGANT_SET(arr, index, value, type) \
     do { \
-        ((type*)elegant_array_get_data(arr))[index] = (value); \
+        ((type*)elegant_array_get_mutable_data(arr))[index] = (value); \
     } while(0)
 
+/* Typed appends: value is converted to type first */
+#define ELEGANT_PUSH(arr, value, type) ({ \
+    type _push_value = (value); \
+    elegant_array_push((arr), &_push_value); \
+})
+
+#define ELEGANT_BUILDER_PUSH(builder, value, type) ({ \
+    type _push_value = (value); \
+    elegant_builder_push((builder), &_push_value); \
+})
+
 /* Static assertions for compile-time checks */
 #define ELEGANT_STATIC_ASSERT(cond) \
     _Static_assert(cond, #cond)
 
 /* Array size checking */
 #define ELEGANT_CHECK_ARRAY_SIZE(size) \
-    ELEGANT_STATIC_ASSERT(size <= ELEGANT_MAX_ARRAY_SIZE)
+    ELEGANT_STATIC_ASSERT(ELEGANT_MAX_ARRAY_SIZE == 0 || (size) <= ELEGANT_MAX_ARRAY_SIZE)
 
 /* Safe memory copy function */
 int elegant_memcpy_safe(void* dest, size_t dest_size, const void* src, size_t copy_size);
@@ -0,0 +1,78 @@
+#ifndef ELEGANT_GROUP_H
+#define ELEGANT_GROUP_H
+
+/*
+ * Hash aggregation: GROUP_BY, COUNT_BY and DISTINCT over any element type.
+ * Groups live in an open-addressing table whose one-byte control tags are
+ * probed 16 at a time (SSE2 where available); keys and aggregates sit in
+ * dense arrays in first-appearance order, which is also the result order.
+ * Large inputs are radix-partitioned by hash and the partitions aggregated
+ * in parallel on the thread pool, with the same result order.
+ *
+ * Keys are hashed and compared bytewise, so struct keys must not contain
+ * padding.
+ */
+
+#ifndef ELEGANT_GROUP_PARALLEL_MIN
+#define ELEGANT_GROUP_PARALLEL_MIN (256 * 1024)  /* elements */
+#endif
+
+typedef struct elegant_group_spec {
+    size_t key_size;
+    void (*key)(void* key, const void* element);      /* NULL: the element is the key */
+    size_t value_size;                                 /* 0: count only */
+    void (*value)(void* value, const void* element);  /* NULL: the element is the value */
+    /* Folds a value into a group's aggregate, which starts as the group's
+       first value; values arrive in element order in both modes */
+    void (*combine)(void* aggregate, const void* value);
+} elegant_group_spec_t;
+
+typedef struct elegant_groups {
+    elegant_array_t* keys;     /* one per group */
+    elegant_array_t* values;   /* aggregate per group, NULL for count-only specs */
+    elegant_array_t* counts;   /* size_t elements per group */
+} elegant_groups_t;
+
+/* Return 0, or EINVAL/ENOMEM with groups zeroed */
+int elegant_group_by(elegant_array_t* src, const elegant_group_spec_t* spec, elegant_groups_t* groups);
+void elegant_groups_destroy(elegant_groups_t* groups);
+
+/* Unique elements in first-appearance order */
+elegant_array_t* elegant_distinct(elegant_array_t* src);
+
+/*
+ * x is the element in key_expr/value_expr; combine_expr sees the aggregate
+ * as acc and the next value as x, as in REDUCE.
+ */
+#define GROUP_BY(arr, key_expr, value_expr, combine_expr, type, key_type, value_type, groups) ({ \
+    void _group_key(void* key_ptr, const void* elem_ptr) { \
+        type x = *(const type*)elem_ptr; \
+        *(key_type*)key_ptr = (key_expr); \
+    } \
+    void _group_value(void* value_ptr, const void* elem_ptr) { \
+        type x = *(const type*)elem_ptr; \
+        *(value_type*)value_ptr = (value_expr); \
+    } \
+    void _group_combine(void* acc_ptr, const void* value_ptr) { \
+        value_type acc = *(value_type*)acc_ptr; \
+        value_type x = *(const value_type*)value_ptr; \
+        *(value_type*)acc_ptr = (combine_expr); \
+    } \
+    elegant_group_spec_t _group_spec = { \
+        sizeof(key_type), _group_key, sizeof(value_type), _group_value, _group_combine \
+    }; \
+    elegant_group_by((arr), &_group_spec, (groups)); \
+})
+
+#define COUNT_BY(arr, key_expr, type, key_type, groups) ({ \
+    void _group_key(void* key_ptr, const void* elem_ptr) { \
+        type x = *(const type*)elem_ptr; \
+        *(key_type*)key_ptr = (key_expr); \
+    } \
+    elegant_group_spec_t _group_spec = { sizeof(key_type), _group_key, 0, NULL, NULL }; \
+    elegant_group_by((arr), &_group_spec, (groups)); \
+})
+
+#define DISTINCT(arr) elegant_distinct(arr)
+
+#endif /* ELEGANT_GROUP_H */
@@ -0,0 +1,147 @@
+#ifndef ELEGANT_INLINE_H
+#define ELEGANT_INLINE_H
+
+/*
+ * Header-only typed kernels. The expression is expanded straight into the
+ * loop at the call site, so there is no nested function, no indirect call
+ * per element and no trampoline (hence no executable stack), and the
+ * compiler is free to inline and vectorize the whole loop.
+ *
+ * Element types are registered once per translation unit with
+ * ELEGANT_DEFINE_OPS(name, type); `name` is a plain token so struct types
+ * work too. int, float and double are registered here.
+ *
+ *     ELEGANT_DEFINE_OPS(point, struct point)
+ *     elegant_array_t* moved = MAP_INLINE(point, pts, ((struct point){ x.x + dx, x.y }));
+ *     double total = REDUCE_INLINE(double, values, acc + x * weight, 0.0);
+ *
+ * As with MAP and FILTER, the element is `x` and the accumulator `acc`.
+ * Floating-point reductions keep their sequential order, so they only
+ * vectorize when the compiler is allowed to reassociate (-ffast-math).
+ */
+
+/* Element type of a registered name */
+#define ELEGANT_OPS_TYPE(name) elegant_##name##_ops_t
+
+/* MAP_TO_INLINE - map into another registered type, e.g. record -> field */
+#define MAP_TO_INLINE(in_name, out_name, arr, expr) ({ \
+    elegant_array_t* _inl_src = (arr); \
+    elegant_array_t* _inl_result = NULL; \
+    if (_inl_src) { \
+        elegant_array_advise_scan(_inl_src); \
+        elegant_op_probe_t _inl_probe = elegant_stats_begin(); \
+        size_t _inl_len = elegant_array_get_length(_inl_src); \
+        const ELEGANT_OPS_TYPE(in_name)* __restrict__ _inl_in = elegant_array_get_data(_inl_src); \
+        if (_inl_in || _inl_len == 0) { \
+            _inl_result = elegant_array_create_uninit(sizeof(ELEGANT_OPS_TYPE(out_name)), _inl_len); \
+        } \
+        if (_inl_result) { \
+            ELEGANT_OPS_TYPE(out_name)* __restrict__ _inl_out = elegant_array_get_data(_inl_result); \
+            for (size_t _inl_i = 0; _inl_i < _inl_len; _inl_i++) { \
+                ELEGANT_OPS_TYPE(in_name) x = _inl_in[_inl_i]; \
+                _inl_out[_inl_i] = (expr); \
+            } \
+            elegant_stats_end(&_inl_probe, ELEGANT_OP_MAP, _inl_len); \
+        } \
+    } \
+    _inl_result; \
+})
+
+#define MAP_INLINE(name, arr, expr) MAP_TO_INLINE(name, name, arr, expr)
+
+/* Branch-free compaction: every element is stored, only passing ones advance */
+#define FILTER_INLINE(name, arr, predicate) ({ \
+    elegant_array_t* _inl_src = (arr); \
+    elegant_array_t* _inl_result = NULL; \
+    if (_inl_src) { \
+        elegant_array_advise_scan(_inl_src); \
+        elegant_op_probe_t _inl_probe = elegant_stats_begin(); \
+        size_t _inl_len = elegant_array_get_length(_inl_src); \
+        const ELEGANT_OPS_TYPE(name)* __restrict__ _inl_in = elegant_array_get_data(_inl_src); \
+        if (_inl_in || _inl_len == 0) { \
+            _inl_result = elegant_array_create_output(sizeof(ELEGANT_OPS_TYPE(name)), _inl_len); \
+        } \
+        if (_inl_result) { \
+            ELEGANT_OPS_TYPE(name)* __restrict__ _inl_out = elegant_array_get_data(_inl_result); \
+            size_t _inl_count = 0; \
+            for (size_t _inl_i = 0; _inl_i < _inl_len; _inl_i++) { \
+                ELEGANT_OPS_TYPE(name) x = _inl_in[_inl_i]; \
+                _inl_out[_inl_count] = x; \
+                _inl_count += (predicate) ? 1 : 0; \
+            } \
+            elegant_array_finish_output(_inl_result, _inl_count); \
+            elegant_stats_end(&_inl_probe, ELEGANT_OP_FILTER, _inl_len); \
+        } \
+    } \
+    _inl_result; \
+})
+
+/* Left fold from `initial`; a NULL array yields `initial` */
+#define REDUCE_INLINE(name, arr, expr, initial) ({ \
+    elegant_array_t* _inl_src = (arr); \
+    ELEGANT_OPS_TYPE(name) acc = (initial); \
+    if (_inl_src) { \
+        elegant_array_advise_scan(_inl_src); \
+        elegant_op_probe_t _inl_probe = elegant_stats_begin(); \
+        size_t _inl_len = elegant_array_get_length(_inl_src); \
+        const ELEGANT_OPS_TYPE(name)* __restrict__ _inl_in = elegant_array_get_data(_inl_src); \
+        if (_inl_in) { \
+            for (size_t _inl_i = 0; _inl_i < _inl_len; _inl_i++) { \
+                ELEGANT_OPS_TYPE(name) x = _inl_in[_inl_i]; \
+                acc = (expr); \
+            } \
+            elegant_stats_end(&_inl_probe, ELEGANT_OP_REDUCE, _inl_len); \
+        } \
+    } \
+    acc; \
+})
+
+/* Pointer to the first passing element inside the array, or NULL */
+#define FIND_INLINE(name, arr, predicate) ({ \
+    elegant_array_t* _inl_src = (arr); \
+    const ELEGANT_OPS_TYPE(name)* _inl_found = NULL; \
+    if (_inl_src) { \
+        elegant_op_probe_t _inl_probe = elegant_stats_begin(); \
+        size_t _inl_len = elegant_array_get_length(_inl_src); \
+        const ELEGANT_OPS_TYPE(name)* _inl_in = elegant_array_get_data(_inl_src); \
+        size_t _inl_i = 0; \
+        if (_inl_in) { \
+            for (; _inl_i < _inl_len; _inl_i++) { \
+                ELEGANT_OPS_TYPE(name) x = _inl_in[_inl_i]; \
+                if (predicate) { \
+                    _inl_found = &_inl_in[_inl_i]; \
+                    break; \
+                } \
+            } \
+            elegant_stats_end(&_inl_probe, ELEGANT_OP_FIND, _inl_found ? _inl_i + 1 : _inl_len); \
+        } \
+    } \
+    (ELEGANT_OPS_TYPE(name)*)_inl_found; \
+})
+
+/*
+ * Registers `type` under `name` and emits typed entry points taking plain
+ * functions, elegant_<name>_map/filter/reduce/find. Passing a static
+ * function lets the compiler inline it into the loop, unlike the library's
+ * out-of-line elegant_map_int and friends.
+ */
+#define ELEGANT_DEFINE_OPS(name, type) \
+    typedef type ELEGANT_OPS_TYPE(name); \
+    static inline elegant_array_t* elegant_##name##_map(elegant_array_t* src, type (*func)(type)) { \
+        return func ? MAP_INLINE(name, src, func(x)) : NULL; \
+    } \
+    static inline elegant_array_t* elegant_##name##_filter(elegant_array_t* src, int (*predicate)(type)) { \
+        return predicate ? FILTER_INLINE(name, src, predicate(x)) : NULL; \
+    } \
+    static inline type elegant_##name##_reduce(elegant_array_t* src, type (*func)(type, type), type initial) { \
+        return func ? REDUCE_INLINE(name, src, func(acc, x), initial) : initial; \
+    } \
+    static inline type* elegant_##name##_find(elegant_array_t* src, int (*predicate)(type)) { \
+        return predicate ? FIND_INLINE(name, src, predicate(x)) : NULL; \
+    }
+
+ELEGANT_DEFINE_OPS(int, int)
+ELEGANT_DEFINE_OPS(float, float)
+ELEGANT_DEFINE_OPS(double, double)
+
+#endif /* ELEGANT_INLINE_H */
@@ -1,6 +1,8 @@
 #ifndef ELEGANT_MEMORY_H
 #define ELEGANT_MEMORY_H
 
+#include <stdint.h>
+
 /*
  * Memory management system with multiple strategies
  */
@@ -8,12 +10,32 @@
 /* Memory management macros */
 #define ELEGANT_SET_MODE(mode) elegant_set_memory_mode(ELEGANT_MEMORY_##mode)
 
+/* Default size of one arena chunk; larger requests get a dedicated chunk */
+#ifndef ELEGANT_ARENA_CHUNK_SIZE
+#define ELEGANT_ARENA_CHUNK_SIZE (64 * 1024)
+#endif
+
+/* Bump-pointer arena made of chained chunks, newest first */
+typedef struct elegant_arena_chunk {
+    struct elegant_arena_chunk* next;
+    size_t size;
+    size_t used;
+    const struct elegant_allocator* allocator;  /* Allocator the chunk came from */
+} elegant_arena_chunk_t;
+
+typedef struct elegant_arena {
+    elegant_arena_chunk_t* head;
+    size_t bytes_used;
+} elegant_arena_t;
+
 /* Scope-based memory management */
 typedef struct elegant_scope_frame {
     elegant_array_t** allocations;
     size_t allocation_count;
     size_t allocation_capacity;
     struct elegant_scope_frame* parent;
+    elegant_arena_t* arena;  /* Non-NULL for arena frames */
+    const struct elegant_allocator* outer_allocator;  /* Current at entry, restored on exit */
 } elegant_scope_frame_t;
 
 /* Thread-local scope stack */
@@ -30,10 +52,81 @@ void elegant_scope_register(elegant_array_t* array);
          _scope_init; \
          _scope_init = 0, elegant_scope_exit())
 
+/*
+ * Arena scopes: in ELEGANT_MEMORY_STACK_ARENA mode, arrays created inside
+ * the scope are bump-allocated (header and payload together) from chunks
+ * owned by the frame, and the whole arena is released at once on exit.
+ * Arena arrays never outlive their scope, whatever their ref_count, and
+ * their destructors only run on an explicit elegant_array_destroy.
+ */
+void elegant_scope_enter_arena(void);
+void* elegant_scope_alloc(size_t size);
+
+#define ELEGANT_ARENA_SCOPE \
+    for (int _scope_init = (elegant_scope_enter_arena(), 1); \
+         _scope_init; \
+         _scope_init = 0, elegant_scope_exit())
+
+/*
+ * Allocator scopes: arrays, views and scratch created inside the scope come
+ * from `allocator`; the previous allocator is restored on exit.
+ */
+void elegant_scope_enter_allocator(const struct elegant_allocator* allocator);
+
+#define ELEGANT_ALLOCATOR_SCOPE(allocator) \
+    for (int _scope_init = (elegant_scope_enter_allocator(allocator), 1); \
+         _scope_init; \
+         _scope_init = 0, elegant_scope_exit())
+
 /* Reference counting support */
 elegant_array_t* elegant_array_retain(elegant_array_t* arr);
 void elegant_array_release(elegant_array_t* arr);
 
+/*
+ * Switch an array (and the owner of a view) to atomic reference counting so
+ * other threads may retain and release it. Returns arr, or NULL for arena arrays.
+ */
+elegant_array_t* elegant_array_share(elegant_array_t* arr);
+bool elegant_array_is_shared(const elegant_array_t* arr);
+
+/*
+ * Garbage collection: arrays created in ELEGANT_MEMORY_GARBAGE_COLLECTION
+ * mode are owned by their thread's incremental mark-sweep collector.
+ * An array created inside a scope is rooted until that scope exits; one
+ * created outside any scope starts pinned by its creator. Retaining pins,
+ * releasing or destroying unpins, and unrooted unpinned arrays are freed
+ * (destructor included) over later safepoints: scope exits and
+ * elegant_gc_step. Each step stops once the pause budget is spent.
+ */
+#ifndef ELEGANT_GC_THRESHOLD
+#define ELEGANT_GC_THRESHOLD (4 * 1024 * 1024)  /* bytes allocated between cycles, at least */
+#endif
+
+#ifndef ELEGANT_GC_PAUSE_BUDGET_NS
+#define ELEGANT_GC_PAUSE_BUDGET_NS 1000000      /* 1ms per step */
+#endif
+
+typedef struct elegant_gc_stats {
+    size_t collections;       /* completed cycles */
+    size_t steps;             /* slices of collector work */
+    size_t tracked_arrays;    /* arrays currently owned by the collector */
+    size_t live_bytes;        /* kept by the last completed cycle */
+    size_t freed_arrays;
+    size_t freed_bytes;
+    uint64_t total_pause_ns;
+    uint64_t max_pause_ns;
+} elegant_gc_stats_t;
+
+/* True while a cycle is still in progress */
+bool elegant_gc_step(void);
+/* Full collection now, whatever the budget */
+void elegant_gc_collect(void);
+void elegant_gc_set_threshold(size_t bytes);
+void elegant_gc_set_pause_budget(uint64_t nanoseconds);  /* 0 for no limit */
+elegant_array_t* elegant_gc_pin(elegant_array_t* arr);
+void elegant_gc_unpin(elegant_array_t* arr);
+void elegant_gc_get_stats(elegant_gc_stats_t* stats);
+
 /* Memory debugging support */
 #ifdef ELEGANT_DEBUG_MEMORY
 void elegant_memory_debug_dump(void);
@@ -43,10 +136,42 @@ size_t elegant_memory_debug_get_allocations(void);
 #define ELEGANT_MEMORY_DEBUG_DUMP() do {} while(0)
 #endif
 
-/* Memory allocation wrappers */
+/*
+ * Pluggable allocator. Every allocation the core makes goes through the
+ * calling thread's current allocator, and each block is handed back to the
+ * allocator that produced it. alloc must return memory aligned like malloc.
+ * Sizes passed to realloc and free are the requested sizes, or 0 when the
+ * caller does not know them. calloc may be NULL (alloc + memset is used).
+ */
+typedef struct elegant_allocator {
+    void* (*alloc)(void* ctx, size_t size);
+    void* (*calloc)(void* ctx, size_t size);
+    void* (*alloc_aligned)(void* ctx, size_t size, size_t alignment);
+    void* (*realloc)(void* ctx, void* ptr, size_t old_size, size_t new_size);
+    void (*free)(void* ctx, void* ptr, size_t size);
+    void* ctx;
+} elegant_allocator_t;
+
+/* The default: malloc, calloc, posix_memalign, realloc and free */
+extern const elegant_allocator_t elegant_libc_allocator;
+
+/* Thread-local; NULL restores the libc allocator. Scopes restore it on exit. */
+void elegant_set_allocator(const elegant_allocator_t* allocator);
+const elegant_allocator_t* elegant_get_allocator(void);
+
+/*
+ * Memory allocation wrappers. Blocks record their size and allocator, so
+ * elegant_realloc and elegant_free need neither; pass them only blocks from
+ * these three, and free elegant_alloc_aligned blocks with elegant_free_sized.
+ */
 void* elegant_malloc(size_t size);
 void* elegant_calloc(size_t nmemb, size_t size);
 void* elegant_realloc(void* ptr, size_t size);
 void elegant_free(void* ptr);
 
+/* alignment must be a power of two; the size given back must be the one requested */
+void* elegant_alloc_aligned(size_t size, size_t alignment);
+void elegant_free_sized(void* ptr, size_t size);
+size_t elegant_get_freed_bytes(void);
+
 #endif /* ELEGANT_MEMORY_H */
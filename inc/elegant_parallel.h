@@ -0,0 +1,87 @@
+#ifndef ELEGANT_PARALLEL_H
+#define ELEGANT_PARALLEL_H
+
+/*
+ * Parallel collection operations on a persistent worker pool
+ * Arrays are split into cache-sized blocks; idle workers steal blocks
+ * from the ranges of busy ones.
+ */
+
+#ifndef ELEGANT_PAR_BLOCK_BYTES
+#define ELEGANT_PAR_BLOCK_BYTES (32 * 1024)  /* roughly one L1 data cache */
+#endif
+
+#ifndef ELEGANT_PAR_MAX_THREADS
+#define ELEGANT_PAR_MAX_THREADS 256
+#endif
+
+/*
+ * Pool size: defaults to the online CPU count (or ELEGANT_THREADS from the
+ * environment). The calling thread counts as one of them, so a size of 1
+ * runs everything sequentially. Changing the size joins the current workers.
+ * Inside a parallel callback the reported size is 1, on workers and on the
+ * submitting thread alike, since nested calls run sequentially there.
+ */
+int elegant_parallel_set_threads(size_t threads);
+size_t elegant_parallel_get_threads(void);
+void elegant_parallel_shutdown(void);
+
+/*
+ * Run body(ctx, block) once for every block in [0, blocks) across the pool,
+ * returning once all have finished. Returns 0, or EAGAIN/ENOMEM without
+ * running anything when the caller should loop sequentially instead (a
+ * single-thread pool, or a call from inside a parallel callback).
+ */
+int elegant_parallel_for(size_t blocks, void (*body)(void* ctx, size_t block), void* ctx);
+
+/*
+ * Parallel counterparts of the generic operations. The callbacks run
+ * concurrently, so they must not write shared state; temporaries they return
+ * must be thread-local. Inputs smaller than two blocks, and calls made from
+ * inside a parallel callback, run sequentially on the calling thread.
+ */
+elegant_array_t* elegant_par_map_generic(elegant_array_t* src, void* (*func)(void*), size_t element_size);
+elegant_array_t* elegant_par_map_into_generic(elegant_array_t* src, void (*func)(void* out, void* in),
+                                              size_t src_element_size, size_t dst_element_size);
+elegant_array_t* elegant_par_filter_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size);
+
+/* func must be associative; blocks are combined pairwise in index order */
+void* elegant_par_reduce_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size);
+
+/* Parallel MAP macro */
+#define PAR_MAP(arr, expr, type) PAR_MAP_TO(arr, expr, type, type)
+
+#define PAR_MAP_TO(arr, expr, in_type, out_type) ({ \
+    void _map_func(void* out_ptr, void* elem_ptr) { \
+        in_type x = *(in_type*)elem_ptr; \
+        *(out_type*)out_ptr = (expr); \
+    } \
+    elegant_par_map_into_generic((arr), _map_func, sizeof(in_type), sizeof(out_type)); \
+})
+
+/* Parallel FILTER macro */
+#define PAR_FILTER(arr, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_par_filter_generic((arr), _filter_func, sizeof(type)); \
+})
+
+/* Parallel REDUCE macro - func_expr must be associative */
+#define PAR_REDUCE(arr, func_expr, initial, type) ({ \
+    void* _reduce_func(void* acc_ptr, void* elem_ptr) { \
+        static __thread type _temp_result; \
+        type acc = *(type*)acc_ptr; \
+        type x = *(type*)elem_ptr; \
+        _temp_result = (func_expr); \
+        return &_temp_result; \
+    } \
+    type _initial = (initial); \
+    type* _result = (type*)elegant_par_reduce_generic((arr), _reduce_func, &_initial, sizeof(type)); \
+    type _value = _result ? *_result : _initial; \
+    if (_result && _result != &_initial) free(_result); \
+    _value; \
+})
+
+#endif /* ELEGANT_PARALLEL_H */
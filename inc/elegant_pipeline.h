@@ -0,0 +1,82 @@
+#ifndef ELEGANT_PIPELINE_H
+#define ELEGANT_PIPELINE_H
+
+/*
+ * Overlapped pipelines: a stream source and each added stage run on their
+ * own thread, handing chunks downstream through SPSC rings. Every link
+ * owns a fixed pool of `depth` chunks which circulate between producer and
+ * consumer, so a slow stage holds the ones upstream back instead of
+ * letting memory grow. The calling thread consumes the last stage's
+ * output with next/drain, which starts the threads on first use.
+ */
+
+#ifndef ELEGANT_PIPELINE_DEPTH
+#define ELEGANT_PIPELINE_DEPTH 4  /* chunks per link when 0 is requested */
+#endif
+
+typedef struct elegant_pipeline elegant_pipeline_t;
+
+/*
+ * Transform `count` input elements into up to `capacity` output elements
+ * (capacity is the source's chunk length); return how many, or
+ * ELEGANT_STREAM_ERROR with errno set. Returning 0 drops the chunk.
+ */
+typedef size_t (*elegant_pipeline_stage_t)(void* ctx, const void* in, size_t count,
+                                           void* out, size_t capacity);
+
+/* Takes ownership of source, which is then read only by the pipeline's reader thread */
+elegant_pipeline_t* elegant_pipeline_create(elegant_stream_t* source, size_t depth);
+
+/* Append a stage; EINVAL if in_element_size isn't the current output size, EBUSY once started */
+int elegant_pipeline_stage(elegant_pipeline_t* pipeline, elegant_pipeline_stage_t stage, void* ctx,
+                           size_t in_element_size, size_t out_element_size);
+int elegant_pipeline_map_generic(elegant_pipeline_t* pipeline, void (*func)(void* out, void* in),
+                                 size_t src_element_size, size_t dst_element_size);
+int elegant_pipeline_filter_generic(elegant_pipeline_t* pipeline, int (*predicate)(void*),
+                                    size_t element_size);
+
+/*
+ * Next output chunk, or NULL at the end or on error. The chunk belongs to
+ * the pipeline and goes back to its pool on the next call.
+ */
+elegant_array_t* elegant_pipeline_next(elegant_pipeline_t* pipeline);
+
+/*
+ * Feed every remaining chunk to sink on the calling thread; a non-zero
+ * sink result stops the pipeline and becomes its error. Returns 0 or the
+ * first error of any stage.
+ */
+int elegant_pipeline_drain(elegant_pipeline_t* pipeline,
+                           int (*sink)(void* ctx, elegant_array_t* chunk), void* ctx);
+/* drain into a file descriptor, writing each chunk's bytes */
+int elegant_pipeline_drain_fd(elegant_pipeline_t* pipeline, int fd);
+elegant_array_t* elegant_pipeline_collect(elegant_pipeline_t* pipeline);
+
+int elegant_pipeline_error(const elegant_pipeline_t* pipeline);
+
+/* Stops any running stages, joins them and frees everything; returns the first error */
+int elegant_pipeline_close(elegant_pipeline_t* pipeline);
+
+/*
+ * As with STREAM_MAP, the callbacks are nested functions: close or drain
+ * the pipeline before the function that added them returns.
+ */
+#define PIPELINE_MAP(pipeline, expr, type) PIPELINE_MAP_TO(pipeline, expr, type, type)
+
+#define PIPELINE_MAP_TO(pipeline, expr, in_type, out_type) ({ \
+    void _map_func(void* out_ptr, void* elem_ptr) { \
+        in_type x = *(in_type*)elem_ptr; \
+        *(out_type*)out_ptr = (expr); \
+    } \
+    elegant_pipeline_map_generic((pipeline), _map_func, sizeof(in_type), sizeof(out_type)); \
+})
+
+#define PIPELINE_FILTER(pipeline, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_pipeline_filter_generic((pipeline), _filter_func, sizeof(type)); \
+})
+
+#endif /* ELEGANT_PIPELINE_H */
@@ -0,0 +1,70 @@
+#ifndef ELEGANT_REDUCE_H
+#define ELEGANT_REDUCE_H
+
+/*
+ * Reductions over an operator declared associative, and optionally also
+ * commutative, which frees them from the strict left fold of REDUCE:
+ *   ASSOCIATIVE  fixed blocks are reduced as pairwise trees, on the thread
+ *                pool when large, and the partials combined in index order.
+ *                For sums this bounds rounding growth at O(log n).
+ *   +COMMUTATIVE each block runs four interleaved accumulator chains
+ *                instead, for instruction-level parallelism.
+ * The typed variants block independently of the thread count, so any pool
+ * size gives identical results. Without ASSOCIATIVE all of these are the
+ * plain left fold.
+ */
+
+#define ELEGANT_REDUCE_ASSOCIATIVE 0x1u  /* (a op b) op c == a op (b op c) */
+#define ELEGANT_REDUCE_COMMUTATIVE 0x2u  /* a op b == b op a; used only with ASSOCIATIVE */
+
+#ifndef ELEGANT_REDUCE_PARALLEL_MIN
+#define ELEGANT_REDUCE_PARALLEL_MIN (128 * 1024)  /* elements */
+#endif
+
+int elegant_reduce_assoc_int(elegant_array_t* src, int (*func)(int, int), int initial, unsigned flags);
+float elegant_reduce_assoc_float(elegant_array_t* src, float (*func)(float, float), float initial,
+                                 unsigned flags);
+double elegant_reduce_assoc_double(elegant_array_t* src, double (*func)(double, double), double initial,
+                                   unsigned flags);
+
+/* elegant_par_reduce_generic when associative; result as for elegant_reduce_generic */
+void* elegant_reduce_assoc_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial,
+                                   size_t element_size, unsigned flags);
+
+/* Both flags make a spelled-out sum safe to hand to the vectorized kernels */
+#define ELEGANT_REDUCE_REORDERABLE(flags) \
+    (((flags) & (ELEGANT_REDUCE_ASSOCIATIVE | ELEGANT_REDUCE_COMMUTATIVE)) == \
+     (ELEGANT_REDUCE_ASSOCIATIVE | ELEGANT_REDUCE_COMMUTATIVE))
+
+#define REDUCE_ASSOC_INT(arr, expr, initial, flags) ({ \
+    int _reduce_func(int acc, int x) { return (expr); } \
+    ELEGANT_REDUCE_REORDERABLE(flags) && ELEGANT_IS_SUM_EXPR(expr) ? elegant_sum_int((arr), (initial)) : \
+        elegant_reduce_assoc_int((arr), _reduce_func, (initial), (flags)); \
+})
+#define REDUCE_ASSOC_FLOAT(arr, expr, initial, flags) ({ \
+    float _reduce_func(float acc, float x) { return (expr); } \
+    ELEGANT_REDUCE_REORDERABLE(flags) && ELEGANT_IS_SUM_EXPR(expr) ? elegant_sum_float((arr), (initial)) : \
+        elegant_reduce_assoc_float((arr), _reduce_func, (initial), (flags)); \
+})
+#define REDUCE_ASSOC_DOUBLE(arr, expr, initial, flags) ({ \
+    double _reduce_func(double acc, double x) { return (expr); } \
+    ELEGANT_REDUCE_REORDERABLE(flags) && ELEGANT_IS_SUM_EXPR(expr) ? elegant_sum_double((arr), (initial)) : \
+        elegant_reduce_assoc_double((arr), _reduce_func, (initial), (flags)); \
+})
+
+#define REDUCE_ASSOC(arr, func_expr, initial, type, flags) ({ \
+    void* _reduce_func(void* acc_ptr, void* elem_ptr) { \
+        static __thread type _temp_result; \
+        type acc = *(type*)acc_ptr; \
+        type x = *(type*)elem_ptr; \
+        _temp_result = (func_expr); \
+        return &_temp_result; \
+    } \
+    type _initial = (initial); \
+    type* _result = (type*)elegant_reduce_assoc_generic((arr), _reduce_func, &_initial, sizeof(type), (flags)); \
+    type _value = _result ? *_result : _initial; \
+    if (_result && _result != &_initial) free(_result); \
+    _value; \
+})
+
+#endif /* ELEGANT_REDUCE_H */
@@ -18,6 +18,11 @@
 #define ELEGANT_GUARD_PAGE_SIZE 4096
 #endif
 
+/* Freed blocks held back for use-after-free detection (power of two) */
+#ifndef ELEGANT_QUARANTINE_CAPACITY
+#define ELEGANT_QUARANTINE_CAPACITY 1024
+#endif
+
 #ifndef ELEGANT_CANARY_SIZE
 #define ELEGANT_CANARY_SIZE 8
 #endif
@@ -127,29 +132,82 @@ void elegant_bounds_violation(const char* file, int line, size_t index);
 /* Stack protection */
 void elegant_stack_corruption_detected(const char* file, int line);
 
+/* Rolling checksum used for headers; pass the previous result to continue over chunks */
+uint32_t elegant_checksum(uint32_t checksum, const void* data, size_t size);
+
 /* Memory debugging and reporting */
 void elegant_safety_report(void);
 void elegant_dump_active_allocations(void);
 void elegant_check_all_allocations(void);
 
-/* Memory pool safety */
+/*
+ * Memory pool safety: a size-class slab allocator over one region.
+ * Requests up to ELEGANT_POOL_MAX_SLOT bytes come from 4KB runs of equal
+ * slots with per-class free lists; larger ones take whole runs. Slots are
+ * aligned to their class size (up to a run). A pool is not thread-safe.
+ */
+#define ELEGANT_POOL_ALIGN 16
+#define ELEGANT_POOL_RUN_SIZE 4096
+#define ELEGANT_POOL_CLASSES 9                 /* 16, 32, ... 4096 */
+#define ELEGANT_POOL_MAX_SLOT ELEGANT_POOL_RUN_SIZE
+#define ELEGANT_POOL_MARKS 8                   /* marks that can be active at once */
+
+/* Pool creation flags */
+#define ELEGANT_POOL_CANARIES 0x1u   /* guard each slot's tail with a canary */
+
 typedef struct elegant_safe_pool {
-    void* base;
-    size_t size;
-    size_t used;
-    bool* allocation_map;
+    void* base;                      /* run-aligned start of the region */
+    size_t size;                     /* usable bytes from base */
+    size_t used;                     /* bytes carved into runs so far */
+    uint8_t* allocation_map;         /* one bit per granule: allocation starts here */
     uint64_t canary;
+    unsigned int flags;
+    void* region;                    /* block base was carved from */
+    uint8_t* run_class;              /* class per run, or a large/free marker */
+    void* free_slots[ELEGANT_POOL_CLASSES];
+    void* free_spans;                /* released multi-run blocks */
+    void* held_slots[ELEGANT_POOL_CLASSES];   /* freed below the innermost mark */
+    void* held_spans;
+    size_t marks[ELEGANT_POOL_MARKS];         /* active marks, innermost last */
+    size_t mark_count;
+    size_t live_allocations;
+    elegant_allocator_t allocator;   /* serves from the pool, malloc once it is full */
 } elegant_safe_pool_t;
 
 elegant_safe_pool_t* elegant_create_safe_pool(size_t size);
+elegant_safe_pool_t* elegant_create_safe_pool_ex(size_t size, unsigned int flags);
 void* elegant_pool_alloc(elegant_safe_pool_t* pool, size_t size);
 void elegant_pool_free(elegant_safe_pool_t* pool, void* ptr);
 void elegant_destroy_safe_pool(elegant_safe_pool_t* pool);
 
+/*
+ * Drop every allocation at once, or only those made after `mark`. While a
+ * mark is active, blocks below it are not reused, so everything allocated
+ * later sits past it. Rewinding to a mark also ends the marks taken after
+ * it. elegant_pool_mark returns SIZE_MAX once ELEGANT_POOL_MARKS are active.
+ */
+void elegant_pool_reset(elegant_safe_pool_t* pool);
+size_t elegant_pool_mark(elegant_safe_pool_t* pool);
+void elegant_pool_rewind(elegant_safe_pool_t* pool, size_t mark);
+
+/* The pool as an allocator, for elegant_set_allocator or ELEGANT_ALLOCATOR_SCOPE */
+const elegant_allocator_t* elegant_pool_allocator(elegant_safe_pool_t* pool);
+
+/* Shorthand: make the pool this thread's allocator (NULL restores libc) */
+void elegant_set_array_pool(elegant_safe_pool_t* pool);
+elegant_safe_pool_t* elegant_get_array_pool(void);
+
 /* Use-after-free detection */
 void elegant_mark_freed(void* ptr);
 bool elegant_is_freed_pointer(const void* ptr);
 
+/*
+ * Quarantine control: with protection on, quarantined blocks are made
+ * inaccessible so stale accesses fault. Flushing releases every held block.
+ */
+void elegant_safety_set_quarantine_protect(bool enabled);
+void elegant_safety_flush_quarantine(void);
+
 /* Configuration macros */
 #if ELEGANT_SAFETY_ENABLED
     #define ELEGANT_MALLOC(size)           elegant_safe_malloc(size)
@@ -0,0 +1,49 @@
+#ifndef ELEGANT_SERIALIZE_H
+#define ELEGANT_SERIALIZE_H
+
+#include <stdint.h>
+
+/*
+ * Binary array format: a fixed 64-byte header, padding up to payload_offset,
+ * then the raw elements in native byte order. Files written with
+ * elegant_array_save pad the payload to a page so it can be mapped in
+ * place; streams only pad to ELEGANT_SERIAL_STREAM_ALIGN.
+ */
+#define ELEGANT_SERIAL_MAGIC "ELGARRAY"
+#define ELEGANT_SERIAL_VERSION 1
+#define ELEGANT_SERIAL_BYTE_ORDER 0x01020304u
+#define ELEGANT_SERIAL_FILE_ALIGN 4096
+#define ELEGANT_SERIAL_STREAM_ALIGN 64
+
+typedef struct elegant_serial_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;              /* ELEGANT_SERIAL_* */
+    uint64_t element_size;
+    uint64_t length;
+    uint64_t payload_offset;     /* from the start of the header */
+    uint32_t byte_order;         /* ELEGANT_SERIAL_BYTE_ORDER as written */
+    uint32_t checksum;           /* elegant_checksum of the payload, if flagged */
+    uint8_t reserved[16];
+} elegant_serial_header_t;
+
+/* Header flags, also accepted by the writers */
+#define ELEGANT_SERIAL_CHECKSUM 0x1u   /* payload checksum present */
+
+/* Loader flags */
+#define ELEGANT_LOAD_COPY   0x1u   /* read into the heap even when mapping is possible */
+#define ELEGANT_LOAD_VERIFY 0x2u   /* check the checksum of mapped payloads too */
+
+/*
+ * Streams: the payload moves with writev/readv straight between the fd and
+ * the array, in bounded chunks, with no per-element work.
+ * Writers return 0 or an errno value.
+ */
+int elegant_array_write(int fd, elegant_array_t* arr, unsigned int flags);
+elegant_array_t* elegant_array_read(int fd);
+
+/* Files: load maps the payload zero-copy unless ELEGANT_LOAD_COPY is given */
+int elegant_array_save(const char* path, elegant_array_t* arr, unsigned int flags);
+elegant_array_t* elegant_array_load(const char* path, unsigned int flags);
+
+#endif /* ELEGANT_SERIALIZE_H */
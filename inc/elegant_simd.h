@@ -0,0 +1,107 @@
+#ifndef ELEGANT_SIMD_H
+#define ELEGANT_SIMD_H
+
+/*
+ * Vectorized primitive kernels for int/float/double arrays
+ * SSE2, AVX2 or NEON variants are selected at runtime on first use
+ */
+
+#ifndef ELEGANT_SUM_PARALLEL_MIN
+#define ELEGANT_SUM_PARALLEL_MIN (256 * 1024)  /* elements before compensated sums go parallel */
+#endif
+
+typedef enum {
+    ELEGANT_SIMD_SCALAR = 0,
+    ELEGANT_SIMD_SSE2 = 1,
+    ELEGANT_SIMD_AVX2 = 2,
+    ELEGANT_SIMD_NEON = 3
+} elegant_simd_level_t;
+
+/* Comparison used by the compare-and-compact filters */
+typedef enum {
+    ELEGANT_CMP_LT,
+    ELEGANT_CMP_LE,
+    ELEGANT_CMP_GT,
+    ELEGANT_CMP_GE,
+    ELEGANT_CMP_EQ,
+    ELEGANT_CMP_NE
+} elegant_cmp_op_t;
+
+/* Kernel selection: detected level, or force one (falls back if unsupported) */
+elegant_simd_level_t elegant_simd_get_level(void);
+elegant_simd_level_t elegant_simd_set_level(elegant_simd_level_t level);
+const char* elegant_simd_level_name(elegant_simd_level_t level);
+
+/*
+ * Reductions fold `initial` with every element. Integer sums wrap like the
+ * scalar fold; float/double sums are reassociated across lanes, so results
+ * may differ from a strict left fold in the last bits. NaN elements are
+ * skipped by min/max.
+ */
+int elegant_sum_int(elegant_array_t* src, int initial);
+float elegant_sum_float(elegant_array_t* src, float initial);
+double elegant_sum_double(elegant_array_t* src, double initial);
+
+/*
+ * Compensated (Kahan-Neumaier) sums: error stays near one rounding of the
+ * result however long the array is. Large arrays are split into fixed
+ * blocks summed on the thread pool, with the same result as a single
+ * thread. An infinity or NaN in the input gives the plain sum's result.
+ */
+float elegant_sum_kahan_float(elegant_array_t* src, float initial);
+double elegant_sum_kahan_double(elegant_array_t* src, double initial);
+
+int elegant_min_int(elegant_array_t* src, int initial);
+float elegant_min_float(elegant_array_t* src, float initial);
+double elegant_min_double(elegant_array_t* src, double initial);
+
+int elegant_max_int(elegant_array_t* src, int initial);
+float elegant_max_float(elegant_array_t* src, float initial);
+double elegant_max_double(elegant_array_t* src, double initial);
+
+/* Element-wise x * factor and x + addend into a new array */
+elegant_array_t* elegant_scale_int(elegant_array_t* src, int factor);
+elegant_array_t* elegant_scale_float(elegant_array_t* src, float factor);
+elegant_array_t* elegant_scale_double(elegant_array_t* src, double factor);
+
+elegant_array_t* elegant_add_int(elegant_array_t* src, int addend);
+elegant_array_t* elegant_add_float(elegant_array_t* src, float addend);
+elegant_array_t* elegant_add_double(elegant_array_t* src, double addend);
+
+/* Keep elements where (x op value) holds */
+elegant_array_t* elegant_filter_cmp_int(elegant_array_t* src, elegant_cmp_op_t op, int value);
+elegant_array_t* elegant_filter_cmp_float(elegant_array_t* src, elegant_cmp_op_t op, float value);
+elegant_array_t* elegant_filter_cmp_double(elegant_array_t* src, elegant_cmp_op_t op, double value);
+
+/* Explicit kernel macros */
+#define SUM_INT(arr) elegant_sum_int((arr), 0)
+#define SUM_FLOAT(arr) elegant_sum_float((arr), 0.0f)
+#define SUM_DOUBLE(arr) elegant_sum_double((arr), 0.0)
+#define SUM_KAHAN_FLOAT(arr) elegant_sum_kahan_float((arr), 0.0f)
+#define SUM_KAHAN_DOUBLE(arr) elegant_sum_kahan_double((arr), 0.0)
+
+#define MIN_INT(arr, initial) elegant_min_int((arr), (initial))
+#define MIN_FLOAT(arr, initial) elegant_min_float((arr), (initial))
+#define MIN_DOUBLE(arr, initial) elegant_min_double((arr), (initial))
+#define MAX_INT(arr, initial) elegant_max_int((arr), (initial))
+#define MAX_FLOAT(arr, initial) elegant_max_float((arr), (initial))
+#define MAX_DOUBLE(arr, initial) elegant_max_double((arr), (initial))
+
+#define SCALE_INT(arr, k) elegant_scale_int((arr), (k))
+#define SCALE_FLOAT(arr, k) elegant_scale_float((arr), (k))
+#define SCALE_DOUBLE(arr, k) elegant_scale_double((arr), (k))
+#define ADD_INT(arr, k) elegant_add_int((arr), (k))
+#define ADD_FLOAT(arr, k) elegant_add_float((arr), (k))
+#define ADD_DOUBLE(arr, k) elegant_add_double((arr), (k))
+
+/* FILTER_CMP_INT(arr, GT, 10) keeps x > 10 */
+#define FILTER_CMP_INT(arr, op, value) elegant_filter_cmp_int((arr), ELEGANT_CMP_##op, (value))
+#define FILTER_CMP_FLOAT(arr, op, value) elegant_filter_cmp_float((arr), ELEGANT_CMP_##op, (value))
+#define FILTER_CMP_DOUBLE(arr, op, value) elegant_filter_cmp_double((arr), ELEGANT_CMP_##op, (value))
+
+/* True when a REDUCE lambda body is spelled as a plain integer sum */
+#define ELEGANT_IS_SUM_EXPR(expr) \
+    (__builtin_strcmp(#expr, "acc + x") == 0 || __builtin_strcmp(#expr, "acc+x") == 0 || \
+     __builtin_strcmp(#expr, "x + acc") == 0 || __builtin_strcmp(#expr, "x+acc") == 0)
+
+#endif /* ELEGANT_SIMD_H */
@@ -0,0 +1,65 @@
+#ifndef ELEGANT_SORT_H
+#define ELEGANT_SORT_H
+
+/*
+ * Sorting and sorted-array search. Sorts work in place (a view gets its own
+ * storage first) and return 0 or EINVAL/ENOMEM. int/float/double use an
+ * LSD radix sort on order-preserving keys; the comparator path is a stable
+ * merge sort. Both spread across the thread pool for large arrays.
+ */
+
+#ifndef ELEGANT_SORT_PARALLEL_MIN
+#define ELEGANT_SORT_PARALLEL_MIN (128 * 1024)  /* elements */
+#endif
+
+/* -0.0 sorts before 0.0; NaNs go to the end matching their sign bit */
+int elegant_sort_int(elegant_array_t* arr);
+int elegant_sort_float(elegant_array_t* arr);
+int elegant_sort_double(elegant_array_t* arr);
+
+/* compare returns <0, 0 or >0 as for qsort; equal elements keep their order */
+int elegant_sort(elegant_array_t* arr, int (*compare)(const void*, const void*));
+
+int elegant_compare_int(const void* a, const void* b);
+int elegant_compare_float(const void* a, const void* b);
+int elegant_compare_double(const void* a, const void* b);
+
+/*
+ * Searches on an array sorted by the same ordering. lower_bound is the
+ * first index whose element is not less than key, upper_bound the first
+ * greater than it; both return the length when there is none.
+ */
+size_t elegant_lower_bound(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*));
+size_t elegant_upper_bound(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*));
+/* Pointer to an element equal to key, or NULL */
+void* elegant_binary_search(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*));
+
+size_t elegant_lower_bound_int(elegant_array_t* arr, int key);
+size_t elegant_lower_bound_float(elegant_array_t* arr, float key);
+size_t elegant_lower_bound_double(elegant_array_t* arr, double key);
+
+/*
+ * Sorted-merge join of two arrays sorted by compare: every pair of equal
+ * elements yields one entry in both outputs, the left and right indices
+ * as size_t selections for GATHER or elegant_table_gather. Runs of equal
+ * keys produce their cross product. Returns 0 or EINVAL/ENOMEM.
+ */
+int elegant_merge_join(elegant_array_t* left, elegant_array_t* right,
+                       int (*compare)(const void*, const void*),
+                       elegant_array_t** left_selection, elegant_array_t** right_selection);
+
+/* SORT with a three-way comparison of a and b, e.g. (a.id > b.id) - (a.id < b.id) */
+#define SORT(arr, compare_expr, type) ({ \
+    int _sort_compare(const void* a_ptr, const void* b_ptr) { \
+        type a = *(const type*)a_ptr; \
+        type b = *(const type*)b_ptr; \
+        return (compare_expr); \
+    } \
+    elegant_sort((arr), _sort_compare); \
+})
+
+#define SORT_INT(arr) elegant_sort_int(arr)
+#define SORT_FLOAT(arr) elegant_sort_float(arr)
+#define SORT_DOUBLE(arr) elegant_sort_double(arr)
+
+#endif /* ELEGANT_SORT_H */
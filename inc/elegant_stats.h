@@ -0,0 +1,145 @@
+#ifndef ELEGANT_STATS_H
+#define ELEGANT_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Runtime statistics: per-thread counters for every collection operation
+ * (calls, elements, bytes allocated, optionally time), live/peak bytes and
+ * scope usage. Counters are plain per-thread stores, so they cost a few
+ * instructions per call; timing adds two clock reads and is off by default.
+ * Only calls that succeed are counted.
+ */
+
+#ifndef ELEGANT_STATS_ENABLED
+#define ELEGANT_STATS_ENABLED 1
+#endif
+
+typedef enum {
+    ELEGANT_OP_MAP = 0,
+    ELEGANT_OP_FILTER,
+    ELEGANT_OP_REDUCE,
+    ELEGANT_OP_FOLD,
+    ELEGANT_OP_FIND,
+    ELEGANT_OP_ZIP,
+    ELEGANT_OP_CONCAT,
+    ELEGANT_OP_TAKE,
+    ELEGANT_OP_DROP,
+    ELEGANT_OP_REVERSE,
+    ELEGANT_OP_SLICE,
+    ELEGANT_OP_COPY,
+    ELEGANT_OP_GATHER,
+    ELEGANT_OP_SIMD_MAP,
+    ELEGANT_OP_SIMD_FILTER,
+    ELEGANT_OP_SIMD_REDUCE,
+    ELEGANT_OP_PAR_MAP,
+    ELEGANT_OP_PAR_FILTER,
+    ELEGANT_OP_PAR_REDUCE,
+    ELEGANT_OP_STREAM,
+    ELEGANT_OP_SORT,
+    ELEGANT_OP_GROUP,
+    ELEGANT_OP_CHAIN,
+    ELEGANT_OP_COUNT
+} elegant_op_t;
+
+typedef struct elegant_op_stats {
+    uint64_t calls;
+    uint64_t elements;         /* input elements processed */
+    uint64_t bytes_allocated;  /* by the calling thread during the call */
+    uint64_t time_ns;          /* only while timing is enabled */
+} elegant_op_stats_t;
+
+typedef struct elegant_stats_snapshot {
+    elegant_op_stats_t ops[ELEGANT_OP_COUNT];
+    uint64_t allocated_bytes;
+    uint64_t freed_bytes;
+    uint64_t live_bytes;           /* allocated - freed */
+    uint64_t peak_bytes;           /* per thread; summed over threads in a process snapshot */
+    uint64_t live_allocations;
+    uint64_t scope_enters;
+    uint64_t scope_depth;          /* frames currently open */
+    uint64_t scope_max_depth;
+    uint64_t scope_frame_arrays;   /* arrays registered with exited frames, in total */
+    uint64_t scope_max_frame_arrays;
+    uint64_t scope_max_arena_bytes;
+    uint64_t threads;              /* threads that have reported, exited ones included */
+} elegant_stats_snapshot_t;
+
+/* Calling thread only, or every thread (exited ones folded in) */
+void elegant_stats_thread_snapshot(elegant_stats_snapshot_t* snapshot);
+void elegant_stats_snapshot(elegant_stats_snapshot_t* snapshot);
+
+/* Process-wide switch for per-operation timing */
+void elegant_stats_set_timing(bool enabled);
+bool elegant_stats_get_timing(void);
+
+const char* elegant_op_name(elegant_op_t op);
+
+/*
+ * Exporters with snprintf semantics: write at most `size` bytes including
+ * the terminator and return the full length, so a too-small buffer can be
+ * retried with the returned length + 1.
+ */
+size_t elegant_stats_to_json(const elegant_stats_snapshot_t* snapshot, char* buffer, size_t size);
+size_t elegant_stats_to_prometheus(const elegant_stats_snapshot_t* snapshot, char* buffer, size_t size);
+
+/*
+ * Library-internal hooks. Each thread owns one block and is its only
+ * writer; stores are relaxed atomics so snapshots from other threads are
+ * race-free without slowing the owner down.
+ */
+typedef struct elegant_thread_stats {
+    elegant_op_stats_t ops[ELEGANT_OP_COUNT];
+    uint64_t allocated_bytes;
+    uint64_t freed_bytes;
+    uint64_t peak_bytes;
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t scope_enters;
+    uint64_t scope_depth;
+    uint64_t scope_max_depth;
+    uint64_t scope_frame_arrays;
+    uint64_t scope_max_frame_arrays;
+    uint64_t scope_max_arena_bytes;
+    int state;                             /* 0 unlisted, 1 listed, 2 exited */
+    struct elegant_thread_stats* next;
+} elegant_thread_stats_t;
+
+extern __thread elegant_thread_stats_t elegant_thread_stats;
+extern int elegant_stats_timing;
+
+void elegant_stats_register_thread(void);
+uint64_t elegant_stats_now(void);
+
+#define ELEGANT_STATS_STORE(field, value) \
+    __atomic_store_n(&elegant_thread_stats.field, (value), __ATOMIC_RELAXED)
+#define ELEGANT_STATS_ADD(field, amount) \
+    ELEGANT_STATS_STORE(field, elegant_thread_stats.field + (amount))
+
+typedef struct elegant_op_probe {
+    uint64_t bytes;
+    uint64_t start;
+} elegant_op_probe_t;
+
+static inline elegant_op_probe_t elegant_stats_begin(void) {
+    elegant_op_probe_t probe = { 0, 0 };
+#if ELEGANT_STATS_ENABLED
+    probe.bytes = elegant_thread_stats.allocated_bytes;
+    if (__atomic_load_n(&elegant_stats_timing, __ATOMIC_RELAXED)) probe.start = elegant_stats_now();
+#endif
+    return probe;
+}
+
+static inline void elegant_stats_end(const elegant_op_probe_t* probe, elegant_op_t op, size_t elements) {
+#if ELEGANT_STATS_ENABLED
+    if (elegant_thread_stats.state == 0) elegant_stats_register_thread();
+    ELEGANT_STATS_ADD(ops[op].calls, 1);
+    ELEGANT_STATS_ADD(ops[op].elements, elements);
+    ELEGANT_STATS_ADD(ops[op].bytes_allocated, elegant_thread_stats.allocated_bytes - probe->bytes);
+    if (probe->start) ELEGANT_STATS_ADD(ops[op].time_ns, elegant_stats_now() - probe->start);
+#else
+    (void)probe; (void)op; (void)elements;
+#endif
+}
+
+#endif /* ELEGANT_STATS_H */
@@ -0,0 +1,119 @@
+#ifndef ELEGANT_STREAM_H
+#define ELEGANT_STREAM_H
+
+/*
+ * Pull-based streams: a source yields fixed-capacity chunks of elements,
+ * so unbounded input is processed in bounded memory. Each chunk is an
+ * ordinary elegant_array_t owned by the stream and valid until the next
+ * pull; it must not be destroyed or resized.
+ */
+
+/* Default chunk size when a chunk length of 0 is requested */
+#ifndef ELEGANT_STREAM_CHUNK_BYTES
+#define ELEGANT_STREAM_CHUNK_BYTES (64 * 1024)
+#endif
+
+/* Returned by a pull callback on failure, with errno set */
+#define ELEGANT_STREAM_ERROR ((size_t)-1)
+
+typedef struct elegant_stream elegant_stream_t;
+
+/* Fill up to `capacity` elements; return how many, 0 once the source is exhausted */
+typedef size_t (*elegant_stream_pull_t)(void* ctx, void* buffer, size_t capacity);
+
+elegant_stream_t* elegant_stream_create(size_t element_size, size_t chunk_length,
+                                        elegant_stream_pull_t pull, void* ctx,
+                                        void (*release)(void* ctx));
+void elegant_stream_close(elegant_stream_t* stream);
+
+/* Next chunk, or NULL at the end of the stream or on error */
+elegant_array_t* elegant_stream_next(elegant_stream_t* stream);
+int elegant_stream_error(const elegant_stream_t* stream);
+size_t elegant_stream_element_size(const elegant_stream_t* stream);
+size_t elegant_stream_chunk_length(const elegant_stream_t* stream);
+
+/*
+ * Pull the next chunk straight into a caller buffer of at least
+ * chunk_length elements instead of the stream's own; returns the count,
+ * 0 at the end or on error.
+ */
+size_t elegant_stream_read(elegant_stream_t* stream, void* buffer, size_t capacity);
+
+/*
+ * Single-producer single-consumer ring of fixed-size elements. Push blocks
+ * while full, pop while empty; pop returns 0 once the ring is closed and drained.
+ * Waiting yields at first and then sleeps in growing steps up to 1 ms.
+ */
+typedef struct elegant_ring elegant_ring_t;
+
+elegant_ring_t* elegant_ring_create(size_t element_size, size_t capacity);
+size_t elegant_ring_push(elegant_ring_t* ring, const void* elements, size_t count);
+size_t elegant_ring_pop(elegant_ring_t* ring, void* elements, size_t max_count);
+void elegant_ring_close(elegant_ring_t* ring);
+void elegant_ring_destroy(elegant_ring_t* ring);
+
+/* Sources. The fd and ring are not closed with the stream; the array is retained. */
+elegant_stream_t* elegant_stream_from_fd(int fd, size_t element_size, size_t chunk_length);
+elegant_stream_t* elegant_stream_from_array(elegant_array_t* arr, size_t chunk_length);
+elegant_stream_t* elegant_stream_from_ring(elegant_ring_t* ring, size_t chunk_length);
+
+/*
+ * Lazy transforms take ownership of `src` and close it with themselves.
+ * Terminal operations pull until done (FIND stops at the first match) and
+ * leave the stream open. The macros' callbacks are nested functions, so a
+ * transformed stream must be drained before the defining function returns.
+ */
+elegant_stream_t* elegant_stream_map_generic(elegant_stream_t* src, void (*func)(void* out, void* in),
+                                             size_t src_element_size, size_t dst_element_size);
+elegant_stream_t* elegant_stream_filter_generic(elegant_stream_t* src, int (*predicate)(void*),
+                                                size_t element_size);
+int elegant_stream_reduce_generic(elegant_stream_t* src, void* (*func)(void*, void*),
+                                  void* accumulator, size_t element_size);
+void* elegant_stream_find_generic(elegant_stream_t* src, int (*predicate)(void*), size_t element_size);
+elegant_array_t* elegant_stream_collect(elegant_stream_t* src);
+
+#define STREAM_MAP(stream, expr, type) STREAM_MAP_TO(stream, expr, type, type)
+
+#define STREAM_MAP_TO(stream, expr, in_type, out_type) ({ \
+    void _map_func(void* out_ptr, void* elem_ptr) { \
+        in_type x = *(in_type*)elem_ptr; \
+        *(out_type*)out_ptr = (expr); \
+    } \
+    elegant_stream_map_generic((stream), _map_func, sizeof(in_type), sizeof(out_type)); \
+})
+
+#define STREAM_FILTER(stream, predicate, type) ({ \
+    int _filter_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_stream_filter_generic((stream), _filter_func, sizeof(type)); \
+})
+
+#define STREAM_REDUCE(stream, func_expr, initial, type) ({ \
+    void* _reduce_func(void* acc_ptr, void* elem_ptr) { \
+        static __thread type _temp_result; \
+        type acc = *(type*)acc_ptr; \
+        type x = *(type*)elem_ptr; \
+        _temp_result = (func_expr); \
+        return &_temp_result; \
+    } \
+    type _acc = (initial); \
+    elegant_stream_reduce_generic((stream), _reduce_func, &_acc, sizeof(type)); \
+    _acc; \
+})
+
+/* Pointer into the current chunk, valid until the stream is pulled again */
+#define STREAM_FIND(stream, predicate, type) ({ \
+    int _find_func(void* elem_ptr) { \
+        type x = *(type*)elem_ptr; \
+        return (predicate); \
+    } \
+    (type*)elegant_stream_find_generic((stream), _find_func, sizeof(type)); \
+})
+
+/* Iterate chunks: for each non-empty chunk `chunk` of `stream` */
+#define STREAM_FOR_EACH_CHUNK(chunk, stream) \
+    for (elegant_array_t* chunk; (chunk = elegant_stream_next(stream)) != NULL; )
+
+#endif /* ELEGANT_STREAM_H */
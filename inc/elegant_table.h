@@ -0,0 +1,91 @@
+#ifndef ELEGANT_TABLE_H
+#define ELEGANT_TABLE_H
+
+/*
+ * Columnar tables: a registered struct stored as one elegant_array_t per
+ * field, so an operation only pulls the columns it reads through cache.
+ * FILTER evaluates one column into a selection vector and gathers the
+ * others through it; MAP/REDUCE/ZIP run on the referenced columns alone.
+ *
+ * Columns are ordinary arrays created under the current memory mode. The
+ * table holds one reference to each and elegant_table_destroy drops them;
+ * columns of a table built in an arena scope die with that scope.
+ */
+
+/* One field of the record type; names are not copied */
+typedef struct elegant_column_desc {
+    const char* name;
+    size_t offset;
+    size_t size;
+} elegant_column_desc_t;
+
+#define ELEGANT_COLUMN(record_type, field) \
+    { #field, offsetof(record_type, field), sizeof(((record_type*)0)->field) }
+
+#define ELEGANT_FIELD_TYPE(record_type, field) __typeof__(((record_type*)0)->field)
+
+/* Returned by elegant_table_column_index for unknown names */
+#define ELEGANT_TABLE_NO_COLUMN ((size_t)-1)
+
+typedef struct elegant_table {
+    elegant_array_t** columns;
+    elegant_column_desc_t* schema;
+    size_t column_count;
+    size_t record_size;
+} elegant_table_t;
+
+/* Zero-filled table of `length` rows, or a transposed copy of an array of records */
+elegant_table_t* elegant_table_create(const elegant_column_desc_t* schema, size_t column_count,
+                                      size_t record_size, size_t length);
+elegant_table_t* elegant_table_from_records(const elegant_column_desc_t* schema, size_t column_count,
+                                            size_t record_size, const void* records, size_t length);
+void elegant_table_destroy(elegant_table_t* table);
+
+size_t elegant_table_length(const elegant_table_t* table);
+size_t elegant_table_column_index(const elegant_table_t* table, const char* name);
+/* Borrowed: columns may be written through but must keep the table's length */
+elegant_array_t* elegant_table_column(elegant_table_t* table, size_t index);
+elegant_array_t* elegant_table_column_named(elegant_table_t* table, const char* name);
+
+/* Row access assembles or scatters one whole record; return 0 or EINVAL/ERANGE/ENOMEM */
+int elegant_table_get_record(elegant_table_t* table, size_t row, void* record);
+int elegant_table_set_record(elegant_table_t* table, size_t row, const void* record);
+int elegant_table_to_records(elegant_table_t* table, void* records);
+
+/* New table of the rows listed in a size_t selection (see FILTER_SELECT) */
+elegant_table_t* elegant_table_gather(elegant_table_t* table, elegant_array_t* selection);
+/* Rows whose `column` passes the predicate; only that column is scanned */
+elegant_table_t* elegant_table_filter(elegant_table_t* table, size_t column, int (*predicate)(void*));
+
+#define ELEGANT_TABLE(record_type, table_schema, length) \
+    elegant_table_create((table_schema), sizeof(table_schema) / sizeof((table_schema)[0]), \
+                         sizeof(record_type), (length))
+
+#define TABLE_COLUMN(table, field) elegant_table_column_named((table), #field)
+
+/* x is the field value in every expression below */
+#define TABLE_FILTER(table, record_type, field, predicate) ({ \
+    int _filter_func(void* elem_ptr) { \
+        ELEGANT_FIELD_TYPE(record_type, field) x = *(ELEGANT_FIELD_TYPE(record_type, field)*)elem_ptr; \
+        return (predicate); \
+    } \
+    elegant_table_t* _filter_table = (table); \
+    elegant_table_filter(_filter_table, elegant_table_column_index(_filter_table, #field), _filter_func); \
+})
+
+#define TABLE_MAP(table, record_type, field, expr, out_type) \
+    MAP_TO(TABLE_COLUMN(table, field), expr, ELEGANT_FIELD_TYPE(record_type, field), out_type)
+
+#define TABLE_REDUCE(table, record_type, field, expr, initial) \
+    REDUCE(TABLE_COLUMN(table, field), expr, initial, ELEGANT_FIELD_TYPE(record_type, field))
+
+/* Two columns combined row by row as a and b, e.g. price * quantity */
+#define TABLE_ZIP(table, record_type, field1, field2, expr, result_type) ({ \
+    typedef ELEGANT_FIELD_TYPE(record_type, field1) _zip_type1; \
+    typedef ELEGANT_FIELD_TYPE(record_type, field2) _zip_type2; \
+    elegant_table_t* _zip_table = (table); \
+    ZIP(TABLE_COLUMN(_zip_table, field1), TABLE_COLUMN(_zip_table, field2), expr, \
+        _zip_type1, _zip_type2, result_type); \
+})
+
+#endif /* ELEGANT_TABLE_H */
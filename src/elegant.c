@@ -3,12 +3,21 @@
  * Version 0.0.1
  */
 
+#define _POSIX_C_SOURCE 200112L  /* posix_memalign, clock_gettime */
+#define _DEFAULT_SOURCE          /* madvise */
+
 #include "elegant.h"
 #include <stdio.h>
 #include <assert.h>
 #include <limits.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
 
 /* Thread-local memory mode */
 __thread elegant_memory_mode_t elegant_current_memory_mode = ELEGANT_MEMORY_STACK_ARENA;
@@ -16,9 +25,51 @@ __thread elegant_memory_mode_t elegant_current_memory_mode = ELEGANT_MEMORY_STAC
 /* Thread-local scope stack */
 __thread elegant_scope_frame_t* elegant_current_scope = NULL;
 
-/* Thread-local memory statistics */
-__thread size_t elegant_allocated_bytes = 0;
-__thread size_t elegant_allocation_count = 0;
+/* Longest array the core will create, 0 for no limit */
+static size_t elegant_max_array_size = ELEGANT_MAX_ARRAY_SIZE;
+
+
+/* Default allocator */
+static void* elegant_libc_alloc(void* ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void* elegant_libc_calloc(void* ctx, size_t size) {
+    (void)ctx;
+    return calloc(1, size);
+}
+
+static void* elegant_libc_alloc_aligned(void* ctx, size_t size, size_t alignment) {
+    (void)ctx;
+    void* ptr = NULL;
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+}
+
+static void* elegant_libc_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    (void)ctx;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+static void elegant_libc_free(void* ctx, void* ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+const elegant_allocator_t elegant_libc_allocator = {
+    elegant_libc_alloc,
+    elegant_libc_calloc,
+    elegant_libc_alloc_aligned,
+    elegant_libc_realloc,
+    elegant_libc_free,
+    NULL
+};
+
+/* Allocator serving this thread's allocations */
+static __thread const elegant_allocator_t* elegant_current_allocator = &elegant_libc_allocator;
 
 /* Safe memory copy implementation */
 int elegant_memcpy_safe(void* dest, size_t dest_size, const void* src, size_t copy_size) {
@@ -61,148 +112,1234 @@ elegant_memory_mode_t elegant_get_memory_mode(void) {
 }
 
 size_t elegant_get_allocated_bytes(void) {
-    return elegant_allocated_bytes;
+    return elegant_thread_stats.allocated_bytes;
 }
 
-/* Memory allocation wrappers */
-void* elegant_malloc(size_t size) {
-    void* ptr = malloc(size);
-    if (ptr) {
-        elegant_allocated_bytes += size;
-        elegant_allocation_count++;
+void elegant_set_max_array_size(size_t max_length) {
+    __atomic_store_n(&elegant_max_array_size, max_length, __ATOMIC_RELAXED);
+}
+
+size_t elegant_get_max_array_size(void) {
+    return __atomic_load_n(&elegant_max_array_size, __ATOMIC_RELAXED);
+}
+
+size_t elegant_get_freed_bytes(void) {
+    return elegant_thread_stats.freed_bytes;
+}
+
+void elegant_set_allocator(const elegant_allocator_t* allocator) {
+    elegant_current_allocator = allocator ? allocator : &elegant_libc_allocator;
+}
+
+const elegant_allocator_t* elegant_get_allocator(void) {
+    return elegant_current_allocator;
+}
+
+/* Memory accounting lives in the thread's statistics block */
+static inline void elegant_account_alloc(size_t size) {
+    elegant_thread_stats_t* stats = &elegant_thread_stats;
+    if (stats->state == 0) elegant_stats_register_thread();
+    ELEGANT_STATS_ADD(allocated_bytes, size);
+    ELEGANT_STATS_ADD(allocations, 1);
+    if (stats->allocated_bytes > stats->freed_bytes &&
+        stats->allocated_bytes - stats->freed_bytes > stats->peak_bytes) {
+        ELEGANT_STATS_STORE(peak_bytes, stats->allocated_bytes - stats->freed_bytes);
     }
+}
+
+static inline void elegant_account_free(size_t size) {
+    ELEGANT_STATS_ADD(freed_bytes, size);
+    ELEGANT_STATS_ADD(frees, 1);
+}
+
+/* Accounted calls into a specific allocator */
+static void* elegant_alloc_from(const elegant_allocator_t* allocator, size_t size, bool zero) {
+    void* ptr;
+    if (zero && allocator->calloc) {
+        ptr = allocator->calloc(allocator->ctx, size);
+    } else {
+        ptr = allocator->alloc(allocator->ctx, size);
+        if (ptr && zero) memset(ptr, 0, size);
+    }
+    if (ptr) elegant_account_alloc(size);
     return ptr;
 }
 
-void* elegant_calloc(size_t nmemb, size_t size) {
-    void* ptr = calloc(nmemb, size);
+static void* elegant_alloc_aligned_from(const elegant_allocator_t* allocator,
+                                        size_t size, size_t alignment) {
+    void* ptr = allocator->alloc_aligned(allocator->ctx, size, alignment);
+    if (ptr) elegant_account_alloc(size);
+    return ptr;
+}
+
+static void* elegant_realloc_from(const elegant_allocator_t* allocator, void* old_ptr,
+                                  size_t old_size, size_t new_size) {
+    if (!old_ptr) return elegant_alloc_from(allocator, new_size, false);
+    
+    void* ptr = allocator->realloc(allocator->ctx, old_ptr, old_size, new_size);
     if (ptr) {
-        elegant_allocated_bytes += nmemb * size;
-        elegant_allocation_count++;
+        elegant_account_alloc(new_size);
+        elegant_account_free(old_size);
     }
     return ptr;
 }
 
+static void elegant_free_from(const elegant_allocator_t* allocator, void* ptr, size_t size) {
+    if (!ptr) return;
+    allocator->free(allocator->ctx, ptr, size);
+    elegant_account_free(size);
+}
+
+/*
+ * Memory allocation wrappers. Callers of elegant_free and elegant_realloc
+ * do not know the size, so each block starts with a prefix recording it
+ * and the allocator it came from; the allocator and the byte counts then
+ * see real sizes.
+ */
+typedef union {
+    struct {
+        size_t size;                           /* bytes requested from the allocator */
+        const elegant_allocator_t* allocator;
+    } block;
+    long double align;                         /* keeps malloc's alignment for the caller */
+} elegant_malloc_prefix_t;
+
+#define ELEGANT_MALLOC_PREFIX sizeof(elegant_malloc_prefix_t)
+
+static inline elegant_malloc_prefix_t* elegant_malloc_prefix(void* ptr) {
+    return (elegant_malloc_prefix_t*)ptr - 1;
+}
+
+static void* elegant_malloc_from(const elegant_allocator_t* allocator, size_t size, bool zero) {
+    if (size > SIZE_MAX - ELEGANT_MALLOC_PREFIX) return NULL;
+    
+    elegant_malloc_prefix_t* prefix = elegant_alloc_from(allocator, ELEGANT_MALLOC_PREFIX + size, zero);
+    if (!prefix) return NULL;
+    prefix->block.size = ELEGANT_MALLOC_PREFIX + size;
+    prefix->block.allocator = allocator;
+    return prefix + 1;
+}
+
+void* elegant_malloc(size_t size) {
+    return elegant_malloc_from(elegant_current_allocator, size, false);
+}
+
+void* elegant_calloc(size_t nmemb, size_t size) {
+    if (size && nmemb > SIZE_MAX / size) return NULL;
+    return elegant_malloc_from(elegant_current_allocator, nmemb * size, true);
+}
+
 void* elegant_realloc(void* old_ptr, size_t size) {
-    void* ptr = realloc(old_ptr, size);
-    if (ptr && ptr != old_ptr) {
-        elegant_allocated_bytes += size;
-        elegant_allocation_count++;
+    if (!old_ptr) return elegant_malloc(size);
+    if (size == 0) {
+        elegant_free(old_ptr);
+        return NULL;
     }
-    return ptr;
+    if (size > SIZE_MAX - ELEGANT_MALLOC_PREFIX) return NULL;
+    
+    /* The block stays with the allocator that produced it */
+    elegant_malloc_prefix_t* prefix = elegant_malloc_prefix(old_ptr);
+    const elegant_allocator_t* allocator = prefix->block.allocator;
+    prefix = elegant_realloc_from(allocator, prefix, prefix->block.size, ELEGANT_MALLOC_PREFIX + size);
+    if (!prefix) return NULL;
+    prefix->block.size = ELEGANT_MALLOC_PREFIX + size;
+    return prefix + 1;
 }
 
 void elegant_free(void* ptr) {
-    if (ptr) {
-        free(ptr);
-        elegant_allocation_count--;
-        /* Note: We can't track exact freed bytes without additional metadata */
+    if (!ptr) return;
+    elegant_malloc_prefix_t* prefix = elegant_malloc_prefix(ptr);
+    elegant_free_from(prefix->block.allocator, prefix, prefix->block.size);
+}
+
+void* elegant_alloc_aligned(size_t size, size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return elegant_alloc_aligned_from(elegant_current_allocator, size, alignment);
+}
+
+void elegant_free_sized(void* ptr, size_t size) {
+    elegant_free_from(elegant_current_allocator, ptr, size);
+}
+
+/* Scope arena implementation */
+#define ELEGANT_ARENA_ALIGN 16
+
+static inline size_t elegant_align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+#define ELEGANT_ARENA_CHUNK_HEADER \
+    elegant_align_up(sizeof(elegant_arena_chunk_t), ELEGANT_ARENA_ALIGN)
+
+/* One spare default-size chunk per thread keeps steady-state arena scopes off malloc */
+static __thread elegant_arena_chunk_t* elegant_arena_spare = NULL;
+
+static elegant_arena_chunk_t* elegant_arena_chunk_new(size_t size) {
+    const elegant_allocator_t* allocator = elegant_current_allocator;
+    elegant_arena_chunk_t* chunk;
+    
+    /* Only libc chunks are cached; other allocators may go away with their chunks */
+    if (size == ELEGANT_ARENA_CHUNK_SIZE && elegant_arena_spare &&
+        allocator == &elegant_libc_allocator) {
+        chunk = elegant_arena_spare;
+        elegant_arena_spare = NULL;
+    } else {
+        if (size > SIZE_MAX - ELEGANT_ARENA_CHUNK_HEADER) return NULL;
+        chunk = elegant_alloc_from(allocator, ELEGANT_ARENA_CHUNK_HEADER + size, false);
+        if (!chunk) return NULL;
+        chunk->size = size;
+        chunk->allocator = allocator;
     }
+    
+    chunk->next = NULL;
+    chunk->used = 0;
+    return chunk;
+}
+
+static inline char* elegant_arena_chunk_base(elegant_arena_chunk_t* chunk) {
+    return (char*)chunk + ELEGANT_ARENA_CHUNK_HEADER;
+}
+
+static void* elegant_arena_alloc(elegant_arena_t* arena, size_t size) {
+    if (size > SIZE_MAX - ELEGANT_ARENA_ALIGN) return NULL;
+    size = elegant_align_up(size, ELEGANT_ARENA_ALIGN);
+    
+    elegant_arena_chunk_t* chunk = arena->head;
+    if (chunk && chunk->size - chunk->used >= size) {
+        void* ptr = elegant_arena_chunk_base(chunk) + chunk->used;
+        chunk->used += size;
+        arena->bytes_used += size;
+        return ptr;
+    }
+    
+    if (size > ELEGANT_ARENA_CHUNK_SIZE / 2) {
+        /* Oversized requests get a dedicated chunk behind the one being bumped */
+        elegant_arena_chunk_t* big = elegant_arena_chunk_new(size);
+        if (!big) return NULL;
+        big->used = size;
+        if (chunk) {
+            big->next = chunk->next;
+            chunk->next = big;
+        } else {
+            arena->head = big;
+        }
+        arena->bytes_used += size;
+        return elegant_arena_chunk_base(big);
+    }
+    
+    elegant_arena_chunk_t* fresh = elegant_arena_chunk_new(ELEGANT_ARENA_CHUNK_SIZE);
+    if (!fresh) return NULL;
+    fresh->next = chunk;
+    fresh->used = size;
+    arena->head = fresh;
+    arena->bytes_used += size;
+    return elegant_arena_chunk_base(fresh);
+}
+
+static void elegant_arena_release(elegant_arena_chunk_t* chunk) {
+    while (chunk) {
+        elegant_arena_chunk_t* next = chunk->next;
+        if (chunk->size == ELEGANT_ARENA_CHUNK_SIZE && !elegant_arena_spare &&
+            chunk->allocator == &elegant_libc_allocator) {
+            elegant_arena_spare = chunk;
+        } else {
+            elegant_free_from(chunk->allocator, chunk, ELEGANT_ARENA_CHUNK_HEADER + chunk->size);
+        }
+        chunk = next;
+    }
+}
+
+/* Arena of the innermost scope, if arrays created now should be bump-allocated */
+static inline elegant_arena_t* elegant_active_arena(void) {
+    if (elegant_current_memory_mode == ELEGANT_MEMORY_STACK_ARENA && elegant_current_scope) {
+        return elegant_current_scope->arena;
+    }
+    return NULL;
 }
 
 /* Array implementation */
-elegant_array_t* elegant_array_create(size_t element_size, size_t length) {
-    if (length > ELEGANT_MAX_ARRAY_SIZE) {
-        fprintf(stderr, "Elegant: Array size %zu exceeds maximum %d\n", 
-                length, ELEGANT_MAX_ARRAY_SIZE);
-        return NULL;
+
+/*
+ * Heap arrays are one block: the header followed by the payload, which is
+ * cache-line aligned once it spans at least a line. Small payloads only
+ * get the allocator's natural alignment to keep the block compact.
+ */
+#define ELEGANT_MALLOC_ALIGN (2 * sizeof(size_t))  /* Alignment malloc guarantees */
+
+static inline size_t elegant_payload_align(size_t bytes) {
+    return bytes >= ELEGANT_CACHE_LINE_SIZE ? ELEGANT_CACHE_LINE_SIZE : ELEGANT_ARENA_ALIGN;
+}
+
+#define ELEGANT_ARRAY_HEADER_SIZE elegant_align_up(sizeof(elegant_array_t), ELEGANT_ARENA_ALIGN)
+
+/* Bytes of the single heap block holding a header and `data_size` payload bytes */
+static inline size_t elegant_array_block_size(size_t data_size) {
+    size_t align = elegant_payload_align(data_size);
+    size_t slack = align > ELEGANT_MALLOC_ALIGN ? align - ELEGANT_MALLOC_ALIGN : 0;
+    return ELEGANT_ARRAY_HEADER_SIZE + slack + data_size;
+}
+
+/* Size of the header's own allocation, as passed to the allocator's free */
+static inline size_t elegant_array_header_bytes(elegant_array_t* arr) {
+    if (arr->flags & ELEGANT_ARRAY_INLINE_DATA) {
+        return elegant_array_block_size(arr->capacity * arr->element_size);
+    }
+    if (arr->flags & ELEGANT_ARRAY_SPILLED) {
+        return arr->block_size;
+    }
+    return sizeof(elegant_array_t);
+}
+
+/* The payload has left the header's block; remember the block's size for free */
+static inline void elegant_array_spill(elegant_array_t* arr) {
+    arr->block_size = elegant_array_header_bytes(arr);
+    arr->flags = (arr->flags & ~ELEGANT_ARRAY_INLINE_DATA) | ELEGANT_ARRAY_SPILLED;
+}
+
+/* Enforce the length limit and compute the payload size without overflow */
+static bool elegant_array_size_ok(size_t element_size, size_t length, size_t* bytes) {
+    size_t max_length = elegant_get_max_array_size();
+    if (max_length && length > max_length) {
+        fprintf(stderr, "Elegant: Array size %zu exceeds maximum %zu\n", length, max_length);
+        return false;
     }
     
-    elegant_array_t* arr = elegant_malloc(sizeof(elegant_array_t));
-    if (!arr) return NULL;
+    /* Leave room for the header and alignment slack on top of the payload */
+    if (__builtin_mul_overflow(length, element_size, bytes) ||
+        *bytes > SIZE_MAX - ELEGANT_ARRAY_HEADER_SIZE - ELEGANT_HUGE_PAGE_SIZE) {
+        fprintf(stderr, "Elegant: Array of %zu elements of %zu bytes is too large\n",
+                length, element_size);
+        errno = ENOMEM;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Separate payload buffer. Huge ones are aligned to the huge page size and
+ * flagged for transparent huge pages, so a long scan takes few TLB misses.
+ */
+static void* elegant_payload_alloc(const elegant_allocator_t* allocator, size_t bytes, bool zero) {
+    if (bytes < ELEGANT_HUGE_PAGE_SIZE) {
+        void* data = elegant_alloc_aligned_from(allocator, bytes, elegant_payload_align(bytes));
+        if (data && zero) memset(data, 0, bytes);
+        return data;
+    }
     
+    void* data = elegant_alloc_aligned_from(allocator, bytes, ELEGANT_HUGE_PAGE_SIZE);
+    if (!data) return NULL;
+#ifdef MADV_HUGEPAGE
+    madvise(data, bytes & ~(size_t)(ELEGANT_HUGE_PAGE_SIZE - 1), MADV_HUGEPAGE);
+#endif
+    if (zero) memset(data, 0, bytes);
+    return data;
+}
+
+/*
+ * Shared arrays may be retained and released from several threads: plain
+ * references are taken relaxed, and the final release synchronises with
+ * every earlier one before the array is torn down.
+ */
+static inline bool elegant_array_is_atomic(const elegant_array_t* arr) {
+    return arr->memory_mode == ELEGANT_MEMORY_SHARED_REFERENCE_COUNTING;
+}
+
+static inline void elegant_ref_inc(elegant_array_t* arr) {
+    if (elegant_array_is_atomic(arr)) {
+        __atomic_fetch_add(&arr->ref_count, 1, __ATOMIC_RELAXED);
+    } else {
+        arr->ref_count++;
+    }
+}
+
+/* Drop one reference; true when it was the last */
+static inline bool elegant_ref_dec(elegant_array_t* arr) {
+    if (!elegant_array_is_atomic(arr)) {
+        return --arr->ref_count <= 0;
+    }
+    return __atomic_fetch_sub(&arr->ref_count, 1, __ATOMIC_ACQ_REL) <= 1;
+}
+
+/* Collector hooks, see "Garbage collection" below */
+static inline bool elegant_gc_managed(const elegant_array_t* arr) {
+    return arr->memory_mode == ELEGANT_MEMORY_GARBAGE_COLLECTION;
+}
+
+static bool elegant_gc_track(elegant_array_t* arr);
+static void elegant_gc_shade(elegant_array_t* arr);
+static void elegant_gc_safepoint(void);
+
+/*
+ * Hand a fresh header to its owner. Collected arrays are rooted by the
+ * current scope, or else pinned by the creator's reference; other arrays
+ * are released by the current scope in stack arena mode.
+ */
+static void elegant_array_adopt(elegant_array_t* arr) {
+    if (elegant_gc_managed(arr)) {
+        if (elegant_gc_track(arr)) {
+            elegant_scope_frame_t* frame = elegant_current_scope;
+            if (frame) {
+                size_t registered = frame->allocation_count;
+                elegant_scope_register(arr);
+                if (frame->allocation_count > registered) arr->ref_count = 0;
+            }
+            return;
+        }
+        /* Unmanaged from here on; the scope (if any) still releases it */
+        fprintf(stderr, "Elegant: Failed to register array with the collector\n");
+        arr->memory_mode = ELEGANT_MEMORY_STACK_ARENA;
+    }
+    
+    if (!arr->arena && arr->memory_mode == ELEGANT_MEMORY_STACK_ARENA && elegant_current_scope) {
+        elegant_scope_register(arr);
+    }
+}
+
+/* Collected views keep their collected owner alive by tracing, not by a reference */
+static inline bool elegant_array_traces_parent(const elegant_array_t* arr) {
+    return arr->flags & ELEGANT_ARRAY_GC_TRACED;
+}
+
+/* Whether views or copies still read arr's current elements, see "Copy-on-write" below */
+static inline bool elegant_array_has_readers(const elegant_array_t* arr) {
+    return arr->payload && __atomic_load_n(&arr->payload->ref_count, __ATOMIC_ACQUIRE) > 1;
+}
+
+/* Fill in a fresh owning header (data and flags are set by the caller) */
+static void elegant_array_init_header(elegant_array_t* arr, size_t element_size, size_t length,
+                                      elegant_arena_t* arena, const elegant_allocator_t* allocator) {
     arr->element_size = element_size;
     arr->length = length;
     arr->capacity = length;
     arr->ref_count = 1;
+    arr->memory_mode = elegant_current_memory_mode;
     arr->destructor = NULL;
+    arr->parent = NULL;
+    arr->payload = NULL;
+    arr->block_size = 0;
+    arr->arena = arena;
+    arr->allocator = allocator;
     
-    if (length > 0) {
-        arr->data = elegant_calloc(length, element_size);
-        if (!arr->data) {
-            elegant_free(arr);
+    elegant_array_adopt(arr);
+}
+
+static elegant_array_t* elegant_array_alloc(size_t element_size, size_t length, bool zero) {
+    size_t data_size;
+    if (!elegant_array_size_ok(element_size, length, &data_size)) return NULL;
+    
+    elegant_arena_t* arena = elegant_active_arena();
+    const elegant_allocator_t* allocator = arena ? NULL : elegant_current_allocator;
+    size_t header_size = ELEGANT_ARRAY_HEADER_SIZE;
+    elegant_array_t* arr;
+    
+    if (arena) {
+        /* Header and payload share one bump allocation; nothing to register */
+        arr = elegant_arena_alloc(arena, header_size + data_size);
+        if (!arr) return NULL;
+        arr->data = data_size > 0 ? (char*)arr + header_size : NULL;
+        arr->flags = ELEGANT_ARRAY_INLINE_DATA;
+    } else if (data_size >= ELEGANT_HUGE_PAGE_SIZE) {
+        void* data = elegant_payload_alloc(allocator, data_size, zero);
+        if (!data) return NULL;
+        arr = elegant_alloc_from(allocator, sizeof(elegant_array_t), false);
+        if (!arr) {
+            elegant_free_from(allocator, data, data_size);
             return NULL;
         }
+        arr->data = data;
+        arr->flags = 0;
+        zero = false;
+    } else if (data_size > 0) {
+        arr = elegant_alloc_from(allocator, elegant_array_block_size(data_size), zero);
+        if (!arr) return NULL;
+        arr->data = (void*)elegant_align_up((uintptr_t)arr + header_size,
+                                            elegant_payload_align(data_size));
+        arr->flags = ELEGANT_ARRAY_INLINE_DATA;
+        zero = false;
     } else {
+        arr = elegant_alloc_from(allocator, sizeof(elegant_array_t), false);
+        if (!arr) return NULL;
         arr->data = NULL;
+        arr->flags = 0;
     }
     
-    /* Register with current scope if in stack arena mode */
-    if (elegant_current_memory_mode == ELEGANT_MEMORY_STACK_ARENA && elegant_current_scope) {
-        elegant_scope_register(arr);
+    if (zero && arr->data) {
+        memset(arr->data, 0, data_size);
     }
     
+    elegant_array_init_header(arr, element_size, length, arena, allocator);
     return arr;
 }
 
+elegant_array_t* elegant_array_create(size_t element_size, size_t length) {
+    return elegant_array_alloc(element_size, length, true);
+}
+
+elegant_array_t* elegant_array_create_uninit(size_t element_size, size_t length) {
+    return elegant_array_alloc(element_size, length, false);
+}
+
+static bool elegant_array_pass_on(elegant_array_t* arr);
+
+/* Release everything an unreferenced array holds, ref_count aside */
+static void elegant_array_teardown(elegant_array_t* arr) {
+    if (arr->parent) {
+        if (!elegant_array_traces_parent(arr)) elegant_array_destroy(arr->parent);
+        if (!arr->arena) elegant_free_from(arr->allocator, arr, elegant_array_header_bytes(arr));
+        return;
+    }
+    
+    if (arr->payload && elegant_array_pass_on(arr)) return;
+    
+    if (arr->destructor && arr->data) {
+        arr->destructor(arr->data);
+    }
+    
+    /* Arena arrays are reclaimed wholesale when their scope exits */
+    if (arr->arena) return;
+    
+    if (arr->flags & ELEGANT_ARRAY_MAPPED) {
+        if (arr->data) munmap(arr->data, arr->capacity * arr->element_size);
+    } else if (!(arr->flags & ELEGANT_ARRAY_INLINE_DATA)) {
+        elegant_free_from(arr->allocator, arr->data, arr->capacity * arr->element_size);
+    }
+    elegant_free_from(arr->allocator, arr, elegant_array_header_bytes(arr));
+}
+
 void elegant_array_destroy(elegant_array_t* arr) {
     if (!arr) return;
     
-    if (elegant_current_memory_mode == ELEGANT_MEMORY_REFERENCE_COUNTING) {
-        arr->ref_count--;
-        if (arr->ref_count > 0) {
-            return;
-        }
+    /* Collected arrays only drop a pin; the collector frees them */
+    if (elegant_gc_managed(arr)) {
+        if (arr->ref_count > 0) arr->ref_count--;
+        return;
     }
     
-    if (arr->destructor && arr->data) {
-        arr->destructor(arr->data);
+    /* Views hold a reference on their parent, so every mode honours ref_count */
+    if (!elegant_ref_dec(arr)) {
+        return;
     }
     
-    elegant_free(arr->data);
-    elegant_free(arr);
+    elegant_array_teardown(arr);
+}
+
+/*
+ * Small outputs keep the single-block layout and just waste their tail.
+ * Past this size the payload is a separate buffer so it can be shrunk.
+ */
+#define ELEGANT_OUTPUT_SHRINK_BYTES 4096
+
+elegant_array_t* elegant_array_create_output(size_t element_size, size_t capacity) {
+    size_t bytes;
+    if (!elegant_array_size_ok(element_size, capacity, &bytes)) return NULL;
+    
+    /* Huge payloads are already separate buffers */
+    if (bytes < ELEGANT_OUTPUT_SHRINK_BYTES || bytes >= ELEGANT_HUGE_PAGE_SIZE ||
+        elegant_active_arena()) {
+        return elegant_array_create_uninit(element_size, capacity);
+    }
+    
+    void* data = elegant_payload_alloc(elegant_current_allocator, bytes, false);
+    if (!data) return NULL;
+    
+    elegant_array_t* arr = elegant_array_create_uninit(element_size, 0);
+    if (!arr) {
+        elegant_free_from(elegant_current_allocator, data, bytes);
+        return NULL;
+    }
+    
+    arr->data = data;
+    arr->length = capacity;
+    arr->capacity = capacity;
+    return arr;
+}
+
+void elegant_array_finish_output(elegant_array_t* arr, size_t length) {
+    if (!arr || length > arr->capacity) return;
+    
+    arr->length = length;
+    if (length == arr->capacity || arr->parent || arr->arena || elegant_array_has_readers(arr) ||
+        (arr->flags & (ELEGANT_ARRAY_INLINE_DATA | ELEGANT_ARRAY_MAPPED))) {
+        return;
+    }
+    
+    size_t bytes = arr->capacity * arr->element_size;
+    if (length == 0) {
+        elegant_free_from(arr->allocator, arr->data, bytes);
+        arr->data = NULL;
+        arr->capacity = 0;
+        return;
+    }
+    
+    /* Keep the larger buffer if the allocator cannot shrink it */
+    void* shrunk = elegant_realloc_from(arr->allocator, arr->data, bytes,
+                                        length * arr->element_size);
+    if (shrunk) {
+        arr->data = shrunk;
+        arr->capacity = length;
+    }
+}
+
+static int elegant_array_make_private(elegant_array_t* arr);
+
+/*
+ * Growable arrays. The payload moves to its own buffer the first time an
+ * array outgrows its single-block layout, then grows by realloc.
+ */
+static int elegant_array_grow_to(elegant_array_t* arr, size_t capacity) {
+    size_t bytes;
+    if (!elegant_array_size_ok(arr->element_size, capacity, &bytes)) return ENOMEM;
+    
+    size_t used = arr->length * arr->element_size;
+    void* data;
+    
+    if (arr->arena) {
+        /* The old payload stays in the arena until the scope exits */
+        data = elegant_arena_alloc(arr->arena, bytes);
+        if (!data) return ENOMEM;
+        if (used > 0) memcpy(data, arr->data, used);
+        arr->flags &= ~ELEGANT_ARRAY_INLINE_DATA;
+    } else if (arr->flags & ELEGANT_ARRAY_MAPPED) {
+        /* Growing a mapped file copies it to the heap */
+        data = elegant_payload_alloc(arr->allocator, bytes, false);
+        if (!data) return ENOMEM;
+        if (used > 0) memcpy(data, arr->data, used);
+        if (arr->data) munmap(arr->data, arr->capacity * arr->element_size);
+        arr->flags &= ~(ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_READONLY);
+    } else if ((arr->flags & ELEGANT_ARRAY_INLINE_DATA) || !arr->data) {
+        data = elegant_payload_alloc(arr->allocator, bytes, false);
+        if (!data) return ENOMEM;
+        if (used > 0) memcpy(data, arr->data, used);
+        if (arr->flags & ELEGANT_ARRAY_INLINE_DATA) elegant_array_spill(arr);
+    } else {
+        data = elegant_realloc_from(arr->allocator, arr->data,
+                                    arr->capacity * arr->element_size, bytes);
+        if (!data) return ENOMEM;
+    }
+    
+    arr->data = data;
+    arr->capacity = capacity;
+    return 0;
+}
+
+/* Views and sources still being read are given their own storage first */
+static inline int elegant_array_make_growable(elegant_array_t* arr) {
+    if (!arr || arr->element_size == 0) return EINVAL;
+    return elegant_array_make_private(arr);
+}
+
+int elegant_array_reserve(elegant_array_t* arr, size_t capacity) {
+    int err = elegant_array_make_growable(arr);
+    if (err) return err;
+    return capacity > arr->capacity ? elegant_array_grow_to(arr, capacity) : 0;
+}
+
+/* Geometric growth: at least double, so n pushes cost O(n) copies */
+static int elegant_array_grow_for(elegant_array_t* arr, size_t additional) {
+    size_t needed;
+    if (__builtin_add_overflow(arr->length, additional, &needed)) return ENOMEM;
+    if (needed <= arr->capacity) return 0;
+    
+    size_t capacity = arr->capacity < 4 ? 8 : arr->capacity;
+    while (capacity < needed) {
+        capacity = capacity > SIZE_MAX / 2 ? needed : capacity * 2;
+    }
+    return elegant_array_grow_to(arr, capacity);
+}
+
+int elegant_array_push(elegant_array_t* arr, const void* element) {
+    int err = elegant_array_make_growable(arr);
+    if (err || !element) return err ? err : EINVAL;
+    
+    if (arr->length == arr->capacity && (err = elegant_array_grow_for(arr, 1)) != 0) {
+        return err;
+    }
+    
+    memcpy((char*)arr->data + arr->length * arr->element_size, element, arr->element_size);
+    arr->length++;
+    return 0;
+}
+
+int elegant_array_extend(elegant_array_t* arr, const void* elements, size_t count) {
+    int err = elegant_array_make_growable(arr);
+    if (err) return err;
+    if (count == 0) return 0;
+    if (!elements) return EINVAL;
+    
+    /* Appending part of the array to itself must survive the buffer moving */
+    const char* base = (const char*)arr->data;
+    bool aliased = base && (const char*)elements >= base &&
+                   (const char*)elements < base + arr->capacity * arr->element_size;
+    size_t alias_offset = aliased ? (size_t)((const char*)elements - base) : 0;
+    
+    if ((err = elegant_array_grow_for(arr, count)) != 0) return err;
+    if (aliased) elements = (const char*)arr->data + alias_offset;
+    
+    memmove((char*)arr->data + arr->length * arr->element_size, elements,
+            count * arr->element_size);
+    arr->length += count;
+    return 0;
+}
+
+int elegant_array_extend_array(elegant_array_t* arr, elegant_array_t* other) {
+    if (!other) return EINVAL;
+    if (arr && arr->element_size != other->element_size) return EINVAL;
+    
+    void* data = elegant_array_get_data(other);
+    if (other->length > 0 && !data) return ENOMEM;
+    return elegant_array_extend(arr, data, other->length);
+}
+
+int elegant_array_shrink_to_fit(elegant_array_t* arr) {
+    int err = elegant_array_make_growable(arr);
+    if (err) return err;
+    
+    /* Single-block and arena payloads cannot be given back separately */
+    if (arr->length == arr->capacity || arr->arena ||
+        (arr->flags & (ELEGANT_ARRAY_INLINE_DATA | ELEGANT_ARRAY_MAPPED))) {
+        return 0;
+    }
+    
+    elegant_array_finish_output(arr, arr->length);
+    return arr->capacity == arr->length ? 0 : ENOMEM;
+}
+
+/* Builder: a bare growable buffer, adopted as an array's payload at the end */
+void elegant_builder_init(elegant_array_builder_t* builder, size_t element_size, size_t capacity) {
+    if (!builder) return;
+    builder->data = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+    builder->element_size = element_size;
+    builder->allocator = elegant_current_allocator;
+    if (capacity > 0) elegant_builder_reserve(builder, capacity);
+}
+
+int elegant_builder_reserve(elegant_array_builder_t* builder, size_t additional) {
+    if (!builder || builder->element_size == 0) return EINVAL;
+    
+    size_t needed;
+    if (__builtin_add_overflow(builder->length, additional, &needed)) return ENOMEM;
+    if (needed <= builder->capacity) return 0;
+    
+    size_t capacity = builder->capacity < 4 ? 8 : builder->capacity * 2;
+    if (capacity < needed || capacity < builder->capacity) capacity = needed;
+    
+    size_t bytes;
+    if (!elegant_array_size_ok(builder->element_size, capacity, &bytes)) return ENOMEM;
+    
+    void* data = elegant_realloc_from(builder->allocator, builder->data,
+                                      builder->capacity * builder->element_size, bytes);
+    if (!data) return ENOMEM;
+    
+    builder->data = data;
+    builder->capacity = capacity;
+    return 0;
+}
+
+int elegant_builder_extend(elegant_array_builder_t* builder, const void* elements, size_t count) {
+    if (count == 0) return 0;
+    if (!elements) return EINVAL;
+    
+    int err = elegant_builder_reserve(builder, count);
+    if (err) return err;
+    
+    memcpy(builder->data + builder->length * builder->element_size, elements,
+           count * builder->element_size);
+    builder->length += count;
+    return 0;
+}
+
+void elegant_builder_discard(elegant_array_builder_t* builder) {
+    if (!builder) return;
+    elegant_free_from(builder->allocator, builder->data,
+                      builder->capacity * builder->element_size);
+    builder->data = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+}
+
+elegant_array_t* elegant_builder_finish(elegant_array_builder_t* builder) {
+    if (!builder || builder->element_size == 0) return NULL;
+    
+    size_t length = builder->length;
+    elegant_array_t* arr;
+    
+    if (length == 0 || elegant_active_arena() || builder->allocator != elegant_current_allocator) {
+        /* The buffer cannot be adopted; copy it into a regular array */
+        arr = elegant_array_create_uninit(builder->element_size, length);
+        if (arr && length > 0) memcpy(arr->data, builder->data, length * builder->element_size);
+        elegant_builder_discard(builder);
+        return arr;
+    }
+    
+    arr = elegant_array_create_uninit(builder->element_size, 0);
+    if (!arr) {
+        elegant_builder_discard(builder);
+        return NULL;
+    }
+    
+    arr->data = builder->data;
+    arr->length = length;
+    arr->capacity = builder->capacity;
+    builder->data = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+    
+    elegant_array_finish_output(arr, length);
+    return arr;
+}
+
+static elegant_array_t* elegant_array_make_view(elegant_array_t* arr, size_t first, size_t length);
+
+/*
+ * Copy-on-write. Views and copies of an array hold a hidden payload header
+ * (ELEGANT_ARRAY_PAYLOAD) made on first use, never the array itself, and
+ * the array holds one reference on it. Nothing is copied while they only
+ * read. Writing the array while they still hold the header gives the array
+ * a fresh copy and leaves them the old elements: the header takes over a
+ * separate buffer, or else keeps the array's block alive. Writing a view or
+ * copy copies that handle alone. Collected arrays and headers embedded in
+ * other structures (stream chunks) get no payload header; their views read
+ * the array directly and see its later writes.
+ */
+static inline bool elegant_array_copies_on_write(const elegant_array_t* arr) {
+    if (arr->parent) return (arr->parent->flags & ELEGANT_ARRAY_PAYLOAD) != 0;
+    return !elegant_gc_managed(arr) && (arr->allocator || arr->arena);
+}
+
+/* Readers on several threads may race to make it: one header wins, the rest are freed */
+static elegant_array_t* elegant_array_payload(elegant_array_t* arr) {
+    elegant_array_t* payload = __atomic_load_n(&arr->payload, __ATOMIC_ACQUIRE);
+    if (payload) return payload;
+    
+    payload = arr->arena ? elegant_arena_alloc(arr->arena, sizeof(elegant_array_t))
+                         : elegant_alloc_from(arr->allocator, sizeof(elegant_array_t), false);
+    if (!payload) return NULL;
+    
+    memset(payload, 0, sizeof(*payload));
+    payload->element_size = arr->element_size;
+    payload->ref_count = 1;  /* arr's */
+    payload->flags = ELEGANT_ARRAY_PAYLOAD;
+    /* Views of one array may be released on any thread */
+    payload->memory_mode = ELEGANT_MEMORY_SHARED_REFERENCE_COUNTING;
+    payload->parent = arr;   /* not counted while arr holds the header */
+    payload->arena = arr->arena;
+    payload->allocator = arr->allocator;
+    
+    elegant_array_t* expected = NULL;
+    if (!__atomic_compare_exchange_n(&arr->payload, &expected, payload, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        if (!arr->arena) elegant_free_from(arr->allocator, payload, sizeof(elegant_array_t));
+        return expected;
+    }
+    return payload;
+}
+
+/* The payload header takes over arr's separate buffer and stops depending on arr */
+static void elegant_payload_take_storage(elegant_array_t* payload, elegant_array_t* arr) {
+    payload->data = arr->data;
+    payload->length = arr->length;
+    payload->capacity = arr->capacity;
+    payload->flags |= arr->flags & (ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_READONLY |
+                                    ELEGANT_ARRAY_RANDOM_ACCESS);
+    payload->parent = NULL;
+}
+
+/* Before arr itself is written: its readers keep the elements they saw */
+static int elegant_array_unshare(elegant_array_t* arr) {
+    if (!elegant_array_has_readers(arr)) return 0;
+    
+    size_t bytes = arr->capacity * arr->element_size;
+    void* data = NULL;
+    if (bytes > 0) {
+        data = arr->arena ? elegant_arena_alloc(arr->arena, bytes)
+                          : elegant_payload_alloc(arr->allocator, bytes, false);
+        if (!data) return ENOMEM;
+        memcpy(data, arr->data, arr->length * arr->element_size);
+    }
+    
+    elegant_array_t* payload = arr->payload;
+    if (arr->arena) {
+        /* The old elements stay in the arena until the scope exits */
+        arr->flags &= ~ELEGANT_ARRAY_INLINE_DATA;
+        payload->parent = NULL;
+    } else if (arr->flags & ELEGANT_ARRAY_INLINE_DATA) {
+        /* They live in arr's block, which now stays until the readers are done */
+        elegant_array_spill(arr);
+        elegant_ref_inc(arr);
+    } else {
+        elegant_payload_take_storage(payload, arr);
+        arr->flags &= ~(ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_READONLY);
+    }
+    
+    arr->data = data;
+    arr->payload = NULL;
+    elegant_array_destroy(payload);
+    return 0;
+}
+
+/*
+ * arr is going: readers still holding its payload header inherit a separate
+ * buffer, or keep arr's block alive. True if that leaves nothing to free.
+ */
+static bool elegant_array_pass_on(elegant_array_t* arr) {
+    elegant_array_t* payload = arr->payload;
+    arr->payload = NULL;
+    
+    /* Arena storage stays until the scope exits whoever reads it */
+    if (arr->arena) return false;
+    
+    if (__atomic_load_n(&payload->ref_count, __ATOMIC_ACQUIRE) == 1) {
+        elegant_free_from(payload->allocator, payload, sizeof(elegant_array_t));
+        return false;
+    }
+    
+    if (arr->flags & ELEGANT_ARRAY_INLINE_DATA) {
+        arr->ref_count = 1;  /* now the payload header's */
+    } else {
+        elegant_payload_take_storage(payload, arr);
+        payload->destructor = arr->destructor;
+        elegant_free_from(arr->allocator, arr, elegant_array_header_bytes(arr));
+    }
+    elegant_array_destroy(payload);
+    return true;
+}
+
+/* The last reader of a payload its source has let go takes the buffer over */
+static bool elegant_array_reclaim_payload(elegant_array_t* arr) {
+    elegant_array_t* payload = arr->parent;
+    if (!(payload->flags & ELEGANT_ARRAY_PAYLOAD) || payload->parent ||
+        __atomic_load_n(&payload->ref_count, __ATOMIC_ACQUIRE) != 1 ||
+        payload->allocator != arr->allocator || payload->arena != arr->arena ||
+        !payload->data || arr->data != payload->data) {
+        return false;
+    }
+    
+    arr->capacity = payload->capacity;
+    arr->flags |= payload->flags & (ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_READONLY);
+    if (payload->destructor) arr->destructor = payload->destructor;
+    arr->parent = NULL;
+    
+    /* The header alone goes: its buffer now belongs to arr */
+    if (!payload->arena) elegant_free_from(payload->allocator, payload, sizeof(elegant_array_t));
+    return true;
 }
 
 elegant_array_t* elegant_array_copy(elegant_array_t* arr) {
     if (!arr) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
-    if (elegant_current_memory_mode == ELEGANT_MEMORY_REFERENCE_COUNTING) {
-        arr->ref_count++;
+    /* Arrays published to other threads are shared, since their headers can't change */
+    if (elegant_array_is_atomic(arr)) {
+        elegant_ref_inc(arr);
+        elegant_stats_end(&probe, ELEGANT_OP_COPY, 0);
         return arr;
     }
     
-    elegant_array_t* new_arr = elegant_array_create(arr->element_size, arr->length);
+    if (elegant_array_copies_on_write(arr)) {
+        elegant_array_t* copy = elegant_array_make_view(arr, 0, arr->length);
+        if (copy) {
+            copy->destructor = arr->destructor;
+            elegant_stats_end(&probe, ELEGANT_OP_COPY, 0);
+        }
+        return copy;
+    }
+    
+    void* src_data = elegant_array_get_data(arr);
+    elegant_array_t* new_arr = elegant_array_create_uninit(arr->element_size, arr->length);
     if (!new_arr) return NULL;
     
-    if (arr->data && new_arr->data) {
+    if (src_data && new_arr->data) {
         size_t copy_bytes = arr->length * arr->element_size;
-        if (elegant_memcpy_safe(new_arr->data, copy_bytes, arr->data, copy_bytes) != 0) {
+        if (elegant_memcpy_safe(new_arr->data, copy_bytes, src_data, copy_bytes) != 0) {
             elegant_array_destroy(new_arr);
             return NULL;
         }
     }
     
     new_arr->destructor = arr->destructor;
+    elegant_stats_end(&probe, ELEGANT_OP_COPY, arr->length);
     return new_arr;
 }
 
+/* Give a view its own copy of the elements it covers and drop the reference on its parent */
+static int elegant_array_detach(elegant_array_t* arr) {
+    if (!arr->parent) return 0;
+    if (elegant_array_reclaim_payload(arr)) return 0;
+    
+    char* owned = NULL;
+    if (arr->length > 0) {
+        size_t bytes = arr->length * arr->element_size;
+        owned = arr->arena ? elegant_arena_alloc(arr->arena, bytes)
+                           : elegant_alloc_from(arr->allocator, bytes, false);
+        if (!owned) return ENOMEM;
+        memcpy(owned, arr->data, bytes);
+    }
+    
+    elegant_array_t* parent = arr->parent;
+    bool traced = elegant_array_traces_parent(arr);
+    arr->data = owned;
+    arr->capacity = arr->length;
+    arr->parent = NULL;
+    arr->flags &= ~ELEGANT_ARRAY_GC_TRACED;
+    if (!traced) elegant_array_destroy(parent);
+    
+    return 0;
+}
+
+/* Before arr is written or resized: views detach, sources still being read copy */
+static int elegant_array_make_private(elegant_array_t* arr) {
+    return arr->parent ? elegant_array_detach(arr) : elegant_array_unshare(arr);
+}
+
 void* elegant_array_get_data(elegant_array_t* arr) {
     return arr ? arr->data : NULL;
 }
 
+void* elegant_array_get_mutable_data(elegant_array_t* arr) {
+    if (!arr || elegant_array_make_private(arr) != 0) return NULL;
+    
+    /* Private mapping: written pages are copied by the kernel, the file is untouched */
+    if (arr->flags & ELEGANT_ARRAY_READONLY) {
+        if (mprotect(arr->data, arr->capacity * arr->element_size, PROT_READ | PROT_WRITE) != 0) {
+            return NULL;
+        }
+        arr->flags &= ~ELEGANT_ARRAY_READONLY;
+    }
+    
+    return arr->data;
+}
+
 size_t elegant_array_get_length(elegant_array_t* arr) {
     return arr ? arr->length : 0;
 }
 
 elegant_array_t* elegant_array_retain(elegant_array_t* arr) {
     if (arr) {
-        arr->ref_count++;
+        elegant_ref_inc(arr);
+        if (elegant_gc_managed(arr)) elegant_gc_shade(arr);
     }
     return arr;
 }
 
 void elegant_array_release(elegant_array_t* arr) {
-    if (arr) {
-        arr->ref_count--;
-        if (arr->ref_count <= 0) {
-            elegant_array_destroy(arr);
+    elegant_array_destroy(arr);
+}
+
+elegant_array_t* elegant_array_share(elegant_array_t* arr) {
+    if (!arr) return NULL;
+    
+    /* Arena storage dies with its scope, whoever still holds a reference */
+    for (const elegant_array_t* owner = arr; owner; owner = owner->parent) {
+        if (owner->arena) {
+            fprintf(stderr, "Elegant: Cannot share an arena array\n");
+            return NULL;
         }
+        if (elegant_gc_managed(owner)) {
+            fprintf(stderr, "Elegant: Cannot share a collected array\n");
+            return NULL;
+        }
+    }
+    
+    /* Must happen before the array is published to other threads; covers a view's owners too */
+    for (elegant_array_t* owner = arr; owner; owner = owner->parent) {
+        owner->memory_mode = ELEGANT_MEMORY_SHARED_REFERENCE_COUNTING;
+    }
+    return arr;
+}
+
+bool elegant_array_is_shared(const elegant_array_t* arr) {
+    return arr && elegant_array_is_atomic(arr);
+}
+
+bool elegant_array_is_view(const elegant_array_t* arr) {
+    return arr && arr->parent != NULL;
+}
+
+/*
+ * Build a view over `length` elements of arr starting at `first`. Views of
+ * views are rebased onto the same owner so chains never nest; arr itself
+ * only sees atomic updates, so several readers may slice it at once.
+ */
+static elegant_array_t* elegant_array_make_view(elegant_array_t* arr, size_t first, size_t length) {
+    elegant_array_t* root = arr->parent;
+    if (!root) root = elegant_array_copies_on_write(arr) ? elegant_array_payload(arr) : arr;
+    if (!root) return NULL;
+    
+    /*
+     * A view may only live in the arena when its owner does: arena views are
+     * never destroyed individually, so they must not pin heap arrays.
+     */
+    elegant_arena_t* arena = root->arena ? elegant_active_arena() : NULL;
+    const elegant_allocator_t* allocator = arena ? NULL : elegant_current_allocator;
+    elegant_array_t* view = arena ? elegant_arena_alloc(arena, sizeof(elegant_array_t))
+                                  : elegant_alloc_from(allocator, sizeof(elegant_array_t), false);
+    if (!view) return NULL;
+    
+    view->data = arr->data && length > 0 ? (char*)arr->data + first * arr->element_size : arr->data;
+    view->length = length;
+    view->element_size = arr->element_size;
+    view->capacity = length;
+    view->ref_count = 1;
+    view->memory_mode = elegant_current_memory_mode;
+    view->flags = 0;
+    view->destructor = NULL;
+    view->parent = root;
+    view->payload = NULL;
+    view->block_size = 0;
+    view->arena = arena;
+    view->allocator = allocator;
+    
+    elegant_array_adopt(view);
+    if (elegant_gc_managed(view) && elegant_gc_managed(root)) {
+        view->flags |= ELEGANT_ARRAY_GC_TRACED;
+        elegant_gc_shade(view);
+    } else {
+        elegant_array_retain(root);
+    }
+    
+    return view;
+}
+
+/* Clamped view, counted as `op` */
+static elegant_array_t* elegant_array_view_op(elegant_array_t* arr, size_t offset, size_t length,
+                                              elegant_op_t op) {
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(arr);
+    if (offset > len) offset = len;
+    if (length > len - offset) length = len - offset;
+    
+    elegant_array_t* view = elegant_array_make_view(arr, offset, length);
+    if (view) elegant_stats_end(&probe, op, length);
+    return view;
+}
+
+elegant_array_t* elegant_array_slice(elegant_array_t* arr, size_t offset, size_t length) {
+    if (!arr) return NULL;
+    
+    return elegant_array_view_op(arr, offset, length, ELEGANT_OP_SLICE);
+}
+
+/* File-mapped arrays */
+elegant_array_t* elegant_array_map_fd(int fd, size_t offset, size_t element_size,
+                                      size_t length, unsigned int flags) {
+    size_t bytes;
+    if (fd < 0 || element_size == 0 || offset % (size_t)sysconf(_SC_PAGESIZE) != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!elegant_array_size_ok(element_size, length, &bytes)) return NULL;
+    
+    void* data = NULL;
+    if (bytes > 0) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            fprintf(stderr, "Elegant: Cannot stat file: %s\n", strerror(errno));
+            return NULL;
+        }
+        /* Pages past the end of a file map fine but raise SIGBUS when touched */
+        if (S_ISREG(st.st_mode) &&
+            (offset > (uint64_t)st.st_size || bytes > (uint64_t)st.st_size - offset)) {
+            fprintf(stderr, "Elegant: Mapping %zu bytes at offset %zu runs past the end of the file\n",
+                    bytes, offset);
+            errno = EINVAL;
+            return NULL;
+        }
+        
+        int map_flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (flags & ELEGANT_MAP_POPULATE) map_flags |= MAP_POPULATE;
+#endif
+        data = mmap(NULL, bytes, PROT_READ, map_flags, fd, (off_t)offset);
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "Elegant: Cannot map file: %s\n", strerror(errno));
+            return NULL;
+        }
+        if (flags & ELEGANT_MAP_WILLNEED) madvise(data, bytes, MADV_WILLNEED);
+        if (flags & ELEGANT_MAP_RANDOM) madvise(data, bytes, MADV_RANDOM);
+    }
+    
+    const elegant_allocator_t* allocator = elegant_current_allocator;
+    elegant_array_t* arr = elegant_alloc_from(allocator, sizeof(elegant_array_t), false);
+    if (!arr) {
+        if (data) munmap(data, bytes);
+        return NULL;
+    }
+    
+    /* The header stays on the heap even in arena scopes so destroy can unmap */
+    arr->data = data;
+    arr->flags = data ? ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_READONLY : 0;
+    elegant_array_init_header(arr, element_size, length, NULL, allocator);
+    if (flags & ELEGANT_MAP_RANDOM) arr->flags |= ELEGANT_ARRAY_RANDOM_ACCESS;
+    return arr;
+}
+
+elegant_array_t* elegant_array_map_file(const char* path, size_t element_size, unsigned int flags) {
+    if (!path || element_size == 0) {
+        errno = EINVAL;
+        return NULL;
     }
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Elegant: Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "Elegant: Cannot stat %s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    
+    /* A trailing partial element is not mapped */
+    elegant_array_t* arr = elegant_array_map_fd(fd, 0, element_size,
+                                                (size_t)st.st_size / element_size, flags);
+    close(fd);
+    return arr;
+}
+
+/* Header whose flags describe the storage arr's elements live in */
+static const elegant_array_t* elegant_array_storage(const elegant_array_t* arr) {
+    while (arr->parent) arr = arr->parent;
+    return arr;
+}
+
+bool elegant_array_is_mapped(const elegant_array_t* arr) {
+    return arr && (elegant_array_storage(arr)->flags & ELEGANT_ARRAY_MAPPED) != 0;
+}
+
+/* Read-ahead for the range a scan is about to walk; only mapped arrays need it */
+void elegant_array_advise_scan(const elegant_array_t* arr) {
+    if (!arr || arr->length == 0) return;
+    
+    const elegant_array_t* root = elegant_array_storage(arr);
+    if ((root->flags & (ELEGANT_ARRAY_MAPPED | ELEGANT_ARRAY_RANDOM_ACCESS)) != ELEGANT_ARRAY_MAPPED) {
+        return;
+    }
+    
+    static size_t page_size = 0;
+    if (page_size == 0) page_size = (size_t)sysconf(_SC_PAGESIZE);
+    
+    size_t bytes = arr->length * arr->element_size;
+    uintptr_t start = (uintptr_t)arr->data;
+    uintptr_t end = start + bytes;
+    start &= ~(uintptr_t)(page_size - 1);
+    
+    madvise((void*)start, end - start, MADV_SEQUENTIAL);
+    madvise((void*)start, end - start, MADV_WILLNEED);
 }
 
 /* Generic array creation implementation */
 elegant_array_t* elegant_create_array_impl(size_t element_size, void* data, size_t length) {
-    elegant_array_t* arr = elegant_array_create(element_size, length);
+    elegant_array_t* arr = data ? elegant_array_create_uninit(element_size, length)
+                                : elegant_array_create(element_size, length);
     if (!arr) return NULL;
     
     if (data && arr->data && length > 0) {
@@ -216,37 +1353,114 @@ elegant_array_t* elegant_create_array_impl(size_t element_size, void* data, size
     return arr;
 }
 
-/* Scope management implementation */
-void elegant_scope_enter(void) {
-    elegant_scope_frame_t* frame = elegant_malloc(sizeof(elegant_scope_frame_t));
-    if (!frame) {
-        fprintf(stderr, "Elegant: Failed to allocate scope frame\n");
+/* Scope management implementation */
+static void elegant_scope_note_enter(void) {
+    ELEGANT_STATS_ADD(scope_enters, 1);
+    ELEGANT_STATS_ADD(scope_depth, 1);
+    if (elegant_thread_stats.scope_depth > elegant_thread_stats.scope_max_depth) {
+        ELEGANT_STATS_STORE(scope_max_depth, elegant_thread_stats.scope_depth);
+    }
+}
+
+static void elegant_scope_note_exit(const elegant_scope_frame_t* frame) {
+    elegant_thread_stats_t* stats = &elegant_thread_stats;
+    ELEGANT_STATS_ADD(scope_depth, -1);
+    ELEGANT_STATS_ADD(scope_frame_arrays, frame->allocation_count);
+    if (frame->allocation_count > stats->scope_max_frame_arrays) {
+        ELEGANT_STATS_STORE(scope_max_frame_arrays, frame->allocation_count);
+    }
+    if (frame->arena && frame->arena->bytes_used > stats->scope_max_arena_bytes) {
+        ELEGANT_STATS_STORE(scope_max_arena_bytes, frame->arena->bytes_used);
+    }
+}
+
+void elegant_scope_enter(void) {
+    elegant_scope_frame_t* frame = elegant_alloc_from(elegant_current_allocator,
+                                                      sizeof(elegant_scope_frame_t), false);
+    if (!frame) {
+        fprintf(stderr, "Elegant: Failed to allocate scope frame\n");
+        return;
+    }
+    
+    frame->allocations = NULL;
+    frame->allocation_count = 0;
+    frame->allocation_capacity = 0;
+    frame->parent = elegant_current_scope;
+    frame->arena = NULL;
+    frame->outer_allocator = elegant_current_allocator;
+    
+    elegant_current_scope = frame;
+    elegant_scope_note_enter();
+}
+
+void elegant_scope_enter_allocator(const elegant_allocator_t* allocator) {
+    elegant_scope_frame_t* outer = elegant_current_scope;
+    elegant_scope_enter();
+    if (elegant_current_scope != outer) {
+        elegant_set_allocator(allocator);
+    }
+}
+
+void elegant_scope_enter_arena(void) {
+    elegant_arena_chunk_t* chunk = elegant_arena_chunk_new(ELEGANT_ARENA_CHUNK_SIZE);
+    if (!chunk) {
+        fprintf(stderr, "Elegant: Failed to allocate scope arena\n");
         return;
     }
     
+    /* The frame and its arena descriptor sit at the start of the first chunk */
+    elegant_scope_frame_t* frame = (elegant_scope_frame_t*)elegant_arena_chunk_base(chunk);
+    elegant_arena_t* arena = (elegant_arena_t*)(frame + 1);
+    chunk->used = elegant_align_up(sizeof(elegant_scope_frame_t) + sizeof(elegant_arena_t),
+                                   ELEGANT_ARENA_ALIGN);
+    
+    arena->head = chunk;
+    arena->bytes_used = 0;
+    
     frame->allocations = NULL;
     frame->allocation_count = 0;
     frame->allocation_capacity = 0;
     frame->parent = elegant_current_scope;
+    frame->arena = arena;
+    frame->outer_allocator = elegant_current_allocator;
     
     elegant_current_scope = frame;
+    elegant_scope_note_enter();
+}
+
+void* elegant_scope_alloc(size_t size) {
+    if (!elegant_current_scope || !elegant_current_scope->arena || size == 0) return NULL;
+    return elegant_arena_alloc(elegant_current_scope->arena, size);
 }
 
 void elegant_scope_exit(void) {
     if (!elegant_current_scope) return;
     
     elegant_scope_frame_t* frame = elegant_current_scope;
+    elegant_scope_note_exit(frame);
     
-    /* Clean up all allocations in this scope */
+    /* Clean up heap allocations registered with this scope; collected ones just lose their root */
     for (size_t i = 0; i < frame->allocation_count; i++) {
-        if (frame->allocations[i]) {
+        if (frame->allocations[i] && !elegant_gc_managed(frame->allocations[i])) {
             elegant_array_destroy(frame->allocations[i]);
         }
     }
     
-    elegant_free(frame->allocations);
+    /* The frame and its bookkeeping belong to the allocator current at entry */
+    const elegant_allocator_t* allocator = frame->outer_allocator;
+    elegant_current_allocator = allocator;
+    elegant_free_from(allocator, frame->allocations,
+                      frame->allocation_capacity * sizeof(elegant_array_t*));
     elegant_current_scope = frame->parent;
-    elegant_free(frame);
+    
+    if (frame->arena) {
+        /* Frees the frame too, which lives in the oldest chunk */
+        elegant_arena_release(frame->arena->head);
+    } else {
+        elegant_free_from(allocator, frame, sizeof(elegant_scope_frame_t));
+    }
+    
+    elegant_gc_safepoint();
 }
 
 void elegant_scope_register(elegant_array_t* array) {
@@ -257,8 +1471,10 @@ void elegant_scope_register(elegant_array_t* array) {
     /* Resize allocation array if needed */
     if (frame->allocation_count >= frame->allocation_capacity) {
         size_t new_capacity = frame->allocation_capacity ? frame->allocation_capacity * 2 : 8;
-        elegant_array_t** new_allocations = elegant_realloc(
-            frame->allocations, 
+        elegant_array_t** new_allocations = elegant_realloc_from(
+            frame->outer_allocator,
+            frame->allocations,
+            frame->allocation_capacity * sizeof(elegant_array_t*),
             new_capacity * sizeof(elegant_array_t*)
         );
         
@@ -272,13 +1488,230 @@ void elegant_scope_register(elegant_array_t* array) {
     }
     
     frame->allocations[frame->allocation_count++] = array;
+    array->flags |= ELEGANT_ARRAY_SCOPED;
+}
+
+/*
+ * Garbage collection: an incremental mark-sweep collector for arrays
+ * created in ELEGANT_MEMORY_GARBAGE_COLLECTION mode. Each thread has its
+ * own heap. Roots are the arrays registered with live scope frames and
+ * arrays with a nonzero ref_count (pins); a collected view keeps its owner
+ * alive. Work runs in slices at safepoints (scope exit, elegant_gc_step)
+ * and each slice stops once the pause budget is spent. Arrays created
+ * while a cycle runs, and arrays pinned while it marks, survive it.
+ */
+typedef enum {
+    ELEGANT_GC_IDLE = 0,
+    ELEGANT_GC_MARK,   /* scanning the heap for pins */
+    ELEGANT_GC_SWEEP
+} elegant_gc_phase_t;
+
+typedef struct elegant_gc_heap {
+    elegant_array_t** objects;
+    size_t count;
+    size_t capacity;
+    const elegant_allocator_t* allocator;   /* current when the object list was started */
+    size_t cursor;            /* next object to scan or sweep */
+    elegant_gc_phase_t phase;
+    size_t allocated_bytes;   /* created since the last cycle finished */
+    size_t survivor_bytes;    /* swept and kept so far this cycle */
+    elegant_gc_stats_t stats;
+} elegant_gc_heap_t;
+
+static __thread elegant_gc_heap_t elegant_gc_heap;
+static __thread size_t elegant_gc_threshold = ELEGANT_GC_THRESHOLD;
+static __thread uint64_t elegant_gc_pause_budget = ELEGANT_GC_PAUSE_BUDGET_NS;
+
+/* Objects handled between clock reads */
+#define ELEGANT_GC_CLOCK_INTERVAL 64
+
+static uint64_t elegant_gc_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Header plus any separate payload */
+static size_t elegant_gc_array_bytes(elegant_array_t* arr) {
+    size_t bytes = elegant_array_header_bytes(arr);
+    if (!arr->parent && !(arr->flags & ELEGANT_ARRAY_INLINE_DATA)) {
+        bytes += arr->capacity * arr->element_size;
+    }
+    return bytes;
+}
+
+static bool elegant_gc_track(elegant_array_t* arr) {
+    elegant_gc_heap_t* heap = &elegant_gc_heap;
+    
+    if (heap->count == heap->capacity) {
+        if (!heap->objects) heap->allocator = elegant_current_allocator;
+        size_t capacity = heap->capacity ? heap->capacity * 2 : 64;
+        elegant_array_t** objects = elegant_realloc_from(heap->allocator, heap->objects,
+                                                         heap->capacity * sizeof(elegant_array_t*),
+                                                         capacity * sizeof(elegant_array_t*));
+        if (!objects) return false;
+        heap->objects = objects;
+        heap->capacity = capacity;
+    }
+    
+    heap->objects[heap->count++] = arr;
+    heap->allocated_bytes += elegant_gc_array_bytes(arr);
+    
+    /* Born marked; appended past the cursor, so a sweep in progress reaches it */
+    if (heap->phase != ELEGANT_GC_IDLE) arr->flags |= ELEGANT_ARRAY_GC_MARK;
+    return true;
+}
+
+/*
+ * Mark an array reachable, with the owner it traces. Only needed while
+ * marking: once the sweep starts every reachable array is already marked,
+ * and marks set behind the sweep would leak into the next cycle.
+ */
+static void elegant_gc_shade(elegant_array_t* arr) {
+    if (elegant_gc_heap.phase != ELEGANT_GC_MARK) return;
+    
+    arr->flags |= ELEGANT_ARRAY_GC_MARK;
+    if (elegant_array_traces_parent(arr)) {
+        arr->parent->flags |= ELEGANT_ARRAY_GC_MARK;
+    }
+}
+
+/* Start a cycle: mark everything the live scopes hold */
+static void elegant_gc_begin_cycle(elegant_gc_heap_t* heap) {
+    heap->phase = ELEGANT_GC_MARK;
+    heap->cursor = 0;
+    heap->survivor_bytes = 0;
+    
+    for (elegant_scope_frame_t* frame = elegant_current_scope; frame; frame = frame->parent) {
+        for (size_t i = 0; i < frame->allocation_count; i++) {
+            elegant_array_t* arr = frame->allocations[i];
+            if (arr && elegant_gc_managed(arr)) elegant_gc_shade(arr);
+        }
+    }
+}
+
+/* Handle one object at the cursor; false once the phase is complete */
+static bool elegant_gc_advance(elegant_gc_heap_t* heap) {
+    if (heap->cursor >= heap->count) {
+        if (heap->phase == ELEGANT_GC_MARK) {
+            heap->phase = ELEGANT_GC_SWEEP;
+            heap->cursor = 0;
+            return true;
+        }
+        heap->phase = ELEGANT_GC_IDLE;
+        heap->allocated_bytes = 0;
+        heap->stats.collections++;
+        heap->stats.live_bytes = heap->survivor_bytes;
+        
+        /* Nothing left to track: hand the list back so it doesn't outlive its allocator */
+        if (heap->count == 0) {
+            elegant_free_from(heap->allocator, heap->objects, heap->capacity * sizeof(elegant_array_t*));
+            heap->objects = NULL;
+            heap->capacity = 0;
+        }
+        return false;
+    }
+    
+    elegant_array_t* arr = heap->objects[heap->cursor];
+    
+    if (heap->phase == ELEGANT_GC_MARK) {
+        if (arr->ref_count > 0) elegant_gc_shade(arr);
+        heap->cursor++;
+        return true;
+    }
+    
+    if ((arr->flags & ELEGANT_ARRAY_GC_MARK) || arr->ref_count > 0) {
+        arr->flags &= ~ELEGANT_ARRAY_GC_MARK;
+        heap->survivor_bytes += elegant_gc_array_bytes(arr);
+        heap->cursor++;
+        return true;
+    }
+    
+    /* Unreachable: the last object takes its slot and is looked at next */
+    heap->objects[heap->cursor] = heap->objects[--heap->count];
+    heap->stats.freed_arrays++;
+    heap->stats.freed_bytes += elegant_gc_array_bytes(arr);
+    elegant_array_teardown(arr);
+    return true;
+}
+
+/* Run collector work for up to `budget` ns (0 for no limit) */
+static void elegant_gc_run(elegant_gc_heap_t* heap, uint64_t budget) {
+    uint64_t start = elegant_gc_now();
+    uint64_t now = start;
+    
+    if (heap->phase == ELEGANT_GC_IDLE) elegant_gc_begin_cycle(heap);
+    
+    for (size_t n = 1; elegant_gc_advance(heap); n++) {
+        if (budget && n % ELEGANT_GC_CLOCK_INTERVAL == 0) {
+            now = elegant_gc_now();
+            if (now - start >= budget) break;
+        }
+    }
+    
+    now = elegant_gc_now();
+    uint64_t pause = now - start;
+    heap->stats.steps++;
+    heap->stats.total_pause_ns += pause;
+    if (pause > heap->stats.max_pause_ns) heap->stats.max_pause_ns = pause;
+}
+
+/* Due when new allocation reaches the threshold or the live heap, whichever is larger */
+static bool elegant_gc_due(const elegant_gc_heap_t* heap) {
+    size_t trigger = heap->stats.live_bytes > elegant_gc_threshold ? heap->stats.live_bytes
+                                                                   : elegant_gc_threshold;
+    return heap->count > 0 && heap->allocated_bytes >= trigger;
+}
+
+static void elegant_gc_safepoint(void) {
+    elegant_gc_heap_t* heap = &elegant_gc_heap;
+    if (heap->phase != ELEGANT_GC_IDLE || elegant_gc_due(heap)) {
+        elegant_gc_run(heap, elegant_gc_pause_budget);
+    }
+}
+
+bool elegant_gc_step(void) {
+    elegant_gc_safepoint();
+    return elegant_gc_heap.phase != ELEGANT_GC_IDLE;
+}
+
+void elegant_gc_collect(void) {
+    elegant_gc_heap_t* heap = &elegant_gc_heap;
+    
+    /* Anything allocated during an unfinished cycle survives it, so run one more */
+    if (heap->phase != ELEGANT_GC_IDLE) elegant_gc_run(heap, 0);
+    if (heap->count > 0) elegant_gc_run(heap, 0);
+}
+
+void elegant_gc_set_threshold(size_t bytes) {
+    elegant_gc_threshold = bytes;
+}
+
+void elegant_gc_set_pause_budget(uint64_t nanoseconds) {
+    elegant_gc_pause_budget = nanoseconds;
+}
+
+elegant_array_t* elegant_gc_pin(elegant_array_t* arr) {
+    return elegant_array_retain(arr);
+}
+
+void elegant_gc_unpin(elegant_array_t* arr) {
+    elegant_array_release(arr);
+}
+
+void elegant_gc_get_stats(elegant_gc_stats_t* stats) {
+    if (!stats) return;
+    *stats = elegant_gc_heap.stats;
+    stats->tracked_arrays = elegant_gc_heap.count;
 }
 
 #ifdef ELEGANT_DEBUG_MEMORY
 void elegant_memory_debug_dump(void) {
     printf("Elegant Memory Debug:\n");
-    printf("  Allocated bytes: %zu\n", elegant_allocated_bytes);
-    printf("  Active allocations: %zu\n", elegant_allocation_count);
+    printf("  Allocated bytes: %llu\n", (unsigned long long)elegant_thread_stats.allocated_bytes);
+    printf("  Freed bytes: %llu\n", (unsigned long long)elegant_thread_stats.freed_bytes);
+    printf("  Active allocations: %llu\n",
+           (unsigned long long)(elegant_thread_stats.allocations - elegant_thread_stats.frees));
     printf("  Current memory mode: %d\n", elegant_current_memory_mode);
 }
 #endif
@@ -291,9 +1724,11 @@ bool elegant_scope_is_valid(void) {
 
 elegant_array_t* elegant_map_int(elegant_array_t* src, int (*func)(int)) {
     if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    elegant_array_t* result = elegant_array_create(sizeof(int), len);
+    elegant_array_t* result = elegant_array_create_uninit(sizeof(int), len);
     if (!result) return NULL;
     
     int* src_data = (int*)elegant_array_get_data(src);
@@ -303,14 +1738,17 @@ elegant_array_t* elegant_map_int(elegant_array_t* src, int (*func)(int)) {
         dst_data[i] = func(src_data[i]);
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
     return result;
 }
 
 elegant_array_t* elegant_map_float(elegant_array_t* src, float (*func)(float)) {
     if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    elegant_array_t* result = elegant_array_create(sizeof(float), len);
+    elegant_array_t* result = elegant_array_create_uninit(sizeof(float), len);
     if (!result) return NULL;
     
     float* src_data = (float*)elegant_array_get_data(src);
@@ -320,14 +1758,17 @@ elegant_array_t* elegant_map_float(elegant_array_t* src, float (*func)(float)) {
         dst_data[i] = func(src_data[i]);
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
     return result;
 }
 
 elegant_array_t* elegant_map_double(elegant_array_t* src, double (*func)(double)) {
     if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    elegant_array_t* result = elegant_array_create(sizeof(double), len);
+    elegant_array_t* result = elegant_array_create_uninit(sizeof(double), len);
     if (!result) return NULL;
     
     double* src_data = (double*)elegant_array_get_data(src);
@@ -337,295 +1778,608 @@ elegant_array_t* elegant_map_double(elegant_array_t* src, double (*func)(double)
         dst_data[i] = func(src_data[i]);
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
     return result;
 }
 
 elegant_array_t* elegant_filter_int(elegant_array_t* src, int (*predicate)(int)) {
     if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     int* src_data = (int*)elegant_array_get_data(src);
     
-    // First pass: count matching elements
-    size_t count = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) count++;
-    }
-    
-    // Create result array
-    elegant_array_t* result = elegant_array_create(sizeof(int), count);
+    // Single pass into a worst-case buffer, trimmed afterwards
+    elegant_array_t* result = elegant_array_create_output(sizeof(int), len);
     if (!result) return NULL;
     
-    // Second pass: copy matching elements
     int* dst_data = (int*)elegant_array_get_data(result);
-    size_t idx = 0;
+    size_t count = 0;
     for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) {
-            dst_data[idx++] = src_data[i];
+        int value = src_data[i];
+        if (predicate(value)) {
+            dst_data[count++] = value;
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    elegant_array_finish_output(result, count);
     return result;
 }
 
 elegant_array_t* elegant_filter_float(elegant_array_t* src, int (*predicate)(float)) {
     if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     float* src_data = (float*)elegant_array_get_data(src);
     
-    // First pass: count matching elements
-    size_t count = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) count++;
-    }
-    
-    // Create result array
-    elegant_array_t* result = elegant_array_create(sizeof(float), count);
+    // Single pass into a worst-case buffer, trimmed afterwards
+    elegant_array_t* result = elegant_array_create_output(sizeof(float), len);
     if (!result) return NULL;
     
-    // Second pass: copy matching elements
     float* dst_data = (float*)elegant_array_get_data(result);
-    size_t idx = 0;
+    size_t count = 0;
     for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) {
-            dst_data[idx++] = src_data[i];
+        float value = src_data[i];
+        if (predicate(value)) {
+            dst_data[count++] = value;
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    elegant_array_finish_output(result, count);
     return result;
 }
 
 elegant_array_t* elegant_filter_double(elegant_array_t* src, int (*predicate)(double)) {
     if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     double* src_data = (double*)elegant_array_get_data(src);
     
-    // First pass: count matching elements
+    // Single pass into a worst-case buffer, trimmed afterwards
+    elegant_array_t* result = elegant_array_create_output(sizeof(double), len);
+    if (!result) return NULL;
+    
+    double* dst_data = (double*)elegant_array_get_data(result);
     size_t count = 0;
     for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) count++;
+        double value = src_data[i];
+        if (predicate(value)) {
+            dst_data[count++] = value;
+        }
     }
     
-    // Create result array
-    elegant_array_t* result = elegant_array_create(sizeof(double), count);
-    if (!result) return NULL;
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    elegant_array_finish_output(result, count);
+    return result;
+}
+
+int elegant_reduce_int(elegant_array_t* src, int (*func)(int, int), int initial) {
+    if (!src || !func) return initial;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    int* src_data = (int*)elegant_array_get_data(src);
+    
+    int accumulator = initial;
+    for (size_t i = 0; i < len; i++) {
+        accumulator = func(accumulator, src_data[i]);
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_REDUCE, len);
+    return accumulator;
+}
+
+float elegant_reduce_float(elegant_array_t* src, float (*func)(float, float), float initial) {
+    if (!src || !func) return initial;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    float* src_data = (float*)elegant_array_get_data(src);
+    
+    float accumulator = initial;
+    for (size_t i = 0; i < len; i++) {
+        accumulator = func(accumulator, src_data[i]);
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_REDUCE, len);
+    return accumulator;
+}
+
+double elegant_reduce_double(elegant_array_t* src, double (*func)(double, double), double initial) {
+    if (!src || !func) return initial;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    double* src_data = (double*)elegant_array_get_data(src);
+    
+    double accumulator = initial;
+    for (size_t i = 0; i < len; i++) {
+        accumulator = func(accumulator, src_data[i]);
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_REDUCE, len);
+    return accumulator;
+}
+
+int* elegant_find_int(elegant_array_t* src, int (*predicate)(int)) {
+    if (!src || !predicate) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    int* src_data = (int*)elegant_array_get_data(src);
+    
+    for (size_t i = 0; i < len; i++) {
+        if (predicate(src_data[i])) {
+            elegant_stats_end(&probe, ELEGANT_OP_FIND, i + 1);
+            return &src_data[i];
+        }
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_FIND, len);
+    return NULL;
+}
+
+float* elegant_find_float(elegant_array_t* src, int (*predicate)(float)) {
+    if (!src || !predicate) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    float* src_data = (float*)elegant_array_get_data(src);
+    
+    for (size_t i = 0; i < len; i++) {
+        if (predicate(src_data[i])) {
+            elegant_stats_end(&probe, ELEGANT_OP_FIND, i + 1);
+            return &src_data[i];
+        }
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_FIND, len);
+    return NULL;
+}
+
+double* elegant_find_double(elegant_array_t* src, int (*predicate)(double)) {
+    if (!src || !predicate) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    double* src_data = (double*)elegant_array_get_data(src);
     
-    // Second pass: copy matching elements
-    double* dst_data = (double*)elegant_array_get_data(result);
-    size_t idx = 0;
     for (size_t i = 0; i < len; i++) {
         if (predicate(src_data[i])) {
-            dst_data[idx++] = src_data[i];
+            elegant_stats_end(&probe, ELEGANT_OP_FIND, i + 1);
+            return &src_data[i];
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_FIND, len);
+    return NULL;
+}
+
+/*
+ * Array concatenation. Inputs become pieces of the output's byte range,
+ * which is copied in fixed-size chunks: serially for small outputs, or as
+ * one parallel block per chunk, so a few huge shards still spread across
+ * the pool.
+ */
+#define ELEGANT_CONCAT_CHUNK_BYTES ((size_t)256 * 1024)  /* one parallel block's share */
+
+typedef struct {
+    const char** sources;
+    size_t* ends;          /* output byte offset where each piece stops */
+    size_t count;
+    char* dest;
+    size_t total_bytes;
+} elegant_concat_ctx_t;
+
+static void elegant_concat_copy(const elegant_concat_ctx_t* ctx, size_t lo, size_t hi) {
+    /* First piece reaching past lo; empty pieces end where their predecessor does */
+    size_t first = 0, last = ctx->count;
+    while (first < last) {
+        size_t mid = first + (last - first) / 2;
+        if (ctx->ends[mid] <= lo) first = mid + 1; else last = mid;
+    }
+    
+    for (size_t i = first; i < ctx->count && lo < hi; i++) {
+        size_t begin = i > 0 ? ctx->ends[i - 1] : 0;
+        size_t stop = ctx->ends[i] < hi ? ctx->ends[i] : hi;
+        if (stop <= lo) continue;
+        /* The next piece is another stream; start it on its way */
+        if (i + 1 < ctx->count && ctx->sources[i + 1]) __builtin_prefetch(ctx->sources[i + 1]);
+        memcpy(ctx->dest + lo, ctx->sources[i] + (lo - begin), stop - lo);
+        lo = stop;
+    }
+}
+
+static void elegant_concat_block(void* arg, size_t block) {
+    const elegant_concat_ctx_t* ctx = arg;
+    size_t lo = block * ELEGANT_CONCAT_CHUNK_BYTES;
+    size_t hi = ctx->total_bytes - lo < ELEGANT_CONCAT_CHUNK_BYTES ? ctx->total_bytes
+                                                                   : lo + ELEGANT_CONCAT_CHUNK_BYTES;
+    elegant_concat_copy(ctx, lo, hi);
+}
+
+elegant_array_t* elegant_concat_array_list(elegant_array_t* const* arrays, size_t count) {
+    if (!arrays || count == 0 || count > SIZE_MAX / (sizeof(char*) + sizeof(size_t))) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t total_length = 0;
+    size_t element_size = 0;
+    bool invalid = false;
+    
+    for (size_t i = 0; i < count; i++) {
+        size_t len = arrays[i] ? elegant_array_get_length(arrays[i]) : 0;
+        if (len == 0) continue;
+        if (element_size == 0) element_size = arrays[i]->element_size;
+        invalid |= arrays[i]->element_size != element_size;
+        invalid |= __builtin_add_overflow(total_length, len, &total_length);
+    }
+    if (invalid || total_length == 0) return NULL;
+    
+    size_t list_bytes = count * (sizeof(char*) + sizeof(size_t));
+    void* list = elegant_alloc_from(elegant_current_allocator, list_bytes, false);
+    if (!list) return NULL;
+    
+    elegant_concat_ctx_t ctx = { (const char**)list, (size_t*)((const char**)list + count), count, NULL, 0 };
+    elegant_array_t* result = NULL;
+    
+    for (size_t i = 0; i < count; i++) {
+        size_t len = arrays[i] ? elegant_array_get_length(arrays[i]) : 0;
+        ctx.sources[i] = len > 0 ? (const char*)elegant_array_get_data(arrays[i]) : NULL;
+        if (len > 0 && !ctx.sources[i]) goto done;
+        ctx.total_bytes += len * element_size;
+        ctx.ends[i] = ctx.total_bytes;
+    }
+    
+    result = elegant_array_create_uninit(element_size, total_length);
+    if (!result) goto done;
+    ctx.dest = (char*)elegant_array_get_data(result);
+    
+    size_t chunks = (ctx.total_bytes + ELEGANT_CONCAT_CHUNK_BYTES - 1) / ELEGANT_CONCAT_CHUNK_BYTES;
+    if (ctx.total_bytes < ELEGANT_CONCAT_PARALLEL_MIN ||
+        elegant_parallel_for(chunks, elegant_concat_block, &ctx) != 0) {
+        elegant_concat_copy(&ctx, 0, ctx.total_bytes);
+    }
+    
+done:
+    elegant_free_from(elegant_current_allocator, list, list_bytes);
+    if (result) elegant_stats_end(&probe, ELEGANT_OP_CONCAT, total_length);
+    return result;
+}
+
+elegant_array_t* elegant_concat_arrays(size_t count, ...) {
+    if (count == 0 || count > SIZE_MAX / sizeof(elegant_array_t*)) return NULL;
+    
+    size_t list_bytes = count * sizeof(elegant_array_t*);
+    elegant_array_t** arrays = elegant_alloc_from(elegant_current_allocator, list_bytes, false);
+    if (!arrays) return NULL;
+    
+    va_list args;
+    va_start(args, count);
+    for (size_t i = 0; i < count; i++) {
+        arrays[i] = va_arg(args, elegant_array_t*);
+    }
+    va_end(args);
+    
+    elegant_array_t* result = elegant_concat_array_list(arrays, count);
+    elegant_free_from(elegant_current_allocator, arrays, list_bytes);
+    return result;
+}
+
+/* Generic collection operations */
+
+/*
+ * Element copies in the generic paths: with a constant size, memcpy compiles
+ * to a single load/store, so common element sizes get their own loop
+ */
+#define ELEGANT_GENERIC_SIZE_CASES(LOOP) \
+    case 1: LOOP(1); break; \
+    case 2: LOOP(2); break; \
+    case 4: LOOP(4); break; \
+    case 8: LOOP(8); break; \
+    case 16: LOOP(16); break; \
+    default: LOOP(element_size); break
+
+elegant_array_t* elegant_map_generic(elegant_array_t* src, void* (*func)(void*), size_t element_size) {
+    if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    elegant_array_t* result = elegant_array_create_uninit(element_size, len);
+    if (!result) return NULL;
+    
+    char* src_data = (char*)elegant_array_get_data(src);
+    char* dst_data = (char*)elegant_array_get_data(result);
+    
+#define ELEGANT_MAP_LOOP(size) \
+    for (size_t i = 0; i < len; i++) { \
+        void* mapped = func(src_data + i * (size)); \
+        if (!mapped) goto fail; \
+        memcpy(dst_data + i * (size), mapped, (size)); \
+    }
+    
+    switch (element_size) {
+        ELEGANT_GENERIC_SIZE_CASES(ELEGANT_MAP_LOOP);
+    }
+#undef ELEGANT_MAP_LOOP
+    
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
+    return result;
+    
+fail:
+    elegant_array_destroy(result);
+    return NULL;
+}
+
+elegant_array_t* elegant_map_into_generic(elegant_array_t* src, void (*func)(void* out, void* in),
+                                          size_t src_element_size, size_t dst_element_size) {
+    if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    elegant_array_t* result = elegant_array_create_uninit(dst_element_size, len);
+    if (!result) return NULL;
+    
+    char* src_data = (char*)elegant_array_get_data(src);
+    char* dst_data = (char*)elegant_array_get_data(result);
+    
+    for (size_t i = 0; i < len; i++) {
+        func(dst_data + i * dst_element_size, src_data + i * src_element_size);
+    }
+    
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
     return result;
 }
 
-int elegant_reduce_int(elegant_array_t* src, int (*func)(int, int), int initial) {
-    if (!src || !func) return initial;
+elegant_array_t* elegant_filter_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
+    if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    int* src_data = (int*)elegant_array_get_data(src);
+    char* src_data = (char*)elegant_array_get_data(src);
     
-    int accumulator = initial;
-    for (size_t i = 0; i < len; i++) {
-        accumulator = func(accumulator, src_data[i]);
+    // Single pass into a worst-case buffer, trimmed afterwards
+    elegant_array_t* result = elegant_array_create_output(element_size, len);
+    if (!result) return NULL;
+    
+    char* dst_data = (char*)elegant_array_get_data(result);
+    size_t count = 0;
+    
+#define ELEGANT_FILTER_LOOP(size) \
+    for (size_t i = 0; i < len; i++) { \
+        char* element = src_data + i * (size); \
+        if (predicate(element)) { \
+            memcpy(dst_data + count * (size), element, (size)); \
+            count++; \
+        } \
     }
     
-    return accumulator;
+    switch (element_size) {
+        ELEGANT_GENERIC_SIZE_CASES(ELEGANT_FILTER_LOOP);
+    }
+#undef ELEGANT_FILTER_LOOP
+    
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    elegant_array_finish_output(result, count);
+    return result;
 }
 
-float elegant_reduce_float(elegant_array_t* src, float (*func)(float, float), float initial) {
-    if (!src || !func) return initial;
-    
-    size_t len = elegant_array_get_length(src);
-    float* src_data = (float*)elegant_array_get_data(src);
+/*
+ * Caller-provided destinations: results are written into dst's existing
+ * storage and its length set, so a warm destination never allocates. dst
+ * may be the source itself; the source is read after dst is made writable.
+ */
+static int elegant_array_prepare_into(elegant_array_t* dst, size_t element_size, size_t length, char** data) {
+    if (!dst || dst->element_size != element_size) return EINVAL;
     
-    float accumulator = initial;
-    for (size_t i = 0; i < len; i++) {
-        accumulator = func(accumulator, src_data[i]);
-    }
+    int err = elegant_array_make_growable(dst);
+    if (err) return err;
+    if (dst->capacity < length) return ENOSPC;
     
-    return accumulator;
+    *data = dst->capacity > 0 ? (char*)elegant_array_get_mutable_data(dst) : NULL;
+    if (dst->capacity > 0 && !*data) return ENOMEM;
+    return 0;
 }
 
-double elegant_reduce_double(elegant_array_t* src, double (*func)(double, double), double initial) {
-    if (!src || !func) return initial;
+int elegant_map_into_array(elegant_array_t* dst, elegant_array_t* src, void (*func)(void* out, void* in),
+                           size_t src_element_size, size_t dst_element_size) {
+    if (!src || !func || src->element_size != src_element_size) return EINVAL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    double* src_data = (double*)elegant_array_get_data(src);
+    char* dst_data;
+    int err = elegant_array_prepare_into(dst, dst_element_size, len, &dst_data);
+    if (err) return err;
+    
+    char* src_data = (char*)elegant_array_get_data(src);
+    if (len > 0 && !src_data) return ENOMEM;
     
-    double accumulator = initial;
     for (size_t i = 0; i < len; i++) {
-        accumulator = func(accumulator, src_data[i]);
+        func(dst_data + i * dst_element_size, src_data + i * src_element_size);
     }
+    dst->length = len;
     
-    return accumulator;
+    elegant_stats_end(&probe, ELEGANT_OP_MAP, len);
+    return 0;
 }
 
-int* elegant_find_int(elegant_array_t* src, int (*predicate)(int)) {
-    if (!src || !predicate) return NULL;
+int elegant_filter_into_array(elegant_array_t* dst, elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
+    if (!src || !predicate || src->element_size != element_size) return EINVAL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
+    /* Room for every element, since the count is only known afterwards */
     size_t len = elegant_array_get_length(src);
-    int* src_data = (int*)elegant_array_get_data(src);
+    char* dst_data;
+    int err = elegant_array_prepare_into(dst, element_size, len, &dst_data);
+    if (err) return err;
     
-    for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) {
-            return &src_data[i];
-        }
+    char* src_data = (char*)elegant_array_get_data(src);
+    if (len > 0 && !src_data) return ENOMEM;
+    size_t count = 0;
+    
+    /* memmove: compacting in place copies an element onto itself */
+#define ELEGANT_FILTER_INTO_LOOP(size) \
+    for (size_t i = 0; i < len; i++) { \
+        char* element = src_data + i * (size); \
+        if (predicate(element)) { \
+            memmove(dst_data + count * (size), element, (size)); \
+            count++; \
+        } \
     }
     
-    return NULL;
+    switch (element_size) {
+        ELEGANT_GENERIC_SIZE_CASES(ELEGANT_FILTER_INTO_LOOP);
+    }
+#undef ELEGANT_FILTER_INTO_LOOP
+    dst->length = count;
+    
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    return 0;
 }
 
-float* elegant_find_float(elegant_array_t* src, int (*predicate)(float)) {
+/* Selection outputs: record which elements pass instead of copying them */
+
+elegant_array_t* elegant_filter_select_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
     if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    float* src_data = (float*)elegant_array_get_data(src);
+    char* src_data = (char*)elegant_array_get_data(src);
+    
+    elegant_array_t* result = elegant_array_create_output(sizeof(size_t), len);
+    if (!result) return NULL;
     
+    size_t* indices = (size_t*)elegant_array_get_data(result);
+    size_t count = 0;
     for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) {
-            return &src_data[i];
-        }
+        indices[count] = i;
+        count += predicate(src_data + i * element_size) != 0;
     }
     
-    return NULL;
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    elegant_array_finish_output(result, count);
+    return result;
 }
 
-double* elegant_find_double(elegant_array_t* src, int (*predicate)(double)) {
+elegant_array_t* elegant_filter_bitmap_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
     if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    double* src_data = (double*)elegant_array_get_data(src);
+    char* src_data = (char*)elegant_array_get_data(src);
     
-    for (size_t i = 0; i < len; i++) {
-        if (predicate(src_data[i])) {
-            return &src_data[i];
+    elegant_array_t* result = elegant_array_create_uninit(sizeof(uint64_t), ELEGANT_BITMAP_WORDS(len));
+    if (!result) return NULL;
+    
+    uint64_t* words = (uint64_t*)elegant_array_get_data(result);
+    for (size_t w = 0; w * 64 < len; w++) {
+        size_t end = (w + 1) * 64 < len ? (w + 1) * 64 : len;
+        uint64_t bits = 0;
+        for (size_t i = w * 64; i < end; i++) {
+            bits |= (uint64_t)(predicate(src_data + i * element_size) != 0) << (i % 64);
         }
+        words[w] = bits;
     }
     
-    return NULL;
+    elegant_stats_end(&probe, ELEGANT_OP_FILTER, len);
+    return result;
 }
 
-/* Array concatenation */
-elegant_array_t* elegant_concat_arrays(size_t count, ...) {
-    if (count == 0) return NULL;
-    
-    va_list args;
-    va_start(args, count);
+elegant_array_t* elegant_array_gather(elegant_array_t* src, elegant_array_t* selection) {
+    if (!src || !selection || selection->element_size != sizeof(size_t)) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
-    // First pass: calculate total length and get element size
-    size_t total_length = 0;
-    size_t element_size = 0;
-    elegant_array_t* arrays[count];
+    size_t len = elegant_array_get_length(src);
+    size_t count = elegant_array_get_length(selection);
+    size_t element_size = src->element_size;
+    const size_t* indices = (const size_t*)elegant_array_get_data(selection);
+    char* src_data = (char*)elegant_array_get_data(src);
     
     for (size_t i = 0; i < count; i++) {
-        arrays[i] = va_arg(args, elegant_array_t*);
-        if (arrays[i]) {
-            size_t len = elegant_array_get_length(arrays[i]);
-            total_length += len;
-            if (element_size == 0) {
-                element_size = arrays[i]->element_size;
-            }
+        if (indices[i] >= len) {
+            fprintf(stderr, "Elegant: Gather index %zu out of bounds (length %zu)\n", indices[i], len);
+            return NULL;
         }
     }
-    va_end(args);
-    
-    if (total_length == 0 || element_size == 0) return NULL;
     
-    // Create result array
-    elegant_array_t* result = elegant_create_array_impl(element_size, NULL, total_length);
+    elegant_array_t* result = elegant_array_create_uninit(element_size, count);
     if (!result) return NULL;
     
-    // Second pass: copy data
-    char* dest_data = (char*)elegant_array_get_data(result);
-    size_t offset = 0;
+    char* dst_data = (char*)elegant_array_get_data(result);
     
-    for (size_t i = 0; i < count; i++) {
-        if (arrays[i]) {
-            size_t len = elegant_array_get_length(arrays[i]);
-            if (len > 0) {
-                char* src_data = (char*)elegant_array_get_data(arrays[i]);
-                size_t copy_bytes = len * element_size;
-                size_t remaining_bytes = (total_length * element_size) - offset;
-                
-                if (elegant_memcpy_safe(dest_data + offset, remaining_bytes, 
-                                      src_data, copy_bytes) != 0) {
-                    elegant_array_destroy(result);
-                    return NULL;
-                }
-                offset += copy_bytes;
-            }
-        }
+#define ELEGANT_GATHER_LOOP(size) \
+    for (size_t i = 0; i < count; i++) { \
+        memcpy(dst_data + i * (size), src_data + indices[i] * (size), (size)); \
     }
     
-    return result;
-}
-
-/* Generic collection operations */
-
-elegant_array_t* elegant_map_generic(elegant_array_t* src, void* (*func)(void*), size_t element_size) {
-    if (!src || !func) return NULL;
-    
-    size_t len = elegant_array_get_length(src);
-    elegant_array_t* result = elegant_array_create(element_size, len);
-    if (!result) return NULL;
-    
-    char* src_data = (char*)elegant_array_get_data(src);
-    char* dst_data = (char*)elegant_array_get_data(result);
-    
-    for (size_t i = 0; i < len; i++) {
-        void* element = src_data + (i * element_size);
-        void* mapped = func(element);
-        if (elegant_memcpy_safe(dst_data + (i * element_size), element_size, mapped, element_size) != 0) {
-            elegant_array_destroy(result);
-            return NULL;
-        }
+    switch (element_size) {
+        ELEGANT_GENERIC_SIZE_CASES(ELEGANT_GATHER_LOOP);
     }
+#undef ELEGANT_GATHER_LOOP
     
+    elegant_stats_end(&probe, ELEGANT_OP_GATHER, count);
     return result;
 }
 
-elegant_array_t* elegant_filter_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
-    if (!src || !predicate) return NULL;
+elegant_array_t* elegant_array_compress(elegant_array_t* src, elegant_array_t* bitmap) {
+    if (!src || !bitmap || bitmap->element_size != sizeof(uint64_t)) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
-    char* src_data = (char*)elegant_array_get_data(src);
+    size_t words = ELEGANT_BITMAP_WORDS(len);
+    if (elegant_array_get_length(bitmap) < words) return NULL;
     
-    // First pass: count matching elements
+    const uint64_t* bits = (const uint64_t*)elegant_array_get_data(bitmap);
     size_t count = 0;
-    for (size_t i = 0; i < len; i++) {
-        void* element = src_data + (i * element_size);
-        if (predicate(element)) count++;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t word = bits[w];
+        if ((w + 1) * 64 > len) word &= ((uint64_t)1 << (len % 64)) - 1;
+        count += (size_t)__builtin_popcountll(word);
     }
     
-    // Create result array
-    elegant_array_t* result = elegant_array_create(element_size, count);
+    elegant_array_t* result = elegant_array_create_uninit(src->element_size, count);
     if (!result) return NULL;
     
-    // Second pass: copy matching elements
-    char* dst_data = (char*)elegant_array_get_data(result);
-    size_t idx = 0;
-    for (size_t i = 0; i < len; i++) {
-        void* element = src_data + (i * element_size);
-        if (predicate(element)) {
-            if (elegant_memcpy_safe(dst_data + (idx * element_size), element_size, element, element_size) != 0) {
-                elegant_array_destroy(result);
-                return NULL;
-            }
-            idx++;
+    size_t element_size = src->element_size;
+    char* src_data = (char*)elegant_array_get_data(src);
+    char* out = (char*)elegant_array_get_data(result);
+    
+    /* Visit set bits only, lowest first */
+    for (size_t w = 0; w < words; w++) {
+        uint64_t word = bits[w];
+        while (word) {
+            size_t i = w * 64 + (size_t)__builtin_ctzll(word);
+            if (i >= len) break;
+            memcpy(out, src_data + i * element_size, element_size);
+            out += element_size;
+            word &= word - 1;
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_GATHER, len);
     return result;
 }
 
 void* elegant_reduce_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size) {
     if (!src || !func || !initial) return initial;
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     char* src_data = (char*)elegant_array_get_data(src);
@@ -647,6 +2401,7 @@ void* elegant_reduce_generic(elegant_array_t* src, void* (*func)(void*, void*),
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_REDUCE, len);
     return accumulator;
 }
 
@@ -656,6 +2411,7 @@ void* elegant_fold_left_generic(elegant_array_t* src, void* (*func)(void*, void*
 
 void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size) {
     if (!src || !func || !initial) return initial;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     char* src_data = (char*)elegant_array_get_data(src);
@@ -678,11 +2434,13 @@ void* elegant_fold_right_generic(elegant_array_t* src, void* (*func)(void*, void
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_FOLD, len);
     return accumulator;
 }
 
 void* elegant_find_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
     if (!src || !predicate) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(src);
     char* src_data = (char*)elegant_array_get_data(src);
@@ -690,95 +2448,64 @@ void* elegant_find_generic(elegant_array_t* src, int (*predicate)(void*), size_t
     for (size_t i = 0; i < len; i++) {
         void* element = src_data + (i * element_size);
         if (predicate(element)) {
+            elegant_stats_end(&probe, ELEGANT_OP_FIND, i + 1);
             return element;
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_FIND, len);
     return NULL;
 }
 
+/* A reversed copy: everything that reads a view expects its elements in order */
 elegant_array_t* elegant_reverse(elegant_array_t* arr) {
     if (!arr) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len = elegant_array_get_length(arr);
     size_t element_size = arr->element_size;
-    elegant_array_t* result = elegant_array_create(element_size, len);
+    const char* src_data = (const char*)elegant_array_get_data(arr);
+    
+    elegant_array_t* result = elegant_array_create_uninit(element_size, len);
     if (!result) return NULL;
     
-    char* src_data = (char*)elegant_array_get_data(arr);
     char* dst_data = (char*)elegant_array_get_data(result);
     
-    for (size_t i = 0; i < len; i++) {
-        void* src_element = src_data + (i * element_size);
-        void* dst_element = dst_data + ((len - 1 - i) * element_size);
-        if (elegant_memcpy_safe(dst_element, element_size, src_element, element_size) != 0) {
-            elegant_array_destroy(result);
-            return NULL;
-        }
+#define ELEGANT_REVERSE_LOOP(size) \
+    for (size_t i = 0; i < len; i++) { \
+        memcpy(dst_data + i * (size), src_data + (len - 1 - i) * (size), (size)); \
+    }
+    
+    switch (element_size) {
+        ELEGANT_GENERIC_SIZE_CASES(ELEGANT_REVERSE_LOOP);
     }
+#undef ELEGANT_REVERSE_LOOP
     
+    elegant_stats_end(&probe, ELEGANT_OP_REVERSE, len);
     return result;
 }
 
 elegant_array_t* elegant_take(elegant_array_t* arr, size_t n) {
     if (!arr) return NULL;
     
-    size_t len = elegant_array_get_length(arr);
-    size_t take_len = (n < len) ? n : len;
-    size_t element_size = arr->element_size;
-    
-    elegant_array_t* result = elegant_array_create(element_size, take_len);
-    if (!result) return NULL;
-    
-    if (take_len > 0) {
-        char* src_data = (char*)elegant_array_get_data(arr);
-        char* dst_data = (char*)elegant_array_get_data(result);
-        size_t copy_bytes = take_len * element_size;
-        
-        if (elegant_memcpy_safe(dst_data, copy_bytes, src_data, copy_bytes) != 0) {
-            elegant_array_destroy(result);
-            return NULL;
-        }
-    }
-    
-    return result;
+    return elegant_array_view_op(arr, 0, n, ELEGANT_OP_TAKE);
 }
 
 elegant_array_t* elegant_drop(elegant_array_t* arr, size_t n) {
     if (!arr) return NULL;
     
-    size_t len = elegant_array_get_length(arr);
-    if (n >= len) {
-        return elegant_array_create(arr->element_size, 0);
-    }
-    
-    size_t drop_len = len - n;
-    size_t element_size = arr->element_size;
-    
-    elegant_array_t* result = elegant_array_create(element_size, drop_len);
-    if (!result) return NULL;
-    
-    char* src_data = (char*)elegant_array_get_data(arr);
-    char* dst_data = (char*)elegant_array_get_data(result);
-    char* src_start = src_data + (n * element_size);
-    size_t copy_bytes = drop_len * element_size;
-    
-    if (elegant_memcpy_safe(dst_data, copy_bytes, src_start, copy_bytes) != 0) {
-        elegant_array_destroy(result);
-        return NULL;
-    }
-    
-    return result;
+    return elegant_array_view_op(arr, n, SIZE_MAX, ELEGANT_OP_DROP);
 }
 
 elegant_array_t* elegant_zip(elegant_array_t* arr1, elegant_array_t* arr2, void* (*combiner)(void*, void*), size_t result_element_size) {
     if (!arr1 || !arr2 || !combiner) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
     
     size_t len1 = elegant_array_get_length(arr1);
     size_t len2 = elegant_array_get_length(arr2);
     size_t min_len = (len1 < len2) ? len1 : len2;
     
-    elegant_array_t* result = elegant_array_create(result_element_size, min_len);
+    elegant_array_t* result = elegant_array_create_uninit(result_element_size, min_len);
     if (!result) return NULL;
     
     char* data1 = (char*)elegant_array_get_data(arr1);
@@ -796,68 +2523,345 @@ elegant_array_t* elegant_zip(elegant_array_t* arr1, elegant_array_t* arr2, void*
         }
     }
     
+    elegant_stats_end(&probe, ELEGANT_OP_ZIP, min_len);
     return result;
 }
 
+int elegant_zip_into_array(elegant_array_t* dst, elegant_array_t* arr1, elegant_array_t* arr2,
+                           void* (*combiner)(void*, void*), size_t result_element_size) {
+    if (!arr1 || !arr2 || !combiner) return EINVAL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len1 = elegant_array_get_length(arr1);
+    size_t len2 = elegant_array_get_length(arr2);
+    size_t min_len = (len1 < len2) ? len1 : len2;
+    
+    char* result_data;
+    int err = elegant_array_prepare_into(dst, result_element_size, min_len, &result_data);
+    if (err) return err;
+    
+    char* data1 = (char*)elegant_array_get_data(arr1);
+    char* data2 = (char*)elegant_array_get_data(arr2);
+    if (min_len > 0 && (!data1 || !data2)) return ENOMEM;
+    
+    for (size_t i = 0; i < min_len; i++) {
+        void* combined = combiner(data1 + i * arr1->element_size, data2 + i * arr2->element_size);
+        memmove(result_data + i * result_element_size, combined, result_element_size);
+    }
+    dst->length = min_len;
+    
+    elegant_stats_end(&probe, ELEGANT_OP_ZIP, min_len);
+    return 0;
+}
+
+/*
+ * Batched zips: the callback sees a tile of consecutive elements from
+ * every input and output at once, sized so that the tile's rows fit in
+ * about half an L1 cache together, and loops over it with typed pointers.
+ */
+#define ELEGANT_ZIP_MIN_TILE 16
 
-/* Advanced array operations */
+static void elegant_zip_tiles(char* const* out, const size_t* out_sizes, size_t n_out,
+                              char* const* in, const size_t* in_sizes, size_t n_in,
+                              size_t len, elegant_zip_batch_t batch) {
+    size_t row_bytes = 0;
+    for (size_t k = 0; k < n_out; k++) row_bytes += out_sizes[k];
+    for (size_t k = 0; k < n_in; k++) row_bytes += in_sizes[k];
+    size_t tile = row_bytes > 0 ? ELEGANT_ZIP_TILE_BYTES / row_bytes : len;
+    if (tile < ELEGANT_ZIP_MIN_TILE) tile = ELEGANT_ZIP_MIN_TILE;
+    
+    void* out_tile[ELEGANT_ZIP_MAX_ARRAYS];
+    const void* in_tile[ELEGANT_ZIP_MAX_ARRAYS];
+    for (size_t start = 0; start < len; start += tile) {
+        size_t count = len - start < tile ? len - start : tile;
+        for (size_t k = 0; k < n_out; k++) out_tile[k] = out[k] + start * out_sizes[k];
+        for (size_t k = 0; k < n_in; k++) in_tile[k] = in[k] + start * in_sizes[k];
+        batch(out_tile, in_tile, count);
+    }
+}
 
-elegant_array_t* elegant_reverse_int(elegant_array_t* arr) {
-    if (!arr) return NULL;
+/* Sizes of the inputs and the length they share; EINVAL on a size mismatch */
+static int elegant_zip_check(elegant_array_t* const* inputs, const size_t* element_sizes, size_t count,
+                             size_t* sizes, size_t* length) {
+    if (!inputs || count == 0 || count > ELEGANT_ZIP_MAX_ARRAYS) return EINVAL;
+    
+    size_t len = SIZE_MAX;
+    for (size_t k = 0; k < count; k++) {
+        if (!inputs[k]) return EINVAL;
+        sizes[k] = inputs[k]->element_size;
+        if (element_sizes && element_sizes[k] != sizes[k]) return EINVAL;
+        size_t n = elegant_array_get_length(inputs[k]);
+        if (n < len) len = n;
+    }
+    *length = len;
+    return 0;
+}
+
+static int elegant_zip_fetch(elegant_array_t* const* inputs, size_t count, size_t len, char** data) {
+    for (size_t k = 0; k < count; k++) {
+        data[k] = len > 0 ? (char*)elegant_array_get_data(inputs[k]) : NULL;
+        if (len > 0 && !data[k]) return ENOMEM;
+    }
+    return 0;
+}
+
+elegant_array_t* elegant_zip_batch(elegant_array_t* const* inputs, const size_t* element_sizes, size_t count,
+                                   elegant_zip_batch_t batch, size_t result_element_size) {
+    if (!batch || result_element_size == 0) return NULL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    char* in[ELEGANT_ZIP_MAX_ARRAYS];
+    size_t in_sizes[ELEGANT_ZIP_MAX_ARRAYS];
+    size_t len;
+    if (elegant_zip_check(inputs, element_sizes, count, in_sizes, &len) != 0 ||
+        elegant_zip_fetch(inputs, count, len, in) != 0) {
+        return NULL;
+    }
     
-    size_t len = elegant_array_get_length(arr);
-    elegant_array_t* result = elegant_array_create(sizeof(int), len);
+    elegant_array_t* result = elegant_array_create_uninit(result_element_size, len);
     if (!result) return NULL;
     
-    int* src_data = (int*)elegant_array_get_data(arr);
-    int* dst_data = (int*)elegant_array_get_data(result);
+    char* out = (char*)elegant_array_get_data(result);
+    elegant_zip_tiles(&out, &result_element_size, 1, in, in_sizes, count, len, batch);
     
-    for (size_t i = 0; i < len; i++) {
-        dst_data[i] = src_data[len - 1 - i];
+    elegant_stats_end(&probe, ELEGANT_OP_ZIP, len);
+    return result;
+}
+
+int elegant_zip_batch_into(elegant_array_t* dst, elegant_array_t* const* inputs, const size_t* element_sizes,
+                           size_t count, elegant_zip_batch_t batch, size_t result_element_size) {
+    if (!batch) return EINVAL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    char* in[ELEGANT_ZIP_MAX_ARRAYS];
+    size_t in_sizes[ELEGANT_ZIP_MAX_ARRAYS];
+    size_t len;
+    int err = elegant_zip_check(inputs, element_sizes, count, in_sizes, &len);
+    if (err) return err;
+    
+    /* dst first: it may be one of the inputs, and preparing it can move its data */
+    char* out;
+    err = elegant_array_prepare_into(dst, result_element_size, len, &out);
+    if (!err) err = elegant_zip_fetch(inputs, count, len, in);
+    if (err) return err;
+    
+    elegant_zip_tiles(&out, &result_element_size, 1, in, in_sizes, count, len, batch);
+    dst->length = len;
+    
+    elegant_stats_end(&probe, ELEGANT_OP_ZIP, len);
+    return 0;
+}
+
+int elegant_unzip_batch(elegant_array_t* src, size_t element_size, elegant_array_t** outputs,
+                        const size_t* output_sizes, size_t count, elegant_zip_batch_t batch) {
+    if (!outputs || !output_sizes || count == 0 || count > ELEGANT_ZIP_MAX_ARRAYS) return EINVAL;
+    for (size_t k = 0; k < count; k++) outputs[k] = NULL;
+    if (!src || !batch || src->element_size != element_size) return EINVAL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+    
+    size_t len = elegant_array_get_length(src);
+    char* in = len > 0 ? (char*)elegant_array_get_data(src) : NULL;
+    if (len > 0 && !in) return ENOMEM;
+    
+    char* out[ELEGANT_ZIP_MAX_ARRAYS];
+    for (size_t k = 0; k < count; k++) {
+        outputs[k] = elegant_array_create_uninit(output_sizes[k], len);
+        if (!outputs[k]) {
+            while (k > 0) {
+                elegant_array_t* made = outputs[--k];
+                if (!(made->flags & ELEGANT_ARRAY_SCOPED)) elegant_array_destroy(made);
+                outputs[k] = NULL;
+            }
+            return ENOMEM;
+        }
+        out[k] = (char*)elegant_array_get_data(outputs[k]);
     }
     
-    return result;
+    elegant_zip_tiles(out, output_sizes, count, &in, &element_size, 1, len, batch);
+    
+    elegant_stats_end(&probe, ELEGANT_OP_ZIP, len);
+    return 0;
+}
+
+
+/* Advanced array operations */
+
+elegant_array_t* elegant_reverse_int(elegant_array_t* arr) {
+    return elegant_reverse(arr);
 }
 
 elegant_array_t* elegant_take_int(elegant_array_t* arr, size_t n) {
-    if (!arr) return NULL;
+    return elegant_take(arr, n);
+}
+
+elegant_array_t* elegant_drop_int(elegant_array_t* arr, size_t n) {
+    return elegant_drop(arr, n);
+}
+
+/* Fused chain pipeline */
+
+/* Upper bound on the number of elements a chain can emit for a given input */
+static size_t elegant_chain_bound(size_t len, const chain_operation_t* ops, size_t count) {
+    size_t bound = len;
+    for (size_t k = 0; k < count; k++) {
+        size_t n = ops[k].op.take_drop.n;
+        if (ops[k].type == CHAIN_DROP) {
+            bound = (n < bound) ? bound - n : 0;
+        } else if (ops[k].type == CHAIN_TAKE && n < bound) {
+            bound = n;
+        }
+    }
+    return bound;
+}
+
+static bool elegant_chain_validate(const chain_operation_t* ops, size_t count) {
+    if (count && !ops) return false;
+    for (size_t k = 0; k < count; k++) {
+        switch (ops[k].type) {
+            case CHAIN_MAP:
+                if (!ops[k].op.map.func) return false;
+                break;
+            case CHAIN_FILTER:
+                if (!ops[k].op.filter.predicate) return false;
+                break;
+            case CHAIN_TAKE:
+            case CHAIN_DROP:
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Push one element through every stage. Returns true if it reaches the end
+ * of the chain; sets *exhausted once a TAKE stage can admit no more input.
+ */
+static inline bool elegant_chain_apply(const chain_operation_t* ops, size_t count,
+                                       size_t* seen, int* value, bool* exhausted) {
+    int x = *value;
+    for (size_t k = 0; k < count; k++) {
+        const chain_operation_t* op = &ops[k];
+        switch (op->type) {
+            case CHAIN_MAP:
+                x = op->op.map.func(x);
+                break;
+            case CHAIN_FILTER:
+                if (!op->op.filter.predicate(x)) return false;
+                break;
+            case CHAIN_DROP:
+                if (seen[k] < op->op.take_drop.n) {
+                    seen[k]++;
+                    return false;
+                }
+                break;
+            case CHAIN_TAKE:
+                if (seen[k] >= op->op.take_drop.n) {
+                    *exhausted = true;
+                    return false;
+                }
+                if (++seen[k] == op->op.take_drop.n) {
+                    *exhausted = true;
+                }
+                break;
+        }
+    }
+    *value = x;
+    return true;
+}
+
+/* Collect NULL-terminated chain_operation_t* varargs into a contiguous descriptor */
+static size_t elegant_chain_collect(va_list args, chain_operation_t* ops) {
+    size_t count = 0;
+    const chain_operation_t* op;
+    while ((op = va_arg(args, const chain_operation_t*)) != NULL) {
+        if (count >= ELEGANT_CHAIN_MAX_OPS) {
+            fprintf(stderr, "Elegant: Chain exceeds maximum of %d operations\n",
+                    ELEGANT_CHAIN_MAX_OPS);
+            return SIZE_MAX;
+        }
+        ops[count++] = *op;
+    }
+    return count;
+}
+
+elegant_array_t* elegant_chain_run(elegant_array_t* arr, const chain_operation_t* ops, size_t count) {
+    if (!arr || !elegant_chain_validate(ops, count)) return NULL;
+    if (count > ELEGANT_CHAIN_MAX_OPS) return NULL;
     
+    elegant_op_probe_t probe = elegant_stats_begin();
     size_t len = elegant_array_get_length(arr);
-    size_t take_len = (n < len) ? n : len;
+    size_t bound = elegant_chain_bound(len, ops, count);
     
-    elegant_array_t* result = elegant_array_create(sizeof(int), take_len);
+    elegant_array_t* result = elegant_array_create_output(sizeof(int), bound);
     if (!result) return NULL;
     
-    if (take_len > 0) {
-        int* src_data = (int*)elegant_array_get_data(arr);
-        int* dst_data = (int*)elegant_array_get_data(result);
-        
-        for (size_t i = 0; i < take_len; i++) {
-            dst_data[i] = src_data[i];
+    int* src_data = (int*)elegant_array_get_data(arr);
+    int* dst_data = (int*)elegant_array_get_data(result);
+    size_t seen[ELEGANT_CHAIN_MAX_OPS] = {0};
+    bool exhausted = (bound == 0);
+    size_t produced = 0;
+    size_t i = 0;
+    
+    for (; i < len && !exhausted; i++) {
+        int x = src_data[i];
+        if (elegant_chain_apply(ops, count, seen, &x, &exhausted)) {
+            dst_data[produced++] = x;
         }
     }
     
+    /* Counts the elements read, which an exhausted TAKE cuts short */
+    elegant_stats_end(&probe, ELEGANT_OP_CHAIN, i);
+    /* The output was sized for the worst case; trim it to what was produced */
+    elegant_array_finish_output(result, produced);
     return result;
 }
 
-elegant_array_t* elegant_drop_int(elegant_array_t* arr, size_t n) {
-    if (!arr) return NULL;
+int elegant_chain_reduce_run(elegant_array_t* arr, const chain_operation_t* ops, size_t count,
+                             int (*func)(int, int), int initial) {
+    if (!arr || !func || !elegant_chain_validate(ops, count)) return initial;
+    if (count > ELEGANT_CHAIN_MAX_OPS) return initial;
     
+    elegant_op_probe_t probe = elegant_stats_begin();
     size_t len = elegant_array_get_length(arr);
-    if (n >= len) {
-        return elegant_array_create(sizeof(int), 0);
+    int* src_data = (int*)elegant_array_get_data(arr);
+    size_t seen[ELEGANT_CHAIN_MAX_OPS] = {0};
+    bool exhausted = (elegant_chain_bound(len, ops, count) == 0);
+    int accumulator = initial;
+    size_t i = 0;
+    
+    for (; i < len && !exhausted; i++) {
+        int x = src_data[i];
+        if (elegant_chain_apply(ops, count, seen, &x, &exhausted)) {
+            accumulator = func(accumulator, x);
+        }
     }
     
-    size_t drop_len = len - n;
-    elegant_array_t* result = elegant_array_create(sizeof(int), drop_len);
-    if (!result) return NULL;
+    elegant_stats_end(&probe, ELEGANT_OP_CHAIN, i);
+    return accumulator;
+}
+
+elegant_array_t* elegant_chain_operations(elegant_array_t* arr, ...) {
+    chain_operation_t ops[ELEGANT_CHAIN_MAX_OPS];
     
-    int* src_data = (int*)elegant_array_get_data(arr);
-    int* dst_data = (int*)elegant_array_get_data(result);
+    va_list args;
+    va_start(args, arr);
+    size_t count = elegant_chain_collect(args, ops);
+    va_end(args);
     
-    for (size_t i = 0; i < drop_len; i++) {
-        dst_data[i] = src_data[n + i];
-    }
+    if (count == SIZE_MAX) return NULL;
+    return elegant_chain_run(arr, ops, count);
+}
+
+int elegant_chain_reduce_int(elegant_array_t* arr, int (*func)(int, int), int initial, ...) {
+    chain_operation_t ops[ELEGANT_CHAIN_MAX_OPS];
     
-    return result;
+    va_list args;
+    va_start(args, initial);
+    size_t count = elegant_chain_collect(args, ops);
+    va_end(args);
+    
+    if (count == SIZE_MAX) return initial;
+    return elegant_chain_reduce_run(arr, ops, count, func, initial);
 }
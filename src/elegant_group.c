@@ -0,0 +1,494 @@
+/*
+ * Elegant - Hash Aggregation
+ * A SwissTable-style table: one control byte per slot holds EMPTY or a
+ * 7-bit tag from the top of the hash, and each slot indexes a group in the
+ * dense key/aggregate arrays. Lookups compare a whole 16-byte run of tags
+ * at once and only touch keys whose tag matches. Nothing is ever deleted,
+ * so the first EMPTY along the probe sequence ends a miss.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define ELEGANT_GROUP_WIDTH 16           /* control bytes probed together */
+#define ELEGANT_GROUP_EMPTY 0x80u
+#define ELEGANT_GROUP_MIN_CAPACITY 16
+#define ELEGANT_GROUP_PARTITION_BITS 8
+#define ELEGANT_GROUP_MIN_BLOCK 4096     /* elements per parallel block */
+#define ELEGANT_GROUP_ALIGN 16           /* of extracted values in scratch */
+
+typedef struct {
+    uint8_t* ctrl;          /* capacity + WIDTH bytes; the tail mirrors the head */
+    uint32_t* slots;        /* group index per occupied slot */
+    size_t capacity;        /* power of two */
+    size_t count;           /* groups */
+    size_t dense_capacity;
+    char* keys;
+    char* values;
+    size_t* counts;
+    uint64_t* hashes;
+    size_t* firsts;         /* element index that opened each group */
+    size_t key_size;
+    size_t value_size;
+} elegant_group_table_t;
+
+static inline uint64_t elegant_hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t elegant_hash_bytes(const void* data, size_t size) {
+    const unsigned char* p = data;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ size;
+
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        h = (h ^ elegant_hash_mix(word)) * 0x9e3779b97f4a7c15ull;
+    }
+    if (size > 0) {
+        uint64_t word = 0;
+        memcpy(&word, p, size);
+        h = (h ^ elegant_hash_mix(word)) * 0x9e3779b97f4a7c15ull;
+    }
+    return elegant_hash_mix(h);
+}
+
+/* Bit i set when ctrl[i] == byte, for one probe window */
+static inline unsigned elegant_group_match(const uint8_t* ctrl, uint8_t byte) {
+#if defined(__SSE2__)
+    __m128i window = _mm_loadu_si128((const __m128i*)ctrl);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(window, _mm_set1_epi8((char)byte)));
+#else
+    unsigned mask = 0;
+    for (unsigned i = 0; i < ELEGANT_GROUP_WIDTH; i++) mask |= (unsigned)(ctrl[i] == byte) << i;
+    return mask;
+#endif
+}
+
+static inline uint8_t elegant_group_tag(uint64_t hash) {
+    return (uint8_t)(hash >> 57);
+}
+
+static inline void elegant_group_set_ctrl(elegant_group_table_t* t, size_t slot, uint8_t tag) {
+    t->ctrl[slot] = tag;
+    if (slot < ELEGANT_GROUP_WIDTH) t->ctrl[t->capacity + slot] = tag;
+}
+
+static int elegant_group_alloc_slots(elegant_group_table_t* t, size_t capacity) {
+    uint8_t* ctrl = malloc(capacity + ELEGANT_GROUP_WIDTH);
+    uint32_t* slots = malloc(capacity * sizeof(uint32_t));
+    if (!ctrl || !slots) {
+        free(ctrl);
+        free(slots);
+        return ENOMEM;
+    }
+    memset(ctrl, ELEGANT_GROUP_EMPTY, capacity + ELEGANT_GROUP_WIDTH);
+    free(t->ctrl);
+    free(t->slots);
+    t->ctrl = ctrl;
+    t->slots = slots;
+    t->capacity = capacity;
+    return 0;
+}
+
+static void elegant_group_table_free(elegant_group_table_t* t) {
+    free(t->ctrl);
+    free(t->slots);
+    free(t->keys);
+    free(t->values);
+    free(t->counts);
+    free(t->hashes);
+    free(t->firsts);
+}
+
+static int elegant_group_table_init(elegant_group_table_t* t, size_t key_size, size_t value_size) {
+    memset(t, 0, sizeof(*t));
+    t->key_size = key_size;
+    t->value_size = value_size;
+    return elegant_group_alloc_slots(t, ELEGANT_GROUP_MIN_CAPACITY);
+}
+
+/* Slot of the first EMPTY control byte along hash's probe sequence */
+static size_t elegant_group_free_slot(const elegant_group_table_t* t, uint64_t hash) {
+    size_t mask = t->capacity - 1;
+    size_t pos = hash & mask;
+    for (;;) {
+        unsigned empty = elegant_group_match(t->ctrl + pos, ELEGANT_GROUP_EMPTY);
+        if (empty) return (pos + (size_t)__builtin_ctz(empty)) & mask;
+        pos = (pos + ELEGANT_GROUP_WIDTH) & mask;
+    }
+}
+
+/* Doubles the slot array once it is 7/8 full; groups keep their indices */
+static int elegant_group_rehash(elegant_group_table_t* t) {
+    int err = elegant_group_alloc_slots(t, t->capacity * 2);
+    if (err) return err;
+
+    for (size_t g = 0; g < t->count; g++) {
+        size_t slot = elegant_group_free_slot(t, t->hashes[g]);
+        elegant_group_set_ctrl(t, slot, elegant_group_tag(t->hashes[g]));
+        t->slots[slot] = (uint32_t)g;
+    }
+    return 0;
+}
+
+static int elegant_group_grow_dense(elegant_group_table_t* t) {
+    size_t capacity = t->dense_capacity ? t->dense_capacity * 2 : 64;
+    if (capacity > UINT32_MAX) return ENOMEM;
+
+    void* keys = realloc(t->keys, capacity * t->key_size);
+    if (keys) t->keys = keys;
+    void* values = t->value_size ? realloc(t->values, capacity * t->value_size) : NULL;
+    if (values) t->values = values;
+    void* counts = realloc(t->counts, capacity * sizeof(size_t));
+    if (counts) t->counts = counts;
+    void* hashes = realloc(t->hashes, capacity * sizeof(uint64_t));
+    if (hashes) t->hashes = hashes;
+    void* firsts = realloc(t->firsts, capacity * sizeof(size_t));
+    if (firsts) t->firsts = firsts;
+
+    if (!keys || (t->value_size && !values) || !counts || !hashes || !firsts) return ENOMEM;
+    t->dense_capacity = capacity;
+    return 0;
+}
+
+/* Folds one element into its group, opening the group on first sight */
+static int elegant_group_add(elegant_group_table_t* t, const elegant_group_spec_t* spec,
+                             const void* key, uint64_t hash, const void* value, size_t index) {
+    uint8_t tag = elegant_group_tag(hash);
+    size_t mask = t->capacity - 1;
+    size_t pos = hash & mask;
+
+    for (;;) {
+        const uint8_t* window = t->ctrl + pos;
+        for (unsigned hits = elegant_group_match(window, tag); hits; hits &= hits - 1) {
+            uint32_t g = t->slots[(pos + (size_t)__builtin_ctz(hits)) & mask];
+            if (t->hashes[g] == hash && memcmp(t->keys + g * t->key_size, key, t->key_size) == 0) {
+                t->counts[g]++;
+                if (t->value_size) spec->combine(t->values + g * t->value_size, value);
+                return 0;
+            }
+        }
+        if (elegant_group_match(window, ELEGANT_GROUP_EMPTY)) break;
+        pos = (pos + ELEGANT_GROUP_WIDTH) & mask;
+    }
+
+    int err;
+    if (t->count >= t->dense_capacity && (err = elegant_group_grow_dense(t)) != 0) return err;
+    if (t->count + 1 > t->capacity / 8 * 7 && (err = elegant_group_rehash(t)) != 0) return err;
+
+    size_t g = t->count++;
+    size_t slot = elegant_group_free_slot(t, hash);
+    elegant_group_set_ctrl(t, slot, tag);
+    t->slots[slot] = (uint32_t)g;
+
+    memcpy(t->keys + g * t->key_size, key, t->key_size);
+    if (t->value_size) memcpy(t->values + g * t->value_size, value, t->value_size);
+    t->counts[g] = 1;
+    t->hashes[g] = hash;
+    t->firsts[g] = index;
+    return 0;
+}
+
+/* Scratch holds an extracted key, then an extracted value at an aligned offset */
+static inline size_t elegant_group_value_offset(const elegant_group_spec_t* spec) {
+    return (spec->key_size + ELEGANT_GROUP_ALIGN - 1) & ~(size_t)(ELEGANT_GROUP_ALIGN - 1);
+}
+
+static inline size_t elegant_group_scratch_size(const elegant_group_spec_t* spec) {
+    return elegant_group_value_offset(spec) + spec->value_size;
+}
+
+/* Key and value of one element, extracted into scratch when there is an extractor */
+static inline const void* elegant_group_key(const elegant_group_spec_t* spec, const char* element, char* scratch) {
+    if (!spec->key) return element;
+    spec->key(scratch, element);
+    return scratch;
+}
+
+static inline const void* elegant_group_value(const elegant_group_spec_t* spec, const char* element, char* scratch) {
+    if (!spec->value_size) return NULL;
+    if (!spec->value) return element;
+    char* value = scratch + elegant_group_value_offset(spec);
+    spec->value(value, element);
+    return value;
+}
+
+/* Parallel mode: hash every element, radix-partition the indices by hash,
+   then aggregate each partition into its own table */
+
+typedef struct {
+    const char* data;
+    size_t length;
+    size_t element_size;
+    const elegant_group_spec_t* spec;
+    size_t blocks;
+    size_t partitions;
+    uint64_t* hashes;             /* per element */
+    size_t* counts;               /* blocks rows of partitions: counts, then offsets */
+    size_t* indices;              /* element indices grouped by partition */
+    size_t* partition_start;      /* partitions + 1 */
+    elegant_group_table_t* tables;
+    int* errors;                  /* per block (hash pass) then per partition */
+} elegant_group_par_ctx_t;
+
+static inline size_t elegant_group_partition(uint64_t hash, size_t partitions) {
+    /* Bits clear of both the slot index and the tag */
+    return (size_t)(hash >> 32) & (partitions - 1);
+}
+
+static inline void elegant_group_block_bounds(const elegant_group_par_ctx_t* ctx, size_t block,
+                                              size_t* first, size_t* last) {
+    *first = ctx->length * block / ctx->blocks;
+    *last = ctx->length * (block + 1) / ctx->blocks;
+}
+
+static void elegant_group_hash_block(void* arg, size_t block) {
+    elegant_group_par_ctx_t* ctx = arg;
+    const elegant_group_spec_t* spec = ctx->spec;
+    size_t first, last;
+    elegant_group_block_bounds(ctx, block, &first, &last);
+
+    size_t* counts = ctx->counts + block * ctx->partitions;
+    memset(counts, 0, ctx->partitions * sizeof(size_t));
+
+    char* scratch = malloc(spec->key_size);
+    if (!scratch) {
+        ctx->errors[block] = ENOMEM;
+        return;
+    }
+    for (size_t i = first; i < last; i++) {
+        const void* key = elegant_group_key(spec, ctx->data + i * ctx->element_size, scratch);
+        uint64_t hash = elegant_hash_bytes(key, spec->key_size);
+        ctx->hashes[i] = hash;
+        counts[elegant_group_partition(hash, ctx->partitions)]++;
+    }
+    free(scratch);
+}
+
+static void elegant_group_scatter_block(void* arg, size_t block) {
+    elegant_group_par_ctx_t* ctx = arg;
+    size_t first, last;
+    elegant_group_block_bounds(ctx, block, &first, &last);
+
+    size_t* offsets = ctx->counts + block * ctx->partitions;
+    for (size_t i = first; i < last; i++) {
+        ctx->indices[offsets[elegant_group_partition(ctx->hashes[i], ctx->partitions)]++] = i;
+    }
+}
+
+static void elegant_group_partition_run(void* arg, size_t partition) {
+    elegant_group_par_ctx_t* ctx = arg;
+    const elegant_group_spec_t* spec = ctx->spec;
+    elegant_group_table_t* table = &ctx->tables[partition];
+
+    int err = elegant_group_table_init(table, spec->key_size, spec->value_size);
+    char* scratch = err ? NULL : malloc(elegant_group_scratch_size(spec));
+    if (!scratch) {
+        ctx->errors[partition] = ENOMEM;
+        return;
+    }
+
+    /* Indices ascend within a partition, so groups open in first-appearance order */
+    for (size_t k = ctx->partition_start[partition]; k < ctx->partition_start[partition + 1] && !err; k++) {
+        size_t i = ctx->indices[k];
+        const char* element = ctx->data + i * ctx->element_size;
+        const void* key = elegant_group_key(spec, element, scratch);
+        const void* value = elegant_group_value(spec, element, scratch);
+        err = elegant_group_add(table, spec, key, ctx->hashes[i], value, i);
+    }
+    free(scratch);
+    ctx->errors[partition] = err;
+}
+
+/* Run body over every block on the pool, or here when the pool can't take it */
+static void elegant_group_for(size_t blocks, void (*body)(void* ctx, size_t block), void* ctx) {
+    if (elegant_parallel_for(blocks, body, ctx) != 0) {
+        for (size_t b = 0; b < blocks; b++) body(ctx, b);
+    }
+}
+
+static int elegant_groups_alloc(elegant_groups_t* groups, const elegant_group_spec_t* spec, size_t count) {
+    groups->keys = elegant_array_create_uninit(spec->key_size, count);
+    groups->values = spec->value_size ? elegant_array_create_uninit(spec->value_size, count) : NULL;
+    groups->counts = elegant_array_create_uninit(sizeof(size_t), count);
+    if (!groups->keys || (spec->value_size && !groups->values) || !groups->counts) {
+        elegant_groups_destroy(groups);
+        return ENOMEM;
+    }
+    return 0;
+}
+
+/* Copies group g of table onto output row `row` */
+static void elegant_groups_emit(elegant_groups_t* groups, const elegant_group_table_t* t, size_t g, size_t row) {
+    memcpy((char*)groups->keys->data + row * t->key_size, t->keys + g * t->key_size, t->key_size);
+    if (t->value_size) {
+        memcpy((char*)groups->values->data + row * t->value_size, t->values + g * t->value_size, t->value_size);
+    }
+    ((size_t*)groups->counts->data)[row] = t->counts[g];
+}
+
+static int elegant_group_by_serial(const char* data, size_t n, size_t element_size,
+                                   const elegant_group_spec_t* spec, elegant_groups_t* groups) {
+    elegant_group_table_t table;
+    int err = elegant_group_table_init(&table, spec->key_size, spec->value_size);
+    char* scratch = err ? NULL : malloc(elegant_group_scratch_size(spec));
+    if (!scratch) {
+        elegant_group_table_free(&table);
+        return ENOMEM;
+    }
+
+    for (size_t i = 0; i < n && !err; i++) {
+        const char* element = data + i * element_size;
+        const void* key = elegant_group_key(spec, element, scratch);
+        const void* value = elegant_group_value(spec, element, scratch);
+        err = elegant_group_add(&table, spec, key, elegant_hash_bytes(key, spec->key_size), value, i);
+    }
+    free(scratch);
+
+    if (!err) err = elegant_groups_alloc(groups, spec, table.count);
+    if (!err) {
+        for (size_t g = 0; g < table.count; g++) elegant_groups_emit(groups, &table, g, g);
+    }
+    elegant_group_table_free(&table);
+    return err;
+}
+
+static int elegant_group_by_parallel(const char* data, size_t n, size_t element_size,
+                                     const elegant_group_spec_t* spec, elegant_groups_t* groups,
+                                     size_t threads) {
+    elegant_group_par_ctx_t ctx = { data, n, element_size, spec, threads * 4,
+                                    (size_t)1 << ELEGANT_GROUP_PARTITION_BITS,
+                                    NULL, NULL, NULL, NULL, NULL, NULL };
+    if (n / ctx.blocks < ELEGANT_GROUP_MIN_BLOCK) ctx.blocks = n / ELEGANT_GROUP_MIN_BLOCK;
+    size_t jobs = ctx.blocks > ctx.partitions ? ctx.blocks : ctx.partitions;
+
+    ctx.hashes = malloc(n * sizeof(uint64_t));
+    ctx.counts = malloc(ctx.blocks * ctx.partitions * sizeof(size_t));
+    ctx.indices = malloc(n * sizeof(size_t));
+    ctx.partition_start = malloc((ctx.partitions + 1) * sizeof(size_t));
+    ctx.tables = calloc(ctx.partitions, sizeof(elegant_group_table_t));
+    ctx.errors = calloc(jobs, sizeof(int));
+    /* Which partition opened a group at each element index, 0 for none */
+    uint16_t* opener = calloc(n, sizeof(uint16_t));
+
+    int err = 0;
+    if (!ctx.hashes || !ctx.counts || !ctx.indices || !ctx.partition_start ||
+        !ctx.tables || !ctx.errors || !opener) {
+        err = ENOMEM;
+        goto done;
+    }
+
+    elegant_group_for(ctx.blocks, elegant_group_hash_block, &ctx);
+    for (size_t b = 0; b < ctx.blocks; b++) {
+        if (ctx.errors[b]) err = ctx.errors[b];
+    }
+    if (err) goto done;
+
+    /* Partition-major, block-minor offsets keep indices ascending per partition */
+    size_t running = 0;
+    for (size_t p = 0; p < ctx.partitions; p++) {
+        ctx.partition_start[p] = running;
+        for (size_t b = 0; b < ctx.blocks; b++) {
+            size_t count = ctx.counts[b * ctx.partitions + p];
+            ctx.counts[b * ctx.partitions + p] = running;
+            running += count;
+        }
+    }
+    ctx.partition_start[ctx.partitions] = running;
+    elegant_group_for(ctx.blocks, elegant_group_scatter_block, &ctx);
+
+    memset(ctx.errors, 0, jobs * sizeof(int));
+    elegant_group_for(ctx.partitions, elegant_group_partition_run, &ctx);
+
+    size_t total = 0;
+    for (size_t p = 0; p < ctx.partitions; p++) {
+        if (ctx.errors[p]) err = ctx.errors[p];
+        total += ctx.tables[p].count;
+        for (size_t g = 0; g < ctx.tables[p].count; g++) opener[ctx.tables[p].firsts[g]] = (uint16_t)(p + 1);
+    }
+    if (!err) err = elegant_groups_alloc(groups, spec, total);
+    if (err) goto done;
+
+    /* Walking element order restores global first-appearance order */
+    size_t* next = ctx.partition_start;   /* reused as per-partition cursors */
+    memset(next, 0, ctx.partitions * sizeof(size_t));
+    size_t row = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!opener[i]) continue;
+        size_t p = opener[i] - 1u;
+        elegant_groups_emit(groups, &ctx.tables[p], next[p]++, row++);
+    }
+
+done:
+    if (ctx.tables) {
+        for (size_t p = 0; p < ctx.partitions; p++) elegant_group_table_free(&ctx.tables[p]);
+    }
+    free(ctx.hashes);
+    free(ctx.counts);
+    free(ctx.indices);
+    free(ctx.partition_start);
+    free(ctx.tables);
+    free(ctx.errors);
+    free(opener);
+    return err;
+}
+
+int elegant_group_by(elegant_array_t* src, const elegant_group_spec_t* spec, elegant_groups_t* groups) {
+    if (groups) memset(groups, 0, sizeof(*groups));
+    if (!src || !spec || !groups || spec->key_size == 0) return EINVAL;
+    if (!spec->key && spec->key_size != src->element_size) return EINVAL;
+    if (spec->value_size && (!spec->combine || (!spec->value && spec->value_size != src->element_size))) {
+        return EINVAL;
+    }
+    elegant_array_advise_scan(src);
+    elegant_op_probe_t probe = elegant_stats_begin();
+
+    size_t n = elegant_array_get_length(src);
+    const char* data = elegant_array_get_data(src);
+    if (n > 0 && !data) return ENOMEM;
+
+    size_t threads = n >= ELEGANT_GROUP_PARALLEL_MIN ? elegant_parallel_get_threads() : 1;
+    int err = threads > 1 && n / ELEGANT_GROUP_MIN_BLOCK >= 2
+            ? elegant_group_by_parallel(data, n, src->element_size, spec, groups, threads)
+            : elegant_group_by_serial(data, n, src->element_size, spec, groups);
+    if (err) return err;
+
+    elegant_stats_end(&probe, ELEGANT_OP_GROUP, n);
+    return 0;
+}
+
+/* Arrays a scope frame registered are left for the frame to free */
+static void elegant_groups_drop(elegant_array_t* arr) {
+    if (arr && !(arr->flags & ELEGANT_ARRAY_SCOPED)) elegant_array_destroy(arr);
+}
+
+void elegant_groups_destroy(elegant_groups_t* groups) {
+    if (!groups) return;
+    elegant_groups_drop(groups->keys);
+    elegant_groups_drop(groups->values);
+    elegant_groups_drop(groups->counts);
+    memset(groups, 0, sizeof(*groups));
+}
+
+elegant_array_t* elegant_distinct(elegant_array_t* src) {
+    if (!src) return NULL;
+
+    elegant_group_spec_t spec = { src->element_size, NULL, 0, NULL, NULL };
+    elegant_groups_t groups;
+    if (elegant_group_by(src, &spec, &groups) != 0) return NULL;
+
+    elegant_groups_drop(groups.counts);
+    return groups.keys;
+}
@@ -0,0 +1,518 @@
+/*
+ * Elegant - Parallel Collection Operations
+ * A persistent pthread pool runs block-partitioned MAP/FILTER/REDUCE jobs.
+ * Every participant owns a contiguous range of blocks and claims them with
+ * an atomic fetch-add; once its own range is drained it claims from the
+ * other ranges the same way, so stealing needs no extra locking.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* One participant's block range, padded so claims don't share a line */
+typedef struct {
+    size_t next;
+    size_t end;
+    char pad[ELEGANT_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+} elegant_par_range_t;
+
+typedef struct elegant_par_job {
+    void (*run)(struct elegant_par_job* job, size_t block);
+    void* ctx;
+    size_t blocks;
+    size_t block_elems;
+    size_t length;
+    size_t participants;
+    elegant_par_range_t* ranges;
+    elegant_memory_mode_t memory_mode;
+} elegant_par_job_t;
+
+/* Pool state, guarded by elegant_pool_lock */
+static pthread_mutex_t elegant_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t elegant_pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t elegant_pool_idle = PTHREAD_COND_INITIALIZER;
+static pthread_t* elegant_pool_workers = NULL;
+static size_t elegant_pool_worker_count = 0;
+static size_t elegant_pool_threads = 0;        /* configured total, 0 = auto */
+static int elegant_pool_started = 0;
+static int elegant_pool_stopping = 0;
+static unsigned long elegant_pool_generation = 0;
+static unsigned long elegant_pool_base_generation = 0;   /* at worker start */
+static size_t elegant_pool_pending = 0;
+static elegant_par_job_t* elegant_pool_job = NULL;
+
+/* Serialises jobs from different caller threads and pool reconfiguration */
+static pthread_mutex_t elegant_pool_submit = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread int elegant_par_in_worker = 0;
+
+static size_t elegant_par_default_threads(void) {
+    const char* env = getenv("ELEGANT_THREADS");
+    if (env && *env) {
+        char* end = NULL;
+        unsigned long value = strtoul(env, &end, 10);
+        if (end && *end == '\0' && value > 0) return (size_t)value;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+}
+
+/* Claim and run blocks: own range first, then steal from the others */
+static void elegant_par_execute(elegant_par_job_t* job, size_t self) {
+    for (size_t i = 0; i < job->participants; i++) {
+        elegant_par_range_t* range = &job->ranges[(self + i) % job->participants];
+        for (;;) {
+            size_t block = __atomic_fetch_add(&range->next, 1, __ATOMIC_RELAXED);
+            if (block >= range->end) break;
+            job->run(job, block);
+        }
+    }
+}
+
+static void* elegant_par_worker(void* arg) {
+    size_t self = (size_t)(uintptr_t)arg;
+    unsigned long seen;
+
+    elegant_par_in_worker = 1;
+
+    /* A job may already be posted by the time this thread gets the lock */
+    pthread_mutex_lock(&elegant_pool_lock);
+    seen = elegant_pool_base_generation;
+    for (;;) {
+        while (elegant_pool_generation == seen && !elegant_pool_stopping) {
+            pthread_cond_wait(&elegant_pool_wake, &elegant_pool_lock);
+        }
+        if (elegant_pool_stopping) break;
+        seen = elegant_pool_generation;
+        elegant_par_job_t* job = elegant_pool_job;
+        pthread_mutex_unlock(&elegant_pool_lock);
+
+        /* Run under the caller's memory mode inside a worker-local scope,
+           so anything the callbacks allocate is reclaimed per job */
+        elegant_memory_mode_t saved_mode = elegant_current_memory_mode;
+        elegant_current_memory_mode = job->memory_mode;
+        elegant_scope_enter();
+        elegant_par_execute(job, self);
+        elegant_scope_exit();
+        elegant_current_memory_mode = saved_mode;
+
+        pthread_mutex_lock(&elegant_pool_lock);
+        if (--elegant_pool_pending == 0) {
+            pthread_cond_signal(&elegant_pool_idle);
+        }
+    }
+    pthread_mutex_unlock(&elegant_pool_lock);
+    return NULL;
+}
+
+/* Called with elegant_pool_submit held */
+static void elegant_pool_start(void) {
+    if (elegant_pool_started) return;
+    elegant_pool_started = 1;
+
+    size_t threads = elegant_pool_threads ? elegant_pool_threads : elegant_par_default_threads();
+    if (threads > ELEGANT_PAR_MAX_THREADS) threads = ELEGANT_PAR_MAX_THREADS;
+    if (threads <= 1) return;
+
+    elegant_pool_workers = malloc((threads - 1) * sizeof(pthread_t));
+    if (!elegant_pool_workers) {
+        fprintf(stderr, "Elegant: Failed to allocate thread pool, running sequentially\n");
+        return;
+    }
+
+    elegant_pool_stopping = 0;
+    elegant_pool_base_generation = elegant_pool_generation;
+    for (size_t i = 0; i < threads - 1; i++) {
+        /* Participant 0 is the submitting thread */
+        if (pthread_create(&elegant_pool_workers[i], NULL, elegant_par_worker,
+                           (void*)(uintptr_t)(i + 1)) != 0) {
+            fprintf(stderr, "Elegant: Started %zu of %zu pool threads\n", i, threads - 1);
+            break;
+        }
+        elegant_pool_worker_count++;
+    }
+}
+
+/* Called with elegant_pool_submit held */
+static void elegant_pool_stop(void) {
+    pthread_mutex_lock(&elegant_pool_lock);
+    elegant_pool_stopping = 1;
+    pthread_cond_broadcast(&elegant_pool_wake);
+    pthread_mutex_unlock(&elegant_pool_lock);
+
+    for (size_t i = 0; i < elegant_pool_worker_count; i++) {
+        pthread_join(elegant_pool_workers[i], NULL);
+    }
+
+    free(elegant_pool_workers);
+    elegant_pool_workers = NULL;
+    elegant_pool_worker_count = 0;
+    elegant_pool_stopping = 0;
+    elegant_pool_started = 0;
+}
+
+int elegant_parallel_set_threads(size_t threads) {
+    if (elegant_par_in_worker) return EBUSY;
+    pthread_mutex_lock(&elegant_pool_submit);
+    if (elegant_pool_started) elegant_pool_stop();
+    elegant_pool_threads = threads;
+    pthread_mutex_unlock(&elegant_pool_submit);
+    return 0;
+}
+
+size_t elegant_parallel_get_threads(void) {
+    /* Inside a job (on a worker or the submitting thread) nested calls run sequentially */
+    if (elegant_par_in_worker) return 1;
+    pthread_mutex_lock(&elegant_pool_submit);
+    elegant_pool_start();
+    size_t threads = elegant_pool_worker_count + 1;
+    pthread_mutex_unlock(&elegant_pool_submit);
+    return threads;
+}
+
+void elegant_parallel_shutdown(void) {
+    if (elegant_par_in_worker) return;
+    pthread_mutex_lock(&elegant_pool_submit);
+    if (elegant_pool_started) elegant_pool_stop();
+    pthread_mutex_unlock(&elegant_pool_submit);
+}
+
+/* Split len elements into cache-sized blocks; 0 means run sequentially */
+static size_t elegant_par_plan(size_t len, size_t element_size, size_t* block_elems) {
+    if (elegant_par_in_worker || element_size == 0) return 0;
+
+    size_t per_block = ELEGANT_PAR_BLOCK_BYTES / element_size;
+    if (per_block == 0) per_block = 1;
+
+    size_t blocks = len / per_block + (len % per_block != 0);
+    if (blocks < 2) return 0;
+
+    *block_elems = per_block;
+    return blocks;
+}
+
+/* Run job->run over all blocks; returns 0, or ENOMEM/EAGAIN if the caller
+   should fall back to the sequential path */
+static int elegant_par_dispatch(elegant_par_job_t* job) {
+    pthread_mutex_lock(&elegant_pool_submit);
+    elegant_pool_start();
+
+    size_t participants = elegant_pool_worker_count + 1;
+    if (participants < 2) {
+        pthread_mutex_unlock(&elegant_pool_submit);
+        return EAGAIN;
+    }
+
+    elegant_par_range_t* ranges = malloc(participants * sizeof(elegant_par_range_t));
+    if (!ranges) {
+        pthread_mutex_unlock(&elegant_pool_submit);
+        return ENOMEM;
+    }
+
+    for (size_t p = 0; p < participants; p++) {
+        ranges[p].next = job->blocks * p / participants;
+        ranges[p].end = job->blocks * (p + 1) / participants;
+    }
+
+    job->participants = participants;
+    job->ranges = ranges;
+    job->memory_mode = elegant_current_memory_mode;
+
+    pthread_mutex_lock(&elegant_pool_lock);
+    elegant_pool_job = job;
+    elegant_pool_pending = elegant_pool_worker_count;
+    elegant_pool_generation++;
+    pthread_cond_broadcast(&elegant_pool_wake);
+    pthread_mutex_unlock(&elegant_pool_lock);
+
+    /* The submitter takes part as a worker, so nested calls from its
+       callbacks run sequentially instead of re-locking elegant_pool_submit */
+    int was_in_worker = elegant_par_in_worker;
+    elegant_par_in_worker = 1;
+    elegant_par_execute(job, 0);
+    elegant_par_in_worker = was_in_worker;
+
+    pthread_mutex_lock(&elegant_pool_lock);
+    while (elegant_pool_pending > 0) {
+        pthread_cond_wait(&elegant_pool_idle, &elegant_pool_lock);
+    }
+    elegant_pool_job = NULL;
+    pthread_mutex_unlock(&elegant_pool_lock);
+
+    free(ranges);
+    pthread_mutex_unlock(&elegant_pool_submit);
+    return 0;
+}
+
+/* PARALLEL FOR: one block per index, no element partitioning */
+
+typedef struct {
+    void (*body)(void* ctx, size_t block);
+    void* ctx;
+} elegant_par_for_ctx_t;
+
+static void elegant_par_for_block(elegant_par_job_t* job, size_t block) {
+    elegant_par_for_ctx_t* ctx = job->ctx;
+    ctx->body(ctx->ctx, block);
+}
+
+int elegant_parallel_for(size_t blocks, void (*body)(void* ctx, size_t block), void* ctx) {
+    if (!body) return EINVAL;
+    if (elegant_par_in_worker) return EAGAIN;
+    if (blocks == 0) return 0;
+
+    elegant_par_for_ctx_t for_ctx = { body, ctx };
+    elegant_par_job_t job = {0};
+    job.run = elegant_par_for_block;
+    job.ctx = &for_ctx;
+    job.blocks = blocks;
+    job.block_elems = 1;
+    job.length = blocks;
+    return elegant_par_dispatch(&job);
+}
+
+static inline void elegant_par_block_bounds(const elegant_par_job_t* job, size_t block,
+                                            size_t* first, size_t* last) {
+    *first = block * job->block_elems;
+    *last = *first + job->block_elems;
+    if (*last > job->length) *last = job->length;
+}
+
+/* MAP */
+
+typedef struct {
+    const char* src;
+    char* dst;
+    size_t src_element_size;
+    size_t dst_element_size;
+    void* (*func)(void*);
+    void (*into)(void* out, void* in);
+} elegant_par_map_ctx_t;
+
+static void elegant_par_map_block(elegant_par_job_t* job, size_t block) {
+    elegant_par_map_ctx_t* ctx = job->ctx;
+    size_t first, last;
+    elegant_par_block_bounds(job, block, &first, &last);
+
+    const char* in = ctx->src + first * ctx->src_element_size;
+    char* out = ctx->dst + first * ctx->dst_element_size;
+    if (ctx->into) {
+        for (size_t i = first; i < last; i++) {
+            ctx->into(out, (void*)in);
+            in += ctx->src_element_size;
+            out += ctx->dst_element_size;
+        }
+    } else {
+        for (size_t i = first; i < last; i++) {
+            memcpy(out, ctx->func((void*)in), ctx->dst_element_size);
+            in += ctx->src_element_size;
+            out += ctx->dst_element_size;
+        }
+    }
+}
+
+static elegant_array_t* elegant_par_map_run(elegant_array_t* src, elegant_par_map_ctx_t* ctx, elegant_par_job_t* job) {
+    elegant_op_probe_t probe = elegant_stats_begin();
+    size_t len = elegant_array_get_length(src);
+    elegant_array_t* result = elegant_array_create_uninit(ctx->dst_element_size, len);
+    if (!result) return NULL;
+
+    ctx->src = (const char*)elegant_array_get_data(src);
+    ctx->dst = elegant_array_get_data(result);
+    job->run = elegant_par_map_block;
+    job->ctx = ctx;
+    job->length = len;
+
+    if (elegant_par_dispatch(job) != 0) {
+        for (size_t b = 0; b < job->blocks; b++) elegant_par_map_block(job, b);
+    }
+    elegant_stats_end(&probe, ELEGANT_OP_PAR_MAP, len);
+    return result;
+}
+
+elegant_array_t* elegant_par_map_generic(elegant_array_t* src, void* (*func)(void*), size_t element_size) {
+    if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+
+    elegant_par_job_t job = {0};
+    job.blocks = elegant_par_plan(elegant_array_get_length(src), element_size, &job.block_elems);
+    if (job.blocks == 0) return elegant_map_generic(src, func, element_size);
+
+    elegant_par_map_ctx_t ctx = { NULL, NULL, element_size, element_size, func, NULL };
+    return elegant_par_map_run(src, &ctx, &job);
+}
+
+elegant_array_t* elegant_par_map_into_generic(elegant_array_t* src, void (*func)(void* out, void* in),
+                                              size_t src_element_size, size_t dst_element_size) {
+    if (!src || !func) return NULL;
+    elegant_array_advise_scan(src);
+
+    elegant_par_job_t job = {0};
+    size_t widest = src_element_size > dst_element_size ? src_element_size : dst_element_size;
+    job.blocks = elegant_par_plan(elegant_array_get_length(src), widest, &job.block_elems);
+    if (job.blocks == 0) return elegant_map_into_generic(src, func, src_element_size, dst_element_size);
+
+    elegant_par_map_ctx_t ctx = { NULL, NULL, src_element_size, dst_element_size, NULL, func };
+    return elegant_par_map_run(src, &ctx, &job);
+}
+
+/* FILTER: keep-flags and per-block counts, exclusive prefix sum, scatter */
+
+typedef struct {
+    const char* src;
+    char* dst;
+    size_t element_size;
+    int (*predicate)(void*);
+    unsigned char* keep;
+    size_t* offsets;        /* per-block count, then per-block output start */
+} elegant_par_filter_ctx_t;
+
+static void elegant_par_filter_mark(elegant_par_job_t* job, size_t block) {
+    elegant_par_filter_ctx_t* ctx = job->ctx;
+    size_t first, last, count = 0;
+    elegant_par_block_bounds(job, block, &first, &last);
+
+    for (size_t i = first; i < last; i++) {
+        unsigned char hit = ctx->predicate((void*)(ctx->src + i * ctx->element_size)) != 0;
+        ctx->keep[i] = hit;
+        count += hit;
+    }
+    ctx->offsets[block] = count;
+}
+
+static void elegant_par_filter_scatter(elegant_par_job_t* job, size_t block) {
+    elegant_par_filter_ctx_t* ctx = job->ctx;
+    size_t first, last;
+    elegant_par_block_bounds(job, block, &first, &last);
+
+    char* out = ctx->dst + ctx->offsets[block] * ctx->element_size;
+    for (size_t i = first; i < last; i++) {
+        if (ctx->keep[i]) {
+            memcpy(out, ctx->src + i * ctx->element_size, ctx->element_size);
+            out += ctx->element_size;
+        }
+    }
+}
+
+elegant_array_t* elegant_par_filter_generic(elegant_array_t* src, int (*predicate)(void*), size_t element_size) {
+    if (!src || !predicate) return NULL;
+    elegant_array_advise_scan(src);
+
+    size_t len = elegant_array_get_length(src);
+    elegant_par_job_t job = {0};
+    job.blocks = elegant_par_plan(len, element_size, &job.block_elems);
+    if (job.blocks == 0) return elegant_filter_generic(src, predicate, element_size);
+
+    elegant_op_probe_t probe = elegant_stats_begin();
+    elegant_par_filter_ctx_t ctx = {
+        (const char*)elegant_array_get_data(src), NULL, element_size, predicate,
+        malloc(len), malloc(job.blocks * sizeof(size_t))
+    };
+    if (!ctx.keep || !ctx.offsets) {
+        free(ctx.keep);
+        free(ctx.offsets);
+        return elegant_filter_generic(src, predicate, element_size);
+    }
+
+    job.run = elegant_par_filter_mark;
+    job.ctx = &ctx;
+    job.length = len;
+
+    elegant_array_t* result = NULL;
+    if (elegant_par_dispatch(&job) == 0) {
+        size_t total = 0;
+        for (size_t b = 0; b < job.blocks; b++) {
+            size_t count = ctx.offsets[b];
+            ctx.offsets[b] = total;
+            total += count;
+        }
+
+        result = elegant_array_create_uninit(element_size, total);
+        if (result && total > 0) {
+            ctx.dst = elegant_array_get_data(result);
+            job.run = elegant_par_filter_scatter;
+            if (elegant_par_dispatch(&job) != 0) {
+                /* Flags are already computed; finish on this thread */
+                for (size_t b = 0; b < job.blocks; b++) elegant_par_filter_scatter(&job, b);
+            }
+        }
+        if (result) elegant_stats_end(&probe, ELEGANT_OP_PAR_FILTER, len);
+    } else {
+        result = elegant_filter_generic(src, predicate, element_size);
+    }
+
+    free(ctx.keep);
+    free(ctx.offsets);
+    return result;
+}
+
+/* REDUCE: fold each block from its first element, then combine the
+   partials as a pairwise tree so only associativity is required */
+
+typedef struct {
+    const char* src;
+    char* partials;
+    size_t element_size;
+    void* (*func)(void*, void*);
+} elegant_par_reduce_ctx_t;
+
+static void elegant_par_reduce_block(elegant_par_job_t* job, size_t block) {
+    elegant_par_reduce_ctx_t* ctx = job->ctx;
+    size_t first, last;
+    elegant_par_block_bounds(job, block, &first, &last);
+
+    char* acc = ctx->partials + block * ctx->element_size;
+    memcpy(acc, ctx->src + first * ctx->element_size, ctx->element_size);
+    for (size_t i = first + 1; i < last; i++) {
+        void* next = ctx->func(acc, (void*)(ctx->src + i * ctx->element_size));
+        memcpy(acc, next, ctx->element_size);
+    }
+}
+
+void* elegant_par_reduce_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial, size_t element_size) {
+    if (!src || !func || !initial) return initial;
+    elegant_array_advise_scan(src);
+
+    size_t len = elegant_array_get_length(src);
+    elegant_par_job_t job = {0};
+    job.blocks = elegant_par_plan(len, element_size, &job.block_elems);
+    if (job.blocks == 0) return elegant_reduce_generic(src, func, initial, element_size);
+
+    elegant_op_probe_t probe = elegant_stats_begin();
+    elegant_par_reduce_ctx_t ctx = {
+        (const char*)elegant_array_get_data(src), malloc(job.blocks * element_size), element_size, func
+    };
+    if (!ctx.partials) return elegant_reduce_generic(src, func, initial, element_size);
+
+    job.run = elegant_par_reduce_block;
+    job.ctx = &ctx;
+    job.length = len;
+
+    if (elegant_par_dispatch(&job) != 0) {
+        free(ctx.partials);
+        return elegant_reduce_generic(src, func, initial, element_size);
+    }
+
+    for (size_t step = 1; step < job.blocks; step *= 2) {
+        for (size_t b = 0; b + step < job.blocks; b += 2 * step) {
+            char* left = ctx.partials + b * element_size;
+            void* combined = func(left, ctx.partials + (b + step) * element_size);
+            memcpy(left, combined, element_size);
+        }
+    }
+
+    void* accumulator = malloc(element_size);
+    if (!accumulator) {
+        free(ctx.partials);
+        return initial;
+    }
+
+    memcpy(accumulator, func(initial, ctx.partials), element_size);
+    free(ctx.partials);
+    elegant_stats_end(&probe, ELEGANT_OP_PAR_REDUCE, len);
+    return accumulator;
+}
@@ -0,0 +1,420 @@
+/*
+ * Elegant - Overlapped Pipelines
+ * Stage k reads link k-1 and writes link k; link 0 is filled by the reader
+ * thread straight from the source stream. A link is two SPSC rings of
+ * chunk pointers: `full` from producer to consumer, `spare` back again.
+ * Stopping closes every ring, which releases any thread waiting on one.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct {
+    elegant_ring_t* full;
+    elegant_ring_t* spare;
+    elegant_array_t* chunks;   /* depth embedded headers over buffer */
+    char* buffer;
+    size_t element_size;
+} elegant_pipe_link_t;
+
+typedef struct {
+    elegant_pipeline_stage_t run;
+    void* ctx;
+    bool owns_ctx;
+    size_t out_element_size;
+} elegant_pipe_stage_t;
+
+struct elegant_pipeline {
+    elegant_stream_t* source;
+    size_t depth;
+    size_t chunk_length;
+    elegant_pipe_stage_t* stages;
+    size_t stage_count;
+    elegant_pipe_link_t* links;    /* stage_count + 1 once started */
+    pthread_t* threads;
+    size_t thread_count;
+    elegant_array_t* current;      /* chunk lent to the caller */
+    bool started;
+    bool finished;
+    int error;
+};
+
+typedef struct {
+    elegant_pipeline_t* pipeline;
+    size_t index;                  /* 0 is the reader */
+} elegant_pipe_worker_t;
+
+/* Built-in MAP/FILTER stages */
+typedef struct {
+    void (*map)(void* out, void* in);
+    int (*predicate)(void*);
+    size_t in_size;
+    size_t out_size;
+} elegant_pipe_transform_t;
+
+/* Record the first error and release every thread, including the caller */
+static void elegant_pipeline_stop(elegant_pipeline_t* pipeline, int err) {
+    if (err) {
+        int none = 0;
+        __atomic_compare_exchange_n(&pipeline->error, &none, err, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+    if (!pipeline->links) return;
+    for (size_t i = 0; i <= pipeline->stage_count; i++) {
+        elegant_ring_close(pipeline->links[i].full);
+        elegant_ring_close(pipeline->links[i].spare);
+    }
+}
+
+static inline elegant_array_t* elegant_pipe_take(elegant_ring_t* ring) {
+    elegant_array_t* chunk;
+    return elegant_ring_pop(ring, &chunk, 1) == 1 ? chunk : NULL;
+}
+
+/* False once the ring is closed, i.e. the pipeline is stopping */
+static inline bool elegant_pipe_give(elegant_ring_t* ring, elegant_array_t* chunk) {
+    return elegant_ring_push(ring, &chunk, 1) == 1;
+}
+
+static void elegant_pipe_read(elegant_pipeline_t* pipeline) {
+    elegant_pipe_link_t* out = &pipeline->links[0];
+    size_t capacity = pipeline->chunk_length;
+
+    elegant_array_t* chunk;
+    while ((chunk = elegant_pipe_take(out->spare)) != NULL) {
+        size_t count = elegant_stream_read(pipeline->source, chunk->data, capacity);
+        if (count == 0) break;
+        chunk->length = count;
+        if (!elegant_pipe_give(out->full, chunk)) return;
+    }
+
+    int err = elegant_stream_error(pipeline->source);
+    if (err) elegant_pipeline_stop(pipeline, err);
+    else elegant_ring_close(out->full);
+}
+
+static void elegant_pipe_transform(elegant_pipeline_t* pipeline, size_t index) {
+    elegant_pipe_stage_t* stage = &pipeline->stages[index - 1];
+    elegant_pipe_link_t* in = &pipeline->links[index - 1];
+    elegant_pipe_link_t* out = &pipeline->links[index];
+
+    /* A chunk taken from spare stays here until it carries something downstream */
+    elegant_array_t* target = NULL;
+    elegant_array_t* chunk;
+    while ((chunk = elegant_pipe_take(in->full)) != NULL) {
+        if (!target && (target = elegant_pipe_take(out->spare)) == NULL) return;
+
+        elegant_op_probe_t probe = elegant_stats_begin();
+        size_t count = stage->run(stage->ctx, chunk->data, chunk->length, target->data,
+                                  pipeline->chunk_length);
+        if (count == ELEGANT_STREAM_ERROR) {
+            elegant_pipeline_stop(pipeline, errno ? errno : EIO);
+            return;
+        }
+        elegant_stats_end(&probe, ELEGANT_OP_STREAM, chunk->length);
+
+        if (!elegant_pipe_give(in->spare, chunk)) return;
+        if (count == 0) continue;
+        target->length = count < pipeline->chunk_length ? count : pipeline->chunk_length;
+        if (!elegant_pipe_give(out->full, target)) return;
+        target = NULL;
+    }
+    elegant_ring_close(out->full);
+}
+
+static void* elegant_pipe_worker(void* arg) {
+    elegant_pipe_worker_t* worker = arg;
+    if (worker->index == 0) elegant_pipe_read(worker->pipeline);
+    else elegant_pipe_transform(worker->pipeline, worker->index);
+    free(worker);
+    return NULL;
+}
+
+elegant_pipeline_t* elegant_pipeline_create(elegant_stream_t* source, size_t depth) {
+    if (!source) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    elegant_pipeline_t* pipeline = calloc(1, sizeof(elegant_pipeline_t));
+    if (!pipeline) {
+        fprintf(stderr, "Elegant: Failed to allocate pipeline\n");
+        elegant_stream_close(source);
+        return NULL;
+    }
+    pipeline->source = source;
+    /* One chunk in each hand plus one in flight keeps both sides busy */
+    pipeline->depth = depth ? (depth < 2 ? 2 : depth) : ELEGANT_PIPELINE_DEPTH;
+    pipeline->chunk_length = elegant_stream_chunk_length(source);
+    return pipeline;
+}
+
+static size_t elegant_pipeline_out_size(const elegant_pipeline_t* pipeline) {
+    return pipeline->stage_count ? pipeline->stages[pipeline->stage_count - 1].out_element_size
+                                 : elegant_stream_element_size(pipeline->source);
+}
+
+static int elegant_pipeline_add(elegant_pipeline_t* pipeline, elegant_pipeline_stage_t run, void* ctx,
+                                bool owns_ctx, size_t in_element_size, size_t out_element_size) {
+    if (!pipeline || !run || out_element_size == 0) return EINVAL;
+    if (pipeline->started) return EBUSY;
+    if (in_element_size != elegant_pipeline_out_size(pipeline)) return EINVAL;
+
+    elegant_pipe_stage_t* stages = realloc(pipeline->stages,
+                                           (pipeline->stage_count + 1) * sizeof(elegant_pipe_stage_t));
+    if (!stages) return ENOMEM;
+    pipeline->stages = stages;
+    stages[pipeline->stage_count++] = (elegant_pipe_stage_t){ run, ctx, owns_ctx, out_element_size };
+    return 0;
+}
+
+int elegant_pipeline_stage(elegant_pipeline_t* pipeline, elegant_pipeline_stage_t stage, void* ctx,
+                           size_t in_element_size, size_t out_element_size) {
+    return elegant_pipeline_add(pipeline, stage, ctx, false, in_element_size, out_element_size);
+}
+
+static size_t elegant_pipe_map_run(void* ctx, const void* in, size_t count, void* out, size_t capacity) {
+    elegant_pipe_transform_t* transform = ctx;
+    (void)capacity;
+
+    const char* src = in;
+    char* dst = out;
+    for (size_t i = 0; i < count; i++) {
+        transform->map(dst + i * transform->out_size, (void*)(src + i * transform->in_size));
+    }
+    return count;
+}
+
+static size_t elegant_pipe_filter_run(void* ctx, const void* in, size_t count, void* out, size_t capacity) {
+    elegant_pipe_transform_t* transform = ctx;
+    (void)capacity;
+
+    size_t size = transform->in_size;
+    const char* src = in;
+    char* dst = out;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        const char* element = src + i * size;
+        if (transform->predicate((void*)element)) {
+            memcpy(dst + kept * size, element, size);
+            kept++;
+        }
+    }
+    return kept;
+}
+
+static int elegant_pipeline_add_transform(elegant_pipeline_t* pipeline, elegant_pipeline_stage_t run,
+                                          void (*map)(void*, void*), int (*predicate)(void*),
+                                          size_t in_size, size_t out_size) {
+    elegant_pipe_transform_t* transform = malloc(sizeof(elegant_pipe_transform_t));
+    if (!transform) return ENOMEM;
+    *transform = (elegant_pipe_transform_t){ map, predicate, in_size, out_size };
+
+    int err = elegant_pipeline_add(pipeline, run, transform, true, in_size, out_size);
+    if (err) free(transform);
+    return err;
+}
+
+int elegant_pipeline_map_generic(elegant_pipeline_t* pipeline, void (*func)(void* out, void* in),
+                                 size_t src_element_size, size_t dst_element_size) {
+    if (!func) return EINVAL;
+    return elegant_pipeline_add_transform(pipeline, elegant_pipe_map_run, func, NULL,
+                                          src_element_size, dst_element_size);
+}
+
+int elegant_pipeline_filter_generic(elegant_pipeline_t* pipeline, int (*predicate)(void*),
+                                    size_t element_size) {
+    if (!predicate) return EINVAL;
+    return elegant_pipeline_add_transform(pipeline, elegant_pipe_filter_run, NULL, predicate,
+                                          element_size, element_size);
+}
+
+static int elegant_pipe_link_init(elegant_pipe_link_t* link, size_t element_size,
+                                  size_t depth, size_t chunk_length) {
+    link->element_size = element_size;
+    if (chunk_length > SIZE_MAX / element_size / depth) return ENOMEM;
+
+    link->full = elegant_ring_create(sizeof(elegant_array_t*), depth);
+    link->spare = elegant_ring_create(sizeof(elegant_array_t*), depth);
+    link->chunks = calloc(depth, sizeof(elegant_array_t));
+    link->buffer = malloc(depth * chunk_length * element_size);
+    if (!link->full || !link->spare || !link->chunks || !link->buffer) return ENOMEM;
+
+    /* Plain owning heap arrays as far as the collection functions can tell */
+    for (size_t i = 0; i < depth; i++) {
+        elegant_array_t* chunk = &link->chunks[i];
+        chunk->data = link->buffer + i * chunk_length * element_size;
+        chunk->element_size = element_size;
+        chunk->capacity = chunk_length;
+        chunk->ref_count = 1;
+        elegant_pipe_give(link->spare, chunk);
+    }
+    return 0;
+}
+
+static void elegant_pipe_link_free(elegant_pipe_link_t* link) {
+    elegant_ring_destroy(link->full);
+    elegant_ring_destroy(link->spare);
+    free(link->chunks);
+    free(link->buffer);
+}
+
+static void elegant_pipeline_join(elegant_pipeline_t* pipeline) {
+    for (size_t i = 0; i < pipeline->thread_count; i++) {
+        pthread_join(pipeline->threads[i], NULL);
+    }
+    pipeline->thread_count = 0;
+}
+
+static int elegant_pipeline_start(elegant_pipeline_t* pipeline) {
+    pipeline->started = true;
+
+    size_t links = pipeline->stage_count + 1;
+    pipeline->links = calloc(links, sizeof(elegant_pipe_link_t));
+    pipeline->threads = malloc(links * sizeof(pthread_t));
+    if (!pipeline->links || !pipeline->threads) return ENOMEM;
+
+    size_t element_size = elegant_stream_element_size(pipeline->source);
+    for (size_t i = 0; i < links; i++) {
+        if (i > 0) element_size = pipeline->stages[i - 1].out_element_size;
+        int err = elegant_pipe_link_init(&pipeline->links[i], element_size,
+                                         pipeline->depth, pipeline->chunk_length);
+        if (err) return err;
+    }
+
+    for (size_t i = 0; i < links; i++) {
+        elegant_pipe_worker_t* worker = malloc(sizeof(elegant_pipe_worker_t));
+        int err = worker ? 0 : ENOMEM;
+        if (worker) {
+            *worker = (elegant_pipe_worker_t){ pipeline, i };
+            err = pthread_create(&pipeline->threads[i], NULL, elegant_pipe_worker, worker);
+            if (err) free(worker);
+        }
+        if (err) {
+            elegant_pipeline_stop(pipeline, err);
+            elegant_pipeline_join(pipeline);
+            return err;
+        }
+        pipeline->thread_count++;
+    }
+    return 0;
+}
+
+static void elegant_pipeline_finish(elegant_pipeline_t* pipeline) {
+    pipeline->finished = true;
+    pipeline->current = NULL;
+    elegant_pipeline_join(pipeline);
+}
+
+elegant_array_t* elegant_pipeline_next(elegant_pipeline_t* pipeline) {
+    if (!pipeline || pipeline->finished) return NULL;
+
+    if (!pipeline->started) {
+        int err = elegant_pipeline_start(pipeline);
+        if (err) {
+            elegant_pipeline_stop(pipeline, err);
+            elegant_pipeline_finish(pipeline);
+            return NULL;
+        }
+    }
+
+    elegant_pipe_link_t* last = &pipeline->links[pipeline->stage_count];
+    if (pipeline->current) {
+        elegant_pipe_give(last->spare, pipeline->current);
+        pipeline->current = NULL;
+    }
+
+    elegant_array_t* chunk = elegant_pipe_take(last->full);
+    if (!chunk || __atomic_load_n(&pipeline->error, __ATOMIC_ACQUIRE)) {
+        elegant_pipeline_finish(pipeline);
+        return NULL;
+    }
+    /* The caller may have written through the previous lend; restore the buffer */
+    chunk->data = last->buffer + (size_t)(chunk - last->chunks) * pipeline->chunk_length * last->element_size;
+    pipeline->current = chunk;
+    return chunk;
+}
+
+int elegant_pipeline_drain(elegant_pipeline_t* pipeline,
+                           int (*sink)(void* ctx, elegant_array_t* chunk), void* ctx) {
+    if (!pipeline) return EINVAL;
+
+    elegant_array_t* chunk;
+    while ((chunk = elegant_pipeline_next(pipeline)) != NULL) {
+        int err = sink ? sink(ctx, chunk) : 0;
+        if (err) {
+            elegant_pipeline_stop(pipeline, err);
+            elegant_pipeline_finish(pipeline);
+        }
+    }
+    return elegant_pipeline_error(pipeline);
+}
+
+static int elegant_pipe_write_fd(void* ctx, elegant_array_t* chunk) {
+    int fd = *(int*)ctx;
+    const char* data = chunk->data;
+    size_t left = chunk->length * chunk->element_size;
+
+    while (left > 0) {
+        ssize_t n = write(fd, data, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        data += n;
+        left -= (size_t)n;
+    }
+    return 0;
+}
+
+int elegant_pipeline_drain_fd(elegant_pipeline_t* pipeline, int fd) {
+    if (fd < 0) return EINVAL;
+    return elegant_pipeline_drain(pipeline, elegant_pipe_write_fd, &fd);
+}
+
+static int elegant_pipe_collect_sink(void* ctx, elegant_array_t* chunk) {
+    return elegant_builder_extend(ctx, chunk->data, chunk->length);
+}
+
+elegant_array_t* elegant_pipeline_collect(elegant_pipeline_t* pipeline) {
+    if (!pipeline) return NULL;
+
+    elegant_array_builder_t builder;
+    elegant_builder_init(&builder, elegant_pipeline_out_size(pipeline), 0);
+    if (elegant_pipeline_drain(pipeline, elegant_pipe_collect_sink, &builder) != 0) {
+        elegant_builder_discard(&builder);
+        return NULL;
+    }
+    return elegant_builder_finish(&builder);
+}
+
+int elegant_pipeline_error(const elegant_pipeline_t* pipeline) {
+    return pipeline ? __atomic_load_n(&pipeline->error, __ATOMIC_ACQUIRE) : EINVAL;
+}
+
+int elegant_pipeline_close(elegant_pipeline_t* pipeline) {
+    if (!pipeline) return EINVAL;
+
+    /* Stopping early is not an error of its own */
+    if (!pipeline->finished) {
+        elegant_pipeline_stop(pipeline, 0);
+        elegant_pipeline_finish(pipeline);
+    }
+    int err = pipeline->error;
+
+    if (pipeline->links) {
+        for (size_t i = 0; i <= pipeline->stage_count; i++) elegant_pipe_link_free(&pipeline->links[i]);
+    }
+    for (size_t i = 0; i < pipeline->stage_count; i++) {
+        if (pipeline->stages[i].owns_ctx) free(pipeline->stages[i].ctx);
+    }
+    elegant_stream_close(pipeline->source);
+    free(pipeline->links);
+    free(pipeline->threads);
+    free(pipeline->stages);
+    free(pipeline);
+    return err;
+}
@@ -0,0 +1,99 @@
+/*
+ * Elegant - Associative Reductions
+ * Blocks of ELEGANT_REDUCE_BLOCK elements reduce independently, as pairwise
+ * trees or as interleaved chains, and their partials meet in a pairwise
+ * tree in index order.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+
+#define ELEGANT_REDUCE_BLOCK ((size_t)4096)
+#define ELEGANT_REDUCE_LEAF 16           /* runs this short fold left directly */
+#define ELEGANT_REDUCE_CHAINS 4
+
+#define ELEGANT_DEFINE_ASSOC_REDUCE(T, sfx) \
+    /* n >= 1; recursion depth is log2(BLOCK / LEAF) */ \
+    static T elegant_pairwise_##sfx(const T* data, size_t n, T (*func)(T, T)) { \
+        if (n <= ELEGANT_REDUCE_LEAF) { \
+            T acc = data[0]; \
+            for (size_t i = 1; i < n; i++) acc = func(acc, data[i]); \
+            return acc; \
+        } \
+        size_t half = n / 2; \
+        return func(elegant_pairwise_##sfx(data, half, func), \
+                    elegant_pairwise_##sfx(data + half, n - half, func)); \
+    } \
+    \
+    /* Chain k folds elements k, k + CHAINS, ...; combining them reorders elements */ \
+    static T elegant_chains_##sfx(const T* data, size_t n, T (*func)(T, T)) { \
+        if (n < 2 * ELEGANT_REDUCE_CHAINS) return elegant_pairwise_##sfx(data, n, func); \
+        T a0 = data[0], a1 = data[1], a2 = data[2], a3 = data[3]; \
+        size_t i = ELEGANT_REDUCE_CHAINS; \
+        for (; i + ELEGANT_REDUCE_CHAINS <= n; i += ELEGANT_REDUCE_CHAINS) { \
+            a0 = func(a0, data[i]); \
+            a1 = func(a1, data[i + 1]); \
+            a2 = func(a2, data[i + 2]); \
+            a3 = func(a3, data[i + 3]); \
+        } \
+        for (; i < n; i++) a0 = func(a0, data[i]); \
+        return func(func(a0, a1), func(a2, a3)); \
+    } \
+    \
+    typedef struct { \
+        const T* data; \
+        size_t length; \
+        T (*func)(T, T); \
+        unsigned flags; \
+        T* partials; \
+    } elegant_assoc_##sfx##_ctx_t; \
+    \
+    static void elegant_assoc_##sfx##_block(void* arg, size_t block) { \
+        elegant_assoc_##sfx##_ctx_t* ctx = arg; \
+        size_t first = block * ELEGANT_REDUCE_BLOCK; \
+        size_t count = ctx->length - first < ELEGANT_REDUCE_BLOCK ? ctx->length - first : ELEGANT_REDUCE_BLOCK; \
+        ctx->partials[block] = (ctx->flags & ELEGANT_REDUCE_COMMUTATIVE) \
+            ? elegant_chains_##sfx(ctx->data + first, count, ctx->func) \
+            : elegant_pairwise_##sfx(ctx->data + first, count, ctx->func); \
+    } \
+    \
+    T elegant_reduce_assoc_##sfx(elegant_array_t* src, T (*func)(T, T), T initial, unsigned flags) { \
+        if (!(flags & ELEGANT_REDUCE_ASSOCIATIVE)) return elegant_reduce_##sfx(src, func, initial); \
+        if (!src || !func) return initial; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (!data || len == 0) return initial; \
+        \
+        size_t blocks = (len + ELEGANT_REDUCE_BLOCK - 1) / ELEGANT_REDUCE_BLOCK; \
+        T local; \
+        T* partials = blocks == 1 ? &local : malloc(blocks * sizeof(T)); \
+        /* The left fold is always a valid evaluation */ \
+        if (!partials) return elegant_reduce_##sfx(src, func, initial); \
+        elegant_assoc_##sfx##_ctx_t ctx = { data, len, func, flags, partials }; \
+        if (len < ELEGANT_REDUCE_PARALLEL_MIN || \
+            elegant_parallel_for(blocks, elegant_assoc_##sfx##_block, &ctx) != 0) { \
+            for (size_t b = 0; b < blocks; b++) elegant_assoc_##sfx##_block(&ctx, b); \
+        } \
+        for (size_t step = 1; step < blocks; step *= 2) { \
+            for (size_t b = 0; b + step < blocks; b += 2 * step) { \
+                partials[b] = func(partials[b], partials[b + step]); \
+            } \
+        } \
+        T result = func(initial, partials[0]); \
+        if (partials != &local) free(partials); \
+        elegant_stats_end(&probe, ELEGANT_OP_REDUCE, len); \
+        return result; \
+    }
+
+ELEGANT_DEFINE_ASSOC_REDUCE(int, int)
+ELEGANT_DEFINE_ASSOC_REDUCE(float, float)
+ELEGANT_DEFINE_ASSOC_REDUCE(double, double)
+
+/* Through void* callbacks the pool's block reduction is already a pairwise tree */
+void* elegant_reduce_assoc_generic(elegant_array_t* src, void* (*func)(void*, void*), void* initial,
+                                   size_t element_size, unsigned flags) {
+    if (!(flags & ELEGANT_REDUCE_ASSOCIATIVE)) return elegant_reduce_generic(src, func, initial, element_size);
+    return elegant_par_reduce_generic(src, func, initial, element_size);
+}
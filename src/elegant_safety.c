@@ -3,6 +3,8 @@
  * Provides comprehensive protection against memory corruption vulnerabilities
  */
 
+#define _POSIX_C_SOURCE 200112L  /* posix_memalign, mprotect, sched_yield */
+
 #include "../inc/elegant.h"
 #include "../inc/elegant_safety.h"
 #include <stdlib.h>
@@ -12,31 +14,83 @@
 #include <sys/mman.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 
 /* Global safety statistics */
 elegant_safety_stats_t elegant_safety_stats = {0};
 
-/* Allocation tracking list */
-static elegant_memory_header_t* allocation_list = NULL;
-static pthread_mutex_t allocation_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*
+ * Allocation tracking: blocks are linked into one of several lists chosen
+ * by header address, each under its own lock. Lookups never walk a list;
+ * the header sits at a fixed offset before the user pointer and points
+ * back at itself.
+ */
+#define ELEGANT_ALLOCATION_SHARDS 64
+
+typedef struct {
+    pthread_mutex_t lock;
+    elegant_memory_header_t* head;
+} __attribute__((aligned(ELEGANT_CACHE_LINE_SIZE))) elegant_allocation_shard_t;
+
+static elegant_allocation_shard_t allocation_shards[ELEGANT_ALLOCATION_SHARDS] = {
+    [0 ... ELEGANT_ALLOCATION_SHARDS - 1] = { PTHREAD_MUTEX_INITIALIZER, NULL }
+};
+
+/*
+ * Quarantine: freed blocks are held back in a FIFO ring instead of going
+ * straight to free(), so stale pointers keep pointing at poisoned (and
+ * optionally inaccessible) memory. Membership is tracked in a lock-free
+ * hash set of one-cache-line buckets; removal just clears a slot, so there
+ * are no tombstones and a miss costs a single bucket scan.
+ */
+#define QUARANTINE_BUCKET_SLOTS (ELEGANT_CACHE_LINE_SIZE / sizeof(void*))
+#define QUARANTINE_BUCKETS (ELEGANT_QUARANTINE_CAPACITY / 2)   /* 4x the slots needed */
+#define QUARANTINE_PROBE 4                                      /* buckets tried on overflow */
+#define QUARANTINE_FLUSHING (SIZE_MAX / 2)                      /* turn offset while flushing */
+#define QUARANTINE_SPINS 64                                     /* pauses before a wait yields */
+#define QUARANTINE_DRAIN_WAITS 256                              /* waits for readers before protecting */
+
+ELEGANT_STATIC_ASSERT((ELEGANT_QUARANTINE_CAPACITY & (ELEGANT_QUARANTINE_CAPACITY - 1)) == 0 &&
+                      ELEGANT_QUARANTINE_CAPACITY >= 2);
+
+typedef struct {
+    void* slots[QUARANTINE_BUCKET_SLOTS];
+} __attribute__((aligned(ELEGANT_CACHE_LINE_SIZE))) quarantine_bucket_t;
+
+static quarantine_bucket_t quarantine_set[QUARANTINE_BUCKETS];
+static uint32_t quarantine_overflow[QUARANTINE_BUCKETS];   /* entries homed here but stored later */
+
+/* Ring slots are handed out by ticket; `turn` orders reuse across laps */
+typedef struct {
+    size_t turn;
+    void* ptr;
+    void* raw;
+    size_t bytes;
+    bool protected_block;
+} quarantine_slot_t;
 
-/* Simple freed pointers cache for use-after-free detection */
-#define FREED_CACHE_SIZE 1024
-static void* freed_pointers[FREED_CACHE_SIZE] = {0};
-static int freed_cache_index = 0;
+static quarantine_slot_t quarantine_ring[ELEGANT_QUARANTINE_CAPACITY];
+static size_t quarantine_ticket = 0;
+static bool quarantine_protect = false;
+
+/*
+ * Lookups currently reading a block header. A lookup that missed the set
+ * just before a free inserted the block may still read its header, so a
+ * block is only protected once no lookup is in flight.
+ */
+static size_t quarantine_readers = 0;
 
 /* Helper functions */
 static uint32_t calculate_checksum(const void* data, size_t size);
+static bool quarantine_contains(const void* ptr);
 static void add_to_allocation_list(elegant_memory_header_t* header);
 static void remove_from_allocation_list(elegant_memory_header_t* header);
-static elegant_memory_header_t* find_header_for_ptr_unlocked(const void* ptr);
 static elegant_memory_header_t* find_header_for_ptr(const void* ptr);
 static bool elegant_check_canaries_unlocked(elegant_memory_header_t* header);
 static bool elegant_validate_pointer_unlocked(const void* ptr, elegant_memory_header_t* header);
 
-static uint32_t calculate_checksum(const void* data, size_t size) {
+uint32_t elegant_checksum(uint32_t checksum, const void* data, size_t size) {
     const uint8_t* bytes = (const uint8_t*)data;
-    uint32_t checksum = 0;
     for (size_t i = 0; i < size; i++) {
         checksum ^= bytes[i];
         checksum = (checksum << 1) | (checksum >> 31);
@@ -44,64 +98,266 @@ static uint32_t calculate_checksum(const void* data, size_t size) {
     return checksum;
 }
 
+static uint32_t calculate_checksum(const void* data, size_t size) {
+    return elegant_checksum(0, data, size);
+}
+
+static inline elegant_allocation_shard_t* shard_for_header(const elegant_memory_header_t* header) {
+    uint64_t key = (uint64_t)(uintptr_t)header >> 4;
+    return &allocation_shards[(key * 0x9E3779B97F4A7C15ULL) >> 58];
+}
+
 static void add_to_allocation_list(elegant_memory_header_t* header) {
-    pthread_mutex_lock(&allocation_mutex);
-    if (allocation_list) {
-        allocation_list->prev = header;
+    elegant_allocation_shard_t* shard = shard_for_header(header);
+    pthread_mutex_lock(&shard->lock);
+    if (shard->head) {
+        shard->head->prev = header;
     }
-    header->next = allocation_list;
+    header->next = shard->head;
     header->prev = NULL;
-    allocation_list = header;
-    pthread_mutex_unlock(&allocation_mutex);
+    shard->head = header;
+    pthread_mutex_unlock(&shard->lock);
 }
 
 static void remove_from_allocation_list(elegant_memory_header_t* header) {
-    pthread_mutex_lock(&allocation_mutex);
+    elegant_allocation_shard_t* shard = shard_for_header(header);
+    pthread_mutex_lock(&shard->lock);
     if (header->prev) {
         header->prev->next = header->next;
     } else {
-        allocation_list = header->next;
+        shard->head = header->next;
     }
     if (header->next) {
         header->next->prev = header->prev;
     }
-    pthread_mutex_unlock(&allocation_mutex);
+    header->next = NULL;
+    header->prev = NULL;
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/* Bytes obtained from the allocator for a block with `size` user bytes */
+static inline size_t block_bytes(size_t size) {
+    size_t total_size = sizeof(elegant_memory_header_t) + size + sizeof(elegant_memory_footer_t);
+    
+    // Align to page boundary for guard pages
+    size_t aligned_size = (total_size + ELEGANT_GUARD_PAGE_SIZE - 1) & ~(size_t)(ELEGANT_GUARD_PAGE_SIZE - 1);
+    return aligned_size + ELEGANT_GUARD_PAGE_SIZE;
+}
+
+/*
+ * O(1) lookup: read the header just before ptr. Only pointers returned by
+ * elegant_safe_malloc carry a header whose original_ptr refers to itself;
+ * the magic and canaries are checked separately to report corruption.
+ * Callers read the header between quarantine_read_begin and _end.
+ */
+static elegant_memory_header_t* find_header_for_ptr(const void* ptr) {
+    if (!ptr || ((uintptr_t)ptr & (sizeof(void*) - 1))) return NULL;
+    
+    /* Quarantined headers may be inaccessible */
+    if (quarantine_contains(ptr)) return NULL;
+    
+    elegant_memory_header_t* header = (elegant_memory_header_t*)
+        ((char*)ptr - sizeof(elegant_memory_header_t));
+    if (header->original_ptr != (void*)header) return NULL;
+    
+    return header;
+}
+
+static inline size_t quarantine_home(const void* ptr) {
+    uint64_t key = (uint64_t)(uintptr_t)ptr >> 4;
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (QUARANTINE_BUCKETS - 1);
+}
+
+static bool quarantine_insert(void* ptr) {
+    size_t home = quarantine_home(ptr);
+    for (size_t probe = 0; probe < QUARANTINE_PROBE; probe++) {
+        quarantine_bucket_t* bucket = &quarantine_set[(home + probe) & (QUARANTINE_BUCKETS - 1)];
+        for (size_t i = 0; i < QUARANTINE_BUCKET_SLOTS; i++) {
+            void* expected = NULL;
+            if (__atomic_load_n(&bucket->slots[i], __ATOMIC_RELAXED) == NULL &&
+                __atomic_compare_exchange_n(&bucket->slots[i], &expected, ptr, false,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+                if (probe > 0) __atomic_fetch_add(&quarantine_overflow[home], 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-static elegant_memory_header_t* find_header_for_ptr_unlocked(const void* ptr) {
-    if (!ptr) return NULL;
+static void quarantine_remove(void* ptr) {
+    size_t home = quarantine_home(ptr);
+    for (size_t probe = 0; probe < QUARANTINE_PROBE; probe++) {
+        quarantine_bucket_t* bucket = &quarantine_set[(home + probe) & (QUARANTINE_BUCKETS - 1)];
+        for (size_t i = 0; i < QUARANTINE_BUCKET_SLOTS; i++) {
+            void* expected = ptr;
+            if (__atomic_compare_exchange_n(&bucket->slots[i], &expected, NULL, false,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+                if (probe > 0) __atomic_fetch_sub(&quarantine_overflow[home], 1, __ATOMIC_RELEASE);
+                return;
+            }
+        }
+        if (__atomic_load_n(&quarantine_overflow[home], __ATOMIC_ACQUIRE) == 0) return;
+    }
+}
+
+static bool quarantine_contains(const void* ptr) {
+    if (!ptr) return false;
     
-    elegant_memory_header_t* current = allocation_list;
-    while (current) {
-        void* user_ptr = (char*)current + sizeof(elegant_memory_header_t);
-        if (user_ptr == ptr) {
-            return current;
+    size_t home = quarantine_home(ptr);
+    for (size_t probe = 0; probe < QUARANTINE_PROBE; probe++) {
+        const quarantine_bucket_t* bucket = &quarantine_set[(home + probe) & (QUARANTINE_BUCKETS - 1)];
+        for (size_t i = 0; i < QUARANTINE_BUCKET_SLOTS; i++) {
+            if (__atomic_load_n(&bucket->slots[i], __ATOMIC_ACQUIRE) == ptr) return true;
         }
-        current = current->next;
+        if (__atomic_load_n(&quarantine_overflow[home], __ATOMIC_ACQUIRE) == 0) return false;
     }
-    return NULL;
+    return false;
 }
 
-static elegant_memory_header_t* find_header_for_ptr(const void* ptr) {
-    if (!ptr) return NULL;
+/*
+ * Actually hand a block back to the allocator. The block is made readable
+ * before `ptr` leaves the set, so a lookup that misses the set never reads
+ * a protected header. Pass NULL for a block that was never inserted.
+ */
+static void quarantine_release(void* ptr, void* raw, size_t bytes, bool protected_block) {
+    if (protected_block) {
+        mprotect(raw, bytes, PROT_READ | PROT_WRITE);
+    }
+    if (ptr) {
+        quarantine_remove(ptr);
+    }
+    free(raw);
+}
+
+/* Spin briefly, then give the CPU away */
+static void quarantine_wait(unsigned* waits) {
+    if (*waits < QUARANTINE_SPINS) {
+        (*waits)++;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+        return;
+    }
+    sched_yield();
+}
+
+/* Entered before the set is checked and left once the header is no longer read */
+static inline void quarantine_read_begin(void) {
+    __atomic_fetch_add(&quarantine_readers, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void quarantine_read_end(void) {
+    __atomic_fetch_sub(&quarantine_readers, 1, __ATOMIC_RELEASE);
+}
+
+/* False if lookups kept running; the caller then leaves the block readable */
+static bool quarantine_readers_drain(void) {
+    unsigned waits = 0;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (unsigned i = 0; __atomic_load_n(&quarantine_readers, __ATOMIC_ACQUIRE) != 0; i++) {
+        if (i == QUARANTINE_DRAIN_WAITS) return false;
+        quarantine_wait(&waits);
+    }
+    return true;
+}
+
+/* Park a freed block; evicts and releases the oldest one once the ring is full */
+static void quarantine_push(void* ptr, void* raw, size_t bytes) {
+    if (!quarantine_insert(ptr)) {
+        /* Neighbourhood full: too many colliding entries, skip the quarantine */
+        quarantine_release(NULL, raw, bytes, false);
+        return;
+    }
+    
+    /*
+     * Protect only once lookups see the block as quarantined and none that
+     * started earlier is still reading it. Otherwise, or if mprotect
+     * fails, the block stays quarantined but readable.
+     */
+    bool protected_block = false;
+    if (__atomic_load_n(&quarantine_protect, __ATOMIC_RELAXED) &&
+        ((uintptr_t)raw & (ELEGANT_GUARD_PAGE_SIZE - 1)) == 0 && quarantine_readers_drain()) {
+        protected_block = mprotect(raw, bytes, PROT_NONE) == 0;
+    }
+    
+    size_t ticket = __atomic_fetch_add(&quarantine_ticket, 1, __ATOMIC_RELAXED);
+    quarantine_slot_t* slot = &quarantine_ring[ticket & (ELEGANT_QUARANTINE_CAPACITY - 1)];
+    size_t lap = ticket / ELEGANT_QUARANTINE_CAPACITY;
+    
+    /* Only waits if another free is still using this slot one lap behind */
+    unsigned waits = 0;
+    while (__atomic_load_n(&slot->turn, __ATOMIC_ACQUIRE) != lap) {
+        quarantine_wait(&waits);
+    }
+    
+    void* evicted = slot->ptr;
+    void* evicted_raw = slot->raw;
+    size_t evicted_bytes = slot->bytes;
+    bool evicted_protected = slot->protected_block;
     
-    pthread_mutex_lock(&allocation_mutex);
-    elegant_memory_header_t* result = find_header_for_ptr_unlocked(ptr);
-    pthread_mutex_unlock(&allocation_mutex);
-    return result;
+    slot->ptr = ptr;
+    slot->raw = raw;
+    slot->bytes = bytes;
+    slot->protected_block = protected_block;
+    __atomic_store_n(&slot->turn, lap + 1, __ATOMIC_RELEASE);
+    
+    if (evicted) {
+        quarantine_release(evicted, evicted_raw, evicted_bytes, evicted_protected);
+    }
+}
+
+void elegant_safety_set_quarantine_protect(bool enabled) {
+    __atomic_store_n(&quarantine_protect, enabled, __ATOMIC_RELAXED);
+}
+
+void elegant_safety_flush_quarantine(void) {
+    size_t end = __atomic_load_n(&quarantine_ticket, __ATOMIC_ACQUIRE);
+    size_t start = end > ELEGANT_QUARANTINE_CAPACITY ? end - ELEGANT_QUARANTINE_CAPACITY : 0;
+    
+    for (size_t ticket = start; ticket < end; ticket++) {
+        quarantine_slot_t* slot = &quarantine_ring[ticket & (ELEGANT_QUARANTINE_CAPACITY - 1)];
+        size_t lap = ticket / ELEGANT_QUARANTINE_CAPACITY;
+        
+        /* Wait for the slot's pending push, then lock it one lap ahead */
+        size_t expected = lap + 1;
+        while (!__atomic_compare_exchange_n(&slot->turn, &expected, lap + 1 + QUARANTINE_FLUSHING,
+                                            false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            if (expected > lap + 1) break;   /* already reused by a later lap */
+            expected = lap + 1;
+        }
+        if (expected != lap + 1) continue;
+        
+        void* ptr = slot->ptr;
+        void* raw = slot->raw;
+        size_t bytes = slot->bytes;
+        bool protected_block = slot->protected_block;
+        slot->ptr = NULL;
+        slot->raw = NULL;
+        __atomic_store_n(&slot->turn, lap + 1, __ATOMIC_RELEASE);
+        
+        if (ptr) {
+            quarantine_release(ptr, raw, bytes, protected_block);
+        }
+    }
 }
 
 /* Safe memory allocation */
 void* elegant_safe_malloc(size_t size) {
     if (size == 0) return NULL;
     
-    size_t total_size = sizeof(elegant_memory_header_t) + size + sizeof(elegant_memory_footer_t);
-    
-    // Align to page boundary for guard pages
-    size_t aligned_size = (total_size + ELEGANT_GUARD_PAGE_SIZE - 1) & ~(ELEGANT_GUARD_PAGE_SIZE - 1);
+    if (size > SIZE_MAX - 2 * ELEGANT_GUARD_PAGE_SIZE - sizeof(elegant_memory_header_t) -
+               sizeof(elegant_memory_footer_t)) {
+        errno = ENOMEM;
+        return NULL;
+    }
     
-    void* raw_ptr = malloc(aligned_size + ELEGANT_GUARD_PAGE_SIZE);
-    if (!raw_ptr) {
+    // Page-aligned so a quarantined block can be made inaccessible
+    void* raw_ptr = NULL;
+    if (posix_memalign(&raw_ptr, ELEGANT_GUARD_PAGE_SIZE, block_bytes(size)) != 0) {
         return NULL;
     }
     
@@ -159,7 +415,10 @@ void* elegant_safe_realloc(void* ptr, size_t size) {
         return NULL;
     }
     
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
+    size_t old_size = header ? header->size : 0;
+    quarantine_read_end();
     if (!header) {
         fprintf(stderr, "ERROR: realloc() called on invalid pointer\n");
         __sync_fetch_and_add(&elegant_safety_stats.corruption_detected, 1);
@@ -176,7 +435,7 @@ void* elegant_safe_realloc(void* ptr, size_t size) {
         return NULL;
     }
     
-    size_t copy_size = (size < header->size) ? size : header->size;
+    size_t copy_size = (size < old_size) ? size : old_size;
     memcpy(new_ptr, ptr, copy_size);
     
     elegant_safe_free(ptr);
@@ -186,8 +445,16 @@ void* elegant_safe_realloc(void* ptr, size_t size) {
 void elegant_safe_free(void* ptr) {
     if (!ptr) return;
     
+    if (quarantine_contains(ptr)) {
+        fprintf(stderr, "ERROR: Double-free detected at %p\n", ptr);
+        __sync_fetch_and_add(&elegant_safety_stats.double_free_detected, 1);
+        return;
+    }
+    
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
     if (!header) {
+        quarantine_read_end();
         fprintf(stderr, "ERROR: free() called on invalid pointer %p\n", ptr);
         __sync_fetch_and_add(&elegant_safety_stats.corruption_detected, 1);
         return;
@@ -195,39 +462,41 @@ void elegant_safe_free(void* ptr) {
     
     // Check for double-free
     if (header->flags & ELEGANT_MEM_FREED) {
+        quarantine_read_end();
         fprintf(stderr, "ERROR: Double-free detected at %p\n", ptr);
         __sync_fetch_and_add(&elegant_safety_stats.double_free_detected, 1);
         return;
     }
     
     // Validate canaries
-    if (!elegant_check_canaries(ptr)) {
+    if (!elegant_check_canaries_unlocked(header)) {
+        quarantine_read_end();
         fprintf(stderr, "ERROR: Buffer overflow detected at %p\n", ptr);
         __sync_fetch_and_add(&elegant_safety_stats.buffer_overflow_detected, 1);
         return;
     }
     
-    // Mark as freed and add to freed cache for use-after-free detection
+    // Mark as freed for use-after-free detection
     header->flags |= ELEGANT_MEM_FREED;
     header->flags &= ~ELEGANT_MEM_ACTIVE;
     
-    // Add to freed pointers cache
-    freed_pointers[freed_cache_index] = ptr;
-    freed_cache_index = (freed_cache_index + 1) % FREED_CACHE_SIZE;
-    
     // Poison the memory
     memset(ptr, 0xDD, header->size);  // Dead memory pattern
     
     // Remove from tracking list
     remove_from_allocation_list(header);
     
+    size_t size = header->size;
+    void* raw = header->original_ptr;
+    quarantine_read_end();
+    
     // Update statistics
     __sync_fetch_and_add(&elegant_safety_stats.total_freed, 1);
     __sync_fetch_and_sub(&elegant_safety_stats.active_allocations, 1);
-    __sync_fetch_and_add(&elegant_safety_stats.bytes_freed, header->size);
+    __sync_fetch_and_add(&elegant_safety_stats.bytes_freed, size);
     
-    // Actually free the memory
-    free(header->original_ptr);
+    // Hold the block in quarantine; it is released once evicted
+    quarantine_push(ptr, raw, block_bytes(size));
 }
 
 /* Internal validation function that doesn't lock mutex */
@@ -253,19 +522,26 @@ static bool elegant_validate_pointer_unlocked(const void* ptr, elegant_memory_he
 bool elegant_validate_pointer(const void* ptr) {
     if (!ptr) return false;
     
-    elegant_memory_header_t* header = find_header_for_ptr(ptr);
-    if (!header) return false;
+    if (quarantine_contains(ptr)) {
+        __sync_fetch_and_add(&elegant_safety_stats.use_after_free_detected, 1);
+        return false;
+    }
     
-    return elegant_validate_pointer_unlocked(ptr, header);
+    quarantine_read_begin();
+    elegant_memory_header_t* header = find_header_for_ptr(ptr);
+    bool valid = header && elegant_validate_pointer_unlocked(ptr, header);
+    quarantine_read_end();
+    return valid;
 }
 
 bool elegant_validate_buffer(const void* ptr, size_t size) {
     if (!elegant_validate_pointer(ptr)) return false;
     
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
-    if (!header) return false;
-    
-    return size <= header->size;
+    bool fits = header && size <= header->size;
+    quarantine_read_end();
+    return fits;
 }
 
 /* Internal canary check that doesn't lock mutex */
@@ -295,10 +571,11 @@ static bool elegant_check_canaries_unlocked(elegant_memory_header_t* header) {
 bool elegant_check_canaries(const void* ptr) {
     if (!ptr) return false;
     
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
-    if (!header) return false;
-    
-    return elegant_check_canaries_unlocked(header);
+    bool intact = header && elegant_check_canaries_unlocked(header);
+    quarantine_read_end();
+    return intact;
 }
 
 bool elegant_detect_corruption(const void* ptr) {
@@ -359,11 +636,11 @@ void* elegant_safe_memcpy(void* dest, const void* src, size_t size) {
 bool elegant_bounds_check(const void* ptr, size_t index, size_t element_size) {
     if (!ptr) return false;
     
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
-    if (!header) return false;
-    
-    size_t offset = index * element_size;
-    return offset < header->size;
+    bool inside = header && index * element_size < header->size;
+    quarantine_read_end();
+    return inside;
 }
 
 void elegant_bounds_violation(const char* file, int line, size_t index) {
@@ -395,44 +672,47 @@ void elegant_safety_report(void) {
 
 void elegant_dump_active_allocations(void) {
     printf("\n=== ACTIVE ALLOCATIONS ===\n");
-    pthread_mutex_lock(&allocation_mutex);
-    
-    elegant_memory_header_t* current = allocation_list;
     int count = 0;
     
-    while (current) {
-        if (current->flags & ELEGANT_MEM_ACTIVE) {
-            void* user_ptr = (char*)current + sizeof(elegant_memory_header_t);
-            printf("Allocation %d: %p (size: %zu bytes)\n", 
-                   ++count, user_ptr, current->size);
+    for (size_t i = 0; i < ELEGANT_ALLOCATION_SHARDS; i++) {
+        elegant_allocation_shard_t* shard = &allocation_shards[i];
+        pthread_mutex_lock(&shard->lock);
+        
+        for (elegant_memory_header_t* current = shard->head; current; current = current->next) {
+            if (current->flags & ELEGANT_MEM_ACTIVE) {
+                void* user_ptr = (char*)current + sizeof(elegant_memory_header_t);
+                printf("Allocation %d: %p (size: %zu bytes)\n", 
+                       ++count, user_ptr, current->size);
+            }
         }
-        current = current->next;
+        
+        pthread_mutex_unlock(&shard->lock);
     }
     
-    pthread_mutex_unlock(&allocation_mutex);
     printf("Total active: %d allocations\n", count);
     printf("========================\n\n");
 }
 
 void elegant_check_all_allocations(void) {
-    pthread_mutex_lock(&allocation_mutex);
-    
-    elegant_memory_header_t* current = allocation_list;
     int corrupted = 0;
     
-    while (current) {
-        if (current->flags & ELEGANT_MEM_ACTIVE) {
-            void* user_ptr = (char*)current + sizeof(elegant_memory_header_t);
-            if (!elegant_validate_pointer_unlocked(user_ptr, current)) {
-                corrupted++;
-                printf("CORRUPTION: Block at %p is corrupted\n", user_ptr);
+    for (size_t i = 0; i < ELEGANT_ALLOCATION_SHARDS; i++) {
+        elegant_allocation_shard_t* shard = &allocation_shards[i];
+        pthread_mutex_lock(&shard->lock);
+        
+        for (elegant_memory_header_t* current = shard->head; current; current = current->next) {
+            if (current->flags & ELEGANT_MEM_ACTIVE) {
+                void* user_ptr = (char*)current + sizeof(elegant_memory_header_t);
+                if (!elegant_validate_pointer_unlocked(user_ptr, current)) {
+                    corrupted++;
+                    printf("CORRUPTION: Block at %p is corrupted\n", user_ptr);
+                }
             }
         }
-        current = current->next;
+        
+        pthread_mutex_unlock(&shard->lock);
     }
     
-    pthread_mutex_unlock(&allocation_mutex);
-    
     if (corrupted == 0) {
         printf("All active allocations are valid.\n");
     } else {
@@ -441,80 +721,468 @@ void elegant_check_all_allocations(void) {
 }
 
 /* Memory pool safety implementation */
-elegant_safe_pool_t* elegant_create_safe_pool(size_t size) {
+
+/* run_class markers besides the slot class index */
+#define POOL_RUN_FREE  0xFF   /* not carved, or part of a released span */
+#define POOL_RUN_LARGE 0xFE   /* first run of a multi-run block */
+#define POOL_RUN_CONT  0xFD   /* later run of a multi-run block */
+
+/* Multi-run blocks start with this header; released spans reuse it */
+typedef struct pool_span {
+    size_t runs;
+    struct pool_span* next;
+} pool_span_t;
+
+ELEGANT_STATIC_ASSERT(sizeof(pool_span_t) % ELEGANT_POOL_ALIGN == 0);
+
+static inline size_t pool_class_size(size_t cls) {
+    return (size_t)ELEGANT_POOL_ALIGN << cls;
+}
+
+static inline size_t pool_class_for(size_t bytes) {
+    size_t cls = 0;
+    while (pool_class_size(cls) < bytes) cls++;
+    return cls;
+}
+
+static inline size_t pool_granule(const elegant_safe_pool_t* pool, const void* ptr) {
+    return (size_t)((const char*)ptr - (const char*)pool->base) / ELEGANT_POOL_ALIGN;
+}
+
+static inline bool pool_bit_test(const elegant_safe_pool_t* pool, size_t granule) {
+    return (pool->allocation_map[granule / 8] >> (granule % 8)) & 1u;
+}
+
+static inline void pool_bit_flip(elegant_safe_pool_t* pool, size_t granule) {
+    pool->allocation_map[granule / 8] ^= (uint8_t)(1u << (granule % 8));
+}
+
+static inline bool pool_valid(const elegant_safe_pool_t* pool) {
+    return pool && pool->canary == ELEGANT_CANARY_MAGIC_1;
+}
+
+/* Blocks below the innermost mark are held back instead of reused */
+static inline const char* pool_floor(const elegant_safe_pool_t* pool) {
+    return (const char*)pool->base + (pool->mark_count ? pool->marks[pool->mark_count - 1] : 0);
+}
+
+static void* pool_carve_runs(elegant_safe_pool_t* pool, size_t runs) {
+    if (runs > (pool->size - pool->used) / ELEGANT_POOL_RUN_SIZE) return NULL;
+    void* start = (char*)pool->base + pool->used;
+    pool->used += runs * ELEGANT_POOL_RUN_SIZE;
+    return start;
+}
+
+/* Split a run into equal slots and push them so the lowest comes out first */
+static bool pool_refill_class(elegant_safe_pool_t* pool, size_t cls) {
+    char* run = pool_carve_runs(pool, 1);
+    if (!run) return false;
+    
+    pool->run_class[(size_t)(run - (char*)pool->base) / ELEGANT_POOL_RUN_SIZE] = (uint8_t)cls;
+    
+    size_t slot_size = pool_class_size(cls);
+    for (size_t offset = ELEGANT_POOL_RUN_SIZE; offset >= slot_size; offset -= slot_size) {
+        void* slot = run + offset - slot_size;
+        *(void**)slot = pool->free_slots[cls];
+        pool->free_slots[cls] = slot;
+    }
+    return true;
+}
+
+/* Next reusable slot of a class; slots freed before the innermost mark move to the held list */
+static void* pool_take_slot(elegant_safe_pool_t* pool, size_t cls) {
+    const char* floor = pool_floor(pool);
+    void* slot;
+    while ((slot = pool->free_slots[cls]) && (const char*)slot < floor) {
+        pool->free_slots[cls] = *(void**)slot;
+        *(void**)slot = pool->held_slots[cls];
+        pool->held_slots[cls] = slot;
+    }
+    if (slot) pool->free_slots[cls] = *(void**)slot;
+    return slot;
+}
+
+/* First fit over released spans, splitting off any surplus */
+static pool_span_t* pool_take_span(elegant_safe_pool_t* pool, size_t runs) {
+    const char* floor = pool_floor(pool);
+    pool_span_t** link = (pool_span_t**)&pool->free_spans;
+    pool_span_t* span;
+    while ((span = *link)) {
+        if ((const char*)span < floor) {
+            /* Freed before the innermost mark: held until it is rewound */
+            *link = span->next;
+            span->next = pool->held_spans;
+            pool->held_spans = span;
+            continue;
+        }
+        if (span->runs < runs) {
+            link = &span->next;
+            continue;
+        }
+        
+        if (span->runs > runs) {
+            pool_span_t* rest = (pool_span_t*)((char*)span + runs * ELEGANT_POOL_RUN_SIZE);
+            rest->runs = span->runs - runs;
+            rest->next = span->next;
+            *link = rest;
+        } else {
+            *link = span->next;
+        }
+        return span;
+    }
+    
+    return pool_carve_runs(pool, runs);
+}
+
+static inline uint64_t* pool_tail_canary(void* block_end) {
+    return (uint64_t*)((char*)block_end - sizeof(uint64_t));
+}
+
+/* Allocator entry points; blocks the pool cannot hold go to libc */
+static inline bool pool_owns(const elegant_safe_pool_t* pool, const void* ptr) {
+    const char* base = (const char*)pool->base;
+    return (const char*)ptr >= base && (const char*)ptr < base + pool->used;
+}
+
+/* Bytes available to the caller in a live block */
+static size_t pool_usable_size(const elegant_safe_pool_t* pool, const void* ptr) {
+    size_t guard = (pool->flags & ELEGANT_POOL_CANARIES) ? sizeof(uint64_t) : 0;
+    size_t run = (size_t)((const char*)ptr - (const char*)pool->base) / ELEGANT_POOL_RUN_SIZE;
+    uint8_t cls = pool->run_class[run];
+    
+    if (cls < ELEGANT_POOL_CLASSES) return pool_class_size(cls) - guard;
+    const pool_span_t* span = (const pool_span_t*)ptr - 1;
+    return span->runs * ELEGANT_POOL_RUN_SIZE - sizeof(pool_span_t) - guard;
+}
+
+static void* pool_allocator_alloc(void* ctx, size_t size) {
+    void* ptr = elegant_pool_alloc(ctx, size);
+    return ptr ? ptr : elegant_libc_allocator.alloc(NULL, size);
+}
+
+static void* pool_allocator_alloc_aligned(void* ctx, size_t size, size_t alignment) {
+    elegant_safe_pool_t* pool = ctx;
+    size_t guard = (pool->flags & ELEGANT_POOL_CANARIES) ? sizeof(uint64_t) : 0;
+    void* ptr = NULL;
+    
+    /* Slots are aligned to their class size; large spans only to the granule */
+    if (alignment <= ELEGANT_POOL_ALIGN) {
+        ptr = elegant_pool_alloc(pool, size);
+    } else if (alignment <= ELEGANT_POOL_MAX_SLOT && size <= ELEGANT_POOL_MAX_SLOT - guard) {
+        ptr = elegant_pool_alloc(pool, (size > alignment ? size : alignment - guard));
+    }
+    return ptr ? ptr : elegant_libc_allocator.alloc_aligned(NULL, size, alignment);
+}
+
+static void* pool_allocator_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    elegant_safe_pool_t* pool = ctx;
+    if (!pool_owns(pool, ptr)) {
+        return elegant_libc_allocator.realloc(NULL, ptr, old_size, new_size);
+    }
+    
+    size_t usable = pool_usable_size(pool, ptr);
+    if (new_size <= usable) return ptr;
+    
+    void* fresh = pool_allocator_alloc(pool, new_size);
+    if (!fresh) return NULL;
+    memcpy(fresh, ptr, usable);
+    elegant_pool_free(pool, ptr);
+    return fresh;
+}
+
+static void pool_allocator_free(void* ctx, void* ptr, size_t size) {
+    elegant_safe_pool_t* pool = ctx;
+    if (pool_owns(pool, ptr)) {
+        elegant_pool_free(pool, ptr);
+    } else {
+        elegant_libc_allocator.free(NULL, ptr, size);
+    }
+}
+
+elegant_safe_pool_t* elegant_create_safe_pool_ex(size_t size, unsigned int flags) {
+    size_t reserve = (ELEGANT_POOL_CLASSES + 1) * ELEGANT_POOL_RUN_SIZE;
+    if (size == 0 || size > SIZE_MAX - 2 * reserve) return NULL;
+    
+    /* Round up, and leave room for one partly used run per size class */
+    size = ((size + ELEGANT_POOL_RUN_SIZE - 1) & ~(size_t)(ELEGANT_POOL_RUN_SIZE - 1)) +
+           (ELEGANT_POOL_CLASSES - 1) * ELEGANT_POOL_RUN_SIZE;
+    
     elegant_safe_pool_t* pool = elegant_safe_malloc(sizeof(elegant_safe_pool_t));
     if (!pool) return NULL;
     
-    pool->base = elegant_safe_malloc(size);
-    if (!pool->base) {
+    size_t runs = size / ELEGANT_POOL_RUN_SIZE;
+    size_t granules = size / ELEGANT_POOL_ALIGN;
+    
+    pool->region = elegant_safe_malloc(size + ELEGANT_POOL_RUN_SIZE);
+    pool->run_class = elegant_safe_malloc(runs);
+    pool->allocation_map = elegant_safe_malloc((granules + 7) / 8);
+    if (!pool->region || !pool->run_class || !pool->allocation_map) {
+        elegant_safe_free(pool->allocation_map);
+        elegant_safe_free(pool->run_class);
+        elegant_safe_free(pool->region);
         elegant_safe_free(pool);
         return NULL;
     }
     
+    pool->base = (void*)(((uintptr_t)pool->region + ELEGANT_POOL_RUN_SIZE - 1) &
+                         ~(uintptr_t)(ELEGANT_POOL_RUN_SIZE - 1));
     pool->size = size;
-    pool->used = 0;
+    pool->flags = flags;
     pool->canary = ELEGANT_CANARY_MAGIC_1;
+    pool->allocator = (elegant_allocator_t){
+        pool_allocator_alloc, NULL, pool_allocator_alloc_aligned,
+        pool_allocator_realloc, pool_allocator_free, pool
+    };
+    elegant_pool_reset(pool);
     
-    // Create allocation bitmap
-    size_t map_size = (size / 8) + 1;  // One bit per 8 bytes
-    pool->allocation_map = elegant_safe_malloc(map_size);
-    if (!pool->allocation_map) {
-        elegant_safe_free(pool->base);
-        elegant_safe_free(pool);
-        return NULL;
-    }
-    
-    memset(pool->allocation_map, 0, map_size);
     return pool;
 }
 
+elegant_safe_pool_t* elegant_create_safe_pool(size_t size) {
+    return elegant_create_safe_pool_ex(size, 0);
+}
+
 void* elegant_pool_alloc(elegant_safe_pool_t* pool, size_t size) {
-    if (!pool || pool->canary != ELEGANT_CANARY_MAGIC_1) {
+    if (!pool_valid(pool) || size == 0) {
         return NULL;
     }
     
-    if (pool->used + size > pool->size) {
-        return NULL;  // Pool exhausted
+    size_t guard = (pool->flags & ELEGANT_POOL_CANARIES) ? sizeof(uint64_t) : 0;
+    if (size > pool->size) {
+        return NULL;  // Can never fit
+    }
+    size_t need = size + guard;
+    
+    void* ptr;
+    void* block_end;
+    
+    if (need <= ELEGANT_POOL_MAX_SLOT) {
+        size_t cls = pool_class_for(need);
+        ptr = pool_take_slot(pool, cls);
+        if (!ptr && (!pool_refill_class(pool, cls) || !(ptr = pool_take_slot(pool, cls)))) {
+            return NULL;  // Pool exhausted
+        }
+        
+        block_end = (char*)ptr + pool_class_size(cls);
+    } else {
+        size_t runs = (need + sizeof(pool_span_t) + ELEGANT_POOL_RUN_SIZE - 1) / ELEGANT_POOL_RUN_SIZE;
+        pool_span_t* span = pool_take_span(pool, runs);
+        if (!span) {
+            return NULL;  // Pool exhausted
+        }
+        
+        size_t first = (size_t)((char*)span - (char*)pool->base) / ELEGANT_POOL_RUN_SIZE;
+        pool->run_class[first] = POOL_RUN_LARGE;
+        memset(pool->run_class + first + 1, POOL_RUN_CONT, runs - 1);
+        
+        span->runs = runs;
+        span->next = NULL;
+        ptr = span + 1;
+        block_end = (char*)span + runs * ELEGANT_POOL_RUN_SIZE;
     }
     
-    void* ptr = (char*)pool->base + pool->used;
-    pool->used += size;
+    if (guard) {
+        *pool_tail_canary(block_end) = ELEGANT_CANARY_MAGIC_2;
+    }
     
+    pool_bit_flip(pool, pool_granule(pool, ptr));
+    pool->live_allocations++;
     return ptr;
 }
 
 void elegant_pool_free(elegant_safe_pool_t* pool, void* ptr) {
-    // For simplicity, pool free is a no-op in this implementation
-    // Could be enhanced to track individual allocations
-    (void)pool;
-    (void)ptr;
+    if (!ptr || !pool_valid(pool)) return;
+    
+    char* p = (char*)ptr;
+    char* base = (char*)pool->base;
+    if (p < base || p >= base + pool->used) {
+        fprintf(stderr, "ERROR: Pool free of pointer %p outside the pool\n", ptr);
+        __sync_fetch_and_add(&elegant_safety_stats.corruption_detected, 1);
+        return;
+    }
+    
+    size_t offset = (size_t)(p - base);
+    size_t run = offset / ELEGANT_POOL_RUN_SIZE;
+    uint8_t cls = pool->run_class[run];
+    size_t block_size;
+    
+    if (cls < ELEGANT_POOL_CLASSES) {
+        block_size = pool_class_size(cls);
+        if ((offset % ELEGANT_POOL_RUN_SIZE) % block_size != 0) cls = POOL_RUN_FREE;
+    } else if (cls == POOL_RUN_LARGE && offset % ELEGANT_POOL_RUN_SIZE == sizeof(pool_span_t)) {
+        block_size = ((pool_span_t*)(p - sizeof(pool_span_t)))->runs * ELEGANT_POOL_RUN_SIZE;
+    } else {
+        cls = POOL_RUN_FREE;
+        block_size = 0;
+    }
+    
+    size_t granule = pool_granule(pool, ptr);
+    if (cls == POOL_RUN_FREE || !pool_bit_test(pool, granule)) {
+        fprintf(stderr, "ERROR: Double-free or invalid pool free at %p\n", ptr);
+        __sync_fetch_and_add(&elegant_safety_stats.double_free_detected, 1);
+        return;
+    }
+    
+    char* block = cls == POOL_RUN_LARGE ? p - sizeof(pool_span_t) : p;
+    if ((pool->flags & ELEGANT_POOL_CANARIES) &&
+        *pool_tail_canary(block + block_size) != ELEGANT_CANARY_MAGIC_2) {
+        fprintf(stderr, "ERROR: Buffer overflow detected in pool block %p\n", ptr);
+        __sync_fetch_and_add(&elegant_safety_stats.buffer_overflow_detected, 1);
+    }
+    
+    pool_bit_flip(pool, granule);
+    pool->live_allocations--;
+    
+    /* A block from before the innermost mark stays unused until it is rewound */
+    bool held = block < pool_floor(pool);
+    if (cls < ELEGANT_POOL_CLASSES) {
+        void** list = held ? &pool->held_slots[cls] : &pool->free_slots[cls];
+        memset(p, 0xDD, block_size);  // Dead memory pattern
+        *(void**)p = *list;
+        *list = p;
+    } else {
+        pool_span_t* span = (pool_span_t*)block;
+        void** list = held ? &pool->held_spans : &pool->free_spans;
+        memset(pool->run_class + run, POOL_RUN_FREE, span->runs);
+        span->next = *list;
+        *list = span;
+    }
+}
+
+void elegant_pool_reset(elegant_safe_pool_t* pool) {
+    if (!pool_valid(pool)) return;
+    
+    pool->used = 0;
+    pool->live_allocations = 0;
+    pool->mark_count = 0;
+    pool->free_spans = NULL;
+    pool->held_spans = NULL;
+    memset(pool->free_slots, 0, sizeof(pool->free_slots));
+    memset(pool->held_slots, 0, sizeof(pool->held_slots));
+    memset(pool->run_class, POOL_RUN_FREE, pool->size / ELEGANT_POOL_RUN_SIZE);
+    memset(pool->allocation_map, 0, (pool->size / ELEGANT_POOL_ALIGN + 7) / 8);
+}
+
+size_t elegant_pool_mark(elegant_safe_pool_t* pool) {
+    if (!pool_valid(pool)) return SIZE_MAX;
+    if (pool->mark_count == ELEGANT_POOL_MARKS) {
+        fprintf(stderr, "Elegant: Pool already has %d active marks\n", ELEGANT_POOL_MARKS);
+        return SIZE_MAX;
+    }
+    
+    pool->marks[pool->mark_count++] = pool->used;
+    return pool->used;
+}
+
+/* Forget free and held slots and spans at or past `limit` */
+static void pool_drop_free_from(elegant_safe_pool_t* pool, const char* limit) {
+    for (size_t cls = 0; cls < ELEGANT_POOL_CLASSES; cls++) {
+        void** lists[2] = { &pool->free_slots[cls], &pool->held_slots[cls] };
+        for (size_t i = 0; i < 2; i++) {
+            void** link = lists[i];
+            while (*link) {
+                if ((const char*)*link >= limit) *link = *(void**)*link;
+                else link = (void**)*link;
+            }
+        }
+    }
+    pool_span_t** spans[2] = { (pool_span_t**)&pool->free_spans, (pool_span_t**)&pool->held_spans };
+    for (size_t i = 0; i < 2; i++) {
+        for (pool_span_t** link = spans[i]; *link; ) {
+            if ((const char*)*link >= limit) *link = (*link)->next;
+            else link = &(*link)->next;
+        }
+    }
+}
+
+/* Make held blocks at or past the (new) innermost mark reusable again */
+static void pool_release_held(elegant_safe_pool_t* pool) {
+    const char* floor = pool_floor(pool);
+    for (size_t cls = 0; cls < ELEGANT_POOL_CLASSES; cls++) {
+        void** link = &pool->held_slots[cls];
+        while (*link) {
+            void* slot = *link;
+            if ((const char*)slot < floor) {
+                link = (void**)slot;
+                continue;
+            }
+            *link = *(void**)slot;
+            *(void**)slot = pool->free_slots[cls];
+            pool->free_slots[cls] = slot;
+        }
+    }
+    for (pool_span_t** link = (pool_span_t**)&pool->held_spans; *link; ) {
+        pool_span_t* span = *link;
+        if ((const char*)span < floor) {
+            link = &span->next;
+            continue;
+        }
+        *link = span->next;
+        span->next = pool->free_spans;
+        pool->free_spans = span;
+    }
+}
+
+void elegant_pool_rewind(elegant_safe_pool_t* pool, size_t mark) {
+    if (!pool_valid(pool)) return;
+    
+    /* The innermost active mark with this offset; later marks end with it */
+    size_t depth = pool->mark_count;
+    while (depth > 0 && pool->marks[depth - 1] != mark) depth--;
+    if (depth == 0) return;
+    pool->mark_count = depth - 1;
+    
+    /* Everything allocated since sits past the mark and is dropped with it */
+    pool_drop_free_from(pool, (const char*)pool->base + mark);
+    if (mark < pool->used) {
+        /* The run boundary is byte aligned in the bitmap */
+        size_t first_byte = mark / ELEGANT_POOL_ALIGN / 8;
+        size_t map_bytes = (pool->size / ELEGANT_POOL_ALIGN + 7) / 8;
+        for (size_t i = first_byte; i < map_bytes; i++) {
+            pool->live_allocations -= (size_t)__builtin_popcount(pool->allocation_map[i]);
+            pool->allocation_map[i] = 0;
+        }
+        
+        memset(pool->run_class + mark / ELEGANT_POOL_RUN_SIZE, POOL_RUN_FREE,
+               (pool->used - mark) / ELEGANT_POOL_RUN_SIZE);
+        pool->used = mark;
+    }
+    
+    pool_release_held(pool);
+}
+
+const elegant_allocator_t* elegant_pool_allocator(elegant_safe_pool_t* pool) {
+    return pool_valid(pool) ? &pool->allocator : NULL;
+}
+
+void elegant_set_array_pool(elegant_safe_pool_t* pool) {
+    elegant_set_allocator(elegant_pool_allocator(pool));
+}
+
+elegant_safe_pool_t* elegant_get_array_pool(void) {
+    const elegant_allocator_t* allocator = elegant_get_allocator();
+    return allocator->alloc == pool_allocator_alloc ? allocator->ctx : NULL;
 }
 
 void elegant_destroy_safe_pool(elegant_safe_pool_t* pool) {
     if (!pool) return;
     
     elegant_safe_free(pool->allocation_map);
-    elegant_safe_free(pool->base);
+    elegant_safe_free(pool->run_class);
+    elegant_safe_free(pool->region);
     elegant_safe_free(pool);
 }
 
 /* Use-after-free detection helpers */
 void elegant_mark_freed(void* ptr) {
+    quarantine_read_begin();
     elegant_memory_header_t* header = find_header_for_ptr(ptr);
     if (header) {
         header->flags |= ELEGANT_MEM_FREED;
     }
+    quarantine_read_end();
 }
 
 bool elegant_is_freed_pointer(const void* ptr) {
-    if (!ptr) return false;
-    
-    // Check freed cache first
-    for (int i = 0; i < FREED_CACHE_SIZE; i++) {
-        if (freed_pointers[i] == ptr) {
-            return true;
-        }
-    }
-    
-    return false;
+    return quarantine_contains(ptr);
 }
@@ -0,0 +1,209 @@
+/*
+ * Elegant - Binary Array Serialization
+ * A fixed header and a raw, alignment-padded payload: streams move the
+ * payload with writev/readv, files are mapped in place.
+ */
+
+#define _POSIX_C_SOURCE 200112L  /* sysconf */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+ELEGANT_STATIC_ASSERT(sizeof(elegant_serial_header_t) == 64);
+ELEGANT_STATIC_ASSERT(sizeof(ELEGANT_SERIAL_MAGIC) - 1 == 8);
+
+/* Upper bound on one readv/writev, so huge payloads move in steady chunks */
+#define ELEGANT_SERIAL_CHUNK (8 * 1024 * 1024)
+
+/* Source of the zero padding between header and payload */
+static const uint8_t elegant_serial_padding[ELEGANT_SERIAL_FILE_ALIGN];
+
+/* Move every byte described by iov, resuming after short transfers and EINTR */
+static int elegant_serial_transfer(int fd, struct iovec* iov, int count, bool writing) {
+    for (;;) {
+        while (count > 0 && iov->iov_len == 0) {
+            iov++;
+            count--;
+        }
+        if (count == 0) return 0;
+        
+        struct iovec step[4];
+        size_t budget = ELEGANT_SERIAL_CHUNK;
+        int steps = 0;
+        for (int i = 0; i < count && steps < 4 && budget > 0; i++) {
+            size_t len = iov[i].iov_len < budget ? iov[i].iov_len : budget;
+            step[steps].iov_base = iov[i].iov_base;
+            step[steps].iov_len = len;
+            budget -= len;
+            steps++;
+        }
+        
+        ssize_t done = writing ? writev(fd, step, steps) : readv(fd, step, steps);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (done == 0) return EIO;  /* unexpected end of stream */
+        
+        size_t left = (size_t)done;
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+static int elegant_serial_emit(int fd, elegant_array_t* arr, unsigned int flags, size_t align) {
+    if (fd < 0 || !arr) return EINVAL;
+    
+    size_t length = elegant_array_get_length(arr);
+    const void* data = elegant_array_get_data(arr);
+    if (length > 0 && !data) return ENOMEM;
+    size_t bytes = length * arr->element_size;
+    
+    elegant_serial_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ELEGANT_SERIAL_MAGIC, sizeof(header.magic));
+    header.version = ELEGANT_SERIAL_VERSION;
+    header.flags = flags & ELEGANT_SERIAL_CHECKSUM;
+    header.element_size = arr->element_size;
+    header.length = length;
+    header.payload_offset = align;
+    header.byte_order = ELEGANT_SERIAL_BYTE_ORDER;
+    if (header.flags & ELEGANT_SERIAL_CHECKSUM) {
+        header.checksum = elegant_checksum(0, data, bytes);
+    }
+    
+    struct iovec iov[3] = {
+        { &header, sizeof(header) },
+        { (void*)elegant_serial_padding, align - sizeof(header) },
+        { (void*)data, bytes }
+    };
+    return elegant_serial_transfer(fd, iov, 3, true);
+}
+
+int elegant_array_write(int fd, elegant_array_t* arr, unsigned int flags) {
+    return elegant_serial_emit(fd, arr, flags, ELEGANT_SERIAL_STREAM_ALIGN);
+}
+
+int elegant_array_save(const char* path, elegant_array_t* arr, unsigned int flags) {
+    if (!path) return EINVAL;
+    
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return errno;
+    
+    int err = elegant_serial_emit(fd, arr, flags, ELEGANT_SERIAL_FILE_ALIGN);
+    if (close(fd) != 0 && err == 0) err = errno;
+    if (err) unlink(path);
+    return err;
+}
+
+static elegant_array_t* elegant_serial_fail(int err, const char* reason) {
+    fprintf(stderr, "Elegant: Cannot load array: %s\n", reason);
+    errno = err;
+    return NULL;
+}
+
+/* Read and sanity-check a header; NULL reason means it is usable */
+static const char* elegant_serial_read_header(int fd, elegant_serial_header_t* header, int* err) {
+    struct iovec iov = { header, sizeof(*header) };
+    if ((*err = elegant_serial_transfer(fd, &iov, 1, false)) != 0) return "short header";
+    
+    *err = EINVAL;
+    if (memcmp(header->magic, ELEGANT_SERIAL_MAGIC, sizeof(header->magic)) != 0) return "bad magic";
+    if (header->version == 0 || header->version > ELEGANT_SERIAL_VERSION) return "unsupported version";
+    if (header->byte_order != ELEGANT_SERIAL_BYTE_ORDER) return "foreign byte order";
+    if (header->element_size == 0 || header->element_size > SIZE_MAX ||
+        header->length > SIZE_MAX / header->element_size) return "bad element size or length";
+    if (header->payload_offset < sizeof(*header) ||
+        header->payload_offset > ELEGANT_SERIAL_FILE_ALIGN) return "bad payload offset";
+    
+    *err = 0;
+    return NULL;
+}
+
+static bool elegant_serial_checksum_ok(const elegant_serial_header_t* header, const void* data) {
+    if (!(header->flags & ELEGANT_SERIAL_CHECKSUM)) return true;
+    return elegant_checksum(0, data, header->length * header->element_size) == header->checksum;
+}
+
+/* Payload straight from the fd into a fresh array, after the header */
+static elegant_array_t* elegant_serial_read_payload(int fd, const elegant_serial_header_t* header) {
+    size_t length = (size_t)header->length;
+    elegant_array_t* arr = elegant_array_create_uninit((size_t)header->element_size, length);
+    if (!arr) return elegant_serial_fail(ENOMEM, "out of memory");
+    
+    uint8_t skip[ELEGANT_SERIAL_FILE_ALIGN];
+    struct iovec iov[2] = {
+        { skip, (size_t)header->payload_offset - sizeof(*header) },
+        { arr->data, length * arr->element_size }
+    };
+    int err = elegant_serial_transfer(fd, iov, 2, false);
+    if (err || !elegant_serial_checksum_ok(header, arr->data)) {
+        elegant_array_destroy(arr);
+        return elegant_serial_fail(err ? err : EILSEQ, err ? "truncated payload" : "checksum mismatch");
+    }
+    return arr;
+}
+
+elegant_array_t* elegant_array_read(int fd) {
+    elegant_serial_header_t header;
+    int err;
+    const char* reason = elegant_serial_read_header(fd, &header, &err);
+    if (reason) return elegant_serial_fail(err, reason);
+    return elegant_serial_read_payload(fd, &header);
+}
+
+elegant_array_t* elegant_array_load(const char* path, unsigned int flags) {
+    if (!path) return elegant_serial_fail(EINVAL, "no path");
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Elegant: Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    
+    elegant_serial_header_t header;
+    int err;
+    const char* reason = elegant_serial_read_header(fd, &header, &err);
+    if (reason) {
+        close(fd);
+        return elegant_serial_fail(err, reason);
+    }
+    
+    size_t bytes = (size_t)(header.length * header.element_size);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    struct stat st;
+    bool mappable = !(flags & ELEGANT_LOAD_COPY) && bytes > 0 &&
+                    header.payload_offset % page == 0 && fstat(fd, &st) == 0;
+    
+    elegant_array_t* arr;
+    if (mappable) {
+        /* Mapping past the end of the file would fault on first touch */
+        if ((uint64_t)st.st_size < header.payload_offset + bytes) {
+            close(fd);
+            return elegant_serial_fail(EIO, "truncated payload");
+        }
+        arr = elegant_array_map_fd(fd, (size_t)header.payload_offset,
+                                   (size_t)header.element_size, (size_t)header.length, 0);
+        if (arr && (flags & ELEGANT_LOAD_VERIFY) && !elegant_serial_checksum_ok(&header, arr->data)) {
+            elegant_array_destroy(arr);
+            arr = elegant_serial_fail(EILSEQ, "checksum mismatch");
+        }
+    } else {
+        arr = elegant_serial_read_payload(fd, &header);
+    }
+    
+    close(fd);
+    return arr;
+}
@@ -0,0 +1,562 @@
+/*
+ * Elegant - Vectorized Primitive Kernels
+ * Each kernel set is written once over GCC vector extensions and
+ * instantiated per instruction set; the widest supported set is picked
+ * at runtime.
+ */
+
+#include "elegant.h"
+#include <stdint.h>
+#include <pthread.h>
+
+ELEGANT_STATIC_ASSERT(sizeof(int) == sizeof(int32_t));
+
+/* Kernel dispatch table */
+typedef struct {
+    int (*sum_i32)(const int*, size_t);
+    float (*sum_f32)(const float*, size_t);
+    double (*sum_f64)(const double*, size_t);
+    int (*min_i32)(const int*, size_t, int);
+    float (*min_f32)(const float*, size_t, float);
+    double (*min_f64)(const double*, size_t, double);
+    int (*max_i32)(const int*, size_t, int);
+    float (*max_f32)(const float*, size_t, float);
+    double (*max_f64)(const double*, size_t, double);
+    void (*scale_i32)(int*, const int*, size_t, int);
+    void (*scale_f32)(float*, const float*, size_t, float);
+    void (*scale_f64)(double*, const double*, size_t, double);
+    void (*add_i32)(int*, const int*, size_t, int);
+    void (*add_f32)(float*, const float*, size_t, float);
+    void (*add_f64)(double*, const double*, size_t, double);
+    size_t (*filter_i32)(int*, const int*, size_t, elegant_cmp_op_t, int);
+    size_t (*filter_f32)(float*, const float*, size_t, elegant_cmp_op_t, float);
+    size_t (*filter_f64)(double*, const double*, size_t, elegant_cmp_op_t, double);
+    float (*ksum_f32)(const float*, size_t, float*);
+    double (*ksum_f64)(const double*, size_t, double*);
+} elegant_simd_kernels_t;
+
+/* Scalar reference kernels */
+
+static int scalar_sum_i32(const int* data, size_t n) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < n; i++) total += (uint32_t)data[i];
+    return (int)total;
+}
+
+#define ELEGANT_SCALAR_SUM(name, T) \
+    static T scalar_##name(const T* data, size_t n) { \
+        T total = 0; \
+        for (size_t i = 0; i < n; i++) total += data[i]; \
+        return total; \
+    }
+
+/*
+ * Neumaier's compensated add: c collects what s + x rounded away, so s + c
+ * carries the sum to about twice the working precision.
+ */
+#define ELEGANT_NEUMAIER_ADD(T, s, c, x) do { \
+        T _x = (x), _t = (s) + _x; \
+        T _abs_s = (s) < 0 ? -(s) : (s), _abs_x = _x < 0 ? -_x : _x; \
+        (c) += _abs_s >= _abs_x ? ((s) - _t) + _x : (_x - _t) + (s); \
+        (s) = _t; \
+    } while (0)
+
+/* Compensated sums return the rounded sum and leave its correction in *error */
+#define ELEGANT_SCALAR_KSUM(name, T) \
+    static T scalar_##name(const T* data, size_t n, T* error) { \
+        T total = 0, c = 0; \
+        for (size_t i = 0; i < n; i++) ELEGANT_NEUMAIER_ADD(T, total, c, data[i]); \
+        *error = c; \
+        return total; \
+    }
+
+#define ELEGANT_SCALAR_PICK(name, T, CMP) \
+    static T scalar_##name(const T* data, size_t n, T initial) { \
+        T result = initial; \
+        for (size_t i = 0; i < n; i++) { \
+            if (data[i] CMP result) result = data[i]; \
+        } \
+        return result; \
+    }
+
+#define ELEGANT_SCALAR_MAP(name, T, ET, OP) \
+    static void scalar_##name(T* dst, const T* src, size_t n, T k) { \
+        for (size_t i = 0; i < n; i++) dst[i] = (T)((ET)src[i] OP (ET)k); \
+    }
+
+#define ELEGANT_FILTER_TAIL(CMP) \
+    for (; i < n; i++) { \
+        dst[count] = src[i]; \
+        count += (src[i] CMP k); \
+    }
+
+#define ELEGANT_FILTER_SWITCH(LOOP) \
+    switch (op) { \
+        case ELEGANT_CMP_LT: LOOP(<); break; \
+        case ELEGANT_CMP_LE: LOOP(<=); break; \
+        case ELEGANT_CMP_GT: LOOP(>); break; \
+        case ELEGANT_CMP_GE: LOOP(>=); break; \
+        case ELEGANT_CMP_EQ: LOOP(==); break; \
+        case ELEGANT_CMP_NE: LOOP(!=); break; \
+    }
+
+#define ELEGANT_SCALAR_FILTER(name, T) \
+    static size_t scalar_##name(T* dst, const T* src, size_t n, elegant_cmp_op_t op, T k) { \
+        size_t i = 0, count = 0; \
+        ELEGANT_FILTER_SWITCH(ELEGANT_FILTER_TAIL) \
+        return count; \
+    }
+
+ELEGANT_SCALAR_SUM(sum_f32, float)
+ELEGANT_SCALAR_SUM(sum_f64, double)
+ELEGANT_SCALAR_PICK(min_i32, int, <)
+ELEGANT_SCALAR_PICK(min_f32, float, <)
+ELEGANT_SCALAR_PICK(min_f64, double, <)
+ELEGANT_SCALAR_PICK(max_i32, int, >)
+ELEGANT_SCALAR_PICK(max_f32, float, >)
+ELEGANT_SCALAR_PICK(max_f64, double, >)
+ELEGANT_SCALAR_MAP(scale_i32, int, uint32_t, *)
+ELEGANT_SCALAR_MAP(scale_f32, float, float, *)
+ELEGANT_SCALAR_MAP(scale_f64, double, double, *)
+ELEGANT_SCALAR_MAP(add_i32, int, uint32_t, +)
+ELEGANT_SCALAR_MAP(add_f32, float, float, +)
+ELEGANT_SCALAR_MAP(add_f64, double, double, +)
+ELEGANT_SCALAR_FILTER(filter_i32, int)
+ELEGANT_SCALAR_FILTER(filter_f32, float)
+ELEGANT_SCALAR_FILTER(filter_f64, double)
+ELEGANT_SCALAR_KSUM(ksum_f32, float)
+ELEGANT_SCALAR_KSUM(ksum_f64, double)
+
+static const elegant_simd_kernels_t elegant_kernels_scalar = {
+    scalar_sum_i32, scalar_sum_f32, scalar_sum_f64,
+    scalar_min_i32, scalar_min_f32, scalar_min_f64,
+    scalar_max_i32, scalar_max_f32, scalar_max_f64,
+    scalar_scale_i32, scalar_scale_f32, scalar_scale_f64,
+    scalar_add_i32, scalar_add_f32, scalar_add_f64,
+    scalar_filter_i32, scalar_filter_f32, scalar_filter_f64,
+    scalar_ksum_f32, scalar_ksum_f64
+};
+
+/*
+ * Vector kernels, parameterised by prefix, target attribute and register
+ * width in bytes. Unaligned loads and stores go through memcpy, which the
+ * compiler lowers to a single vector move.
+ */
+#define ELEGANT_VLOAD(v, p) memcpy(&(v), (p), sizeof(v))
+#define ELEGANT_VSTORE(p, v) memcpy((p), &(v), sizeof(v))
+
+#define ELEGANT_VECTOR_SUM_I32(sfx, ATTR, W) \
+    ATTR static int sfx##_sum_i32(const int* data, size_t n) { \
+        enum { L = W / sizeof(int) }; \
+        sfx##_vu32 a0 = {0}, a1 = {0}; \
+        size_t i = 0; \
+        for (; i + 2 * L <= n; i += 2 * L) { \
+            sfx##_vu32 x0, x1; \
+            ELEGANT_VLOAD(x0, data + i); \
+            ELEGANT_VLOAD(x1, data + i + L); \
+            a0 += x0; \
+            a1 += x1; \
+        } \
+        a0 += a1; \
+        uint32_t total = 0; \
+        for (size_t l = 0; l < L; l++) total += a0[l]; \
+        for (; i < n; i++) total += (uint32_t)data[i]; \
+        return (int)total; \
+    }
+
+/* Four independent accumulators hide the add latency */
+#define ELEGANT_VECTOR_SUM_F(sfx, ATTR, W, name, T, VT) \
+    ATTR static T sfx##_##name(const T* data, size_t n) { \
+        enum { L = W / sizeof(T) }; \
+        VT a0 = {0}, a1 = {0}, a2 = {0}, a3 = {0}; \
+        size_t i = 0; \
+        for (; i + 4 * L <= n; i += 4 * L) { \
+            VT x0, x1, x2, x3; \
+            ELEGANT_VLOAD(x0, data + i); \
+            ELEGANT_VLOAD(x1, data + i + L); \
+            ELEGANT_VLOAD(x2, data + i + 2 * L); \
+            ELEGANT_VLOAD(x3, data + i + 3 * L); \
+            a0 += x0; a1 += x1; a2 += x2; a3 += x3; \
+        } \
+        for (; i + L <= n; i += L) { \
+            VT x; \
+            ELEGANT_VLOAD(x, data + i); \
+            a0 += x; \
+        } \
+        a0 = (a0 + a1) + (a2 + a3); \
+        T total = 0; \
+        for (size_t l = 0; l < L; l++) total += a0[l]; \
+        for (; i < n; i++) total += data[i]; \
+        return total; \
+    }
+
+/* Kahan summation in every lane of two accumulators; the lanes fold together compensated */
+#define ELEGANT_VECTOR_KSUM_F(sfx, ATTR, W, name, T, VT) \
+    ATTR static T sfx##_##name(const T* data, size_t n, T* error) { \
+        enum { L = W / sizeof(T) }; \
+        VT s0 = {0}, s1 = {0}, c0 = {0}, c1 = {0}; \
+        size_t i = 0; \
+        for (; i + 2 * L <= n; i += 2 * L) { \
+            VT x0, x1; \
+            ELEGANT_VLOAD(x0, data + i); \
+            ELEGANT_VLOAD(x1, data + i + L); \
+            VT y0 = x0 - c0, y1 = x1 - c1; \
+            VT t0 = s0 + y0, t1 = s1 + y1; \
+            c0 = (t0 - s0) - y0; \
+            c1 = (t1 - s1) - y1; \
+            s0 = t0; \
+            s1 = t1; \
+        } \
+        T total = 0, c = 0; \
+        for (size_t l = 0; l < L; l++) { \
+            ELEGANT_NEUMAIER_ADD(T, total, c, s0[l]); \
+            ELEGANT_NEUMAIER_ADD(T, total, c, s1[l]); \
+            c -= c0[l] + c1[l]; \
+        } \
+        for (; i < n; i++) ELEGANT_NEUMAIER_ADD(T, total, c, data[i]); \
+        *error = c; \
+        return total; \
+    }
+
+/* Lane-wise select through the comparison mask keeps NaN handling scalar-equivalent */
+#define ELEGANT_VECTOR_PICK(sfx, ATTR, W, name, T, VT, VM, CMP) \
+    ATTR static T sfx##_##name(const T* data, size_t n, T initial) { \
+        enum { L = W / sizeof(T) }; \
+        VT best = (VT){0} + initial; \
+        size_t i = 0; \
+        for (; i + L <= n; i += L) { \
+            VT x; \
+            ELEGANT_VLOAD(x, data + i); \
+            VM m = (x CMP best); \
+            best = (VT)(((VM)x & m) | ((VM)best & ~m)); \
+        } \
+        T result = initial; \
+        for (size_t l = 0; l < L; l++) { \
+            if (best[l] CMP result) result = best[l]; \
+        } \
+        for (; i < n; i++) { \
+            if (data[i] CMP result) result = data[i]; \
+        } \
+        return result; \
+    }
+
+#define ELEGANT_VECTOR_MAP(sfx, ATTR, W, name, T, VT, ET, OP) \
+    ATTR static void sfx##_##name(T* dst, const T* src, size_t n, T k) { \
+        enum { L = W / sizeof(T) }; \
+        size_t i = 0; \
+        for (; i + L <= n; i += L) { \
+            VT x; \
+            ELEGANT_VLOAD(x, src + i); \
+            x = x OP (ET)k; \
+            ELEGANT_VSTORE(dst + i, x); \
+        } \
+        for (; i < n; i++) dst[i] = (T)((ET)src[i] OP (ET)k); \
+    }
+
+/*
+ * Compare a register of elements at once, skip it when nothing matched,
+ * otherwise compact the survivors with branchless stores. dst must have
+ * room for n elements.
+ */
+#define ELEGANT_VECTOR_FILTER(sfx, ATTR, name, T) \
+    ATTR static size_t sfx##_##name(T* dst, const T* src, size_t n, elegant_cmp_op_t op, T k) { \
+        size_t i = 0, count = 0; \
+        ELEGANT_FILTER_SWITCH(sfx##_FILTER_LOOP_##name) \
+        return count; \
+    }
+
+#define ELEGANT_VECTOR_FILTER_LOOP(sfx, T, VT, VM, CMP) \
+    do { \
+        enum { L = sizeof(VT) / sizeof(T) }; \
+        for (; i + L <= n; i += L) { \
+            VT x; \
+            ELEGANT_VLOAD(x, src + i); \
+            VM m = (x CMP k); \
+            sfx##_vu64 any = (sfx##_vu64)m; \
+            uint64_t hit = 0; \
+            for (size_t w = 0; w < sizeof(VT) / sizeof(uint64_t); w++) hit |= any[w]; \
+            if (!hit) continue; \
+            for (size_t l = 0; l < L; l++) { \
+                dst[count] = x[l]; \
+                count += (m[l] != 0); \
+            } \
+        } \
+        ELEGANT_FILTER_TAIL(CMP) \
+    } while (0)
+
+#define ELEGANT_DEFINE_VECTOR_KERNELS(sfx, ATTR, W) \
+    typedef uint32_t sfx##_vu32 __attribute__((vector_size(W))); \
+    typedef int32_t sfx##_vi32 __attribute__((vector_size(W))); \
+    typedef int64_t sfx##_vi64 __attribute__((vector_size(W))); \
+    typedef uint64_t sfx##_vu64 __attribute__((vector_size(W))); \
+    typedef float sfx##_vf32 __attribute__((vector_size(W))); \
+    typedef double sfx##_vf64 __attribute__((vector_size(W))); \
+    ELEGANT_VECTOR_SUM_I32(sfx, ATTR, W) \
+    ELEGANT_VECTOR_SUM_F(sfx, ATTR, W, sum_f32, float, sfx##_vf32) \
+    ELEGANT_VECTOR_SUM_F(sfx, ATTR, W, sum_f64, double, sfx##_vf64) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, min_i32, int, sfx##_vi32, sfx##_vi32, <) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, min_f32, float, sfx##_vf32, sfx##_vi32, <) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, min_f64, double, sfx##_vf64, sfx##_vi64, <) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, max_i32, int, sfx##_vi32, sfx##_vi32, >) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, max_f32, float, sfx##_vf32, sfx##_vi32, >) \
+    ELEGANT_VECTOR_PICK(sfx, ATTR, W, max_f64, double, sfx##_vf64, sfx##_vi64, >) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, scale_i32, int, sfx##_vu32, uint32_t, *) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, scale_f32, float, sfx##_vf32, float, *) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, scale_f64, double, sfx##_vf64, double, *) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, add_i32, int, sfx##_vu32, uint32_t, +) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, add_f32, float, sfx##_vf32, float, +) \
+    ELEGANT_VECTOR_MAP(sfx, ATTR, W, add_f64, double, sfx##_vf64, double, +) \
+    ELEGANT_VECTOR_FILTER(sfx, ATTR, filter_i32, int) \
+    ELEGANT_VECTOR_FILTER(sfx, ATTR, filter_f32, float) \
+    ELEGANT_VECTOR_FILTER(sfx, ATTR, filter_f64, double) \
+    ELEGANT_VECTOR_KSUM_F(sfx, ATTR, W, ksum_f32, float, sfx##_vf32) \
+    ELEGANT_VECTOR_KSUM_F(sfx, ATTR, W, ksum_f64, double, sfx##_vf64) \
+    static const elegant_simd_kernels_t elegant_kernels_##sfx = { \
+        sfx##_sum_i32, sfx##_sum_f32, sfx##_sum_f64, \
+        sfx##_min_i32, sfx##_min_f32, sfx##_min_f64, \
+        sfx##_max_i32, sfx##_max_f32, sfx##_max_f64, \
+        sfx##_scale_i32, sfx##_scale_f32, sfx##_scale_f64, \
+        sfx##_add_i32, sfx##_add_f32, sfx##_add_f64, \
+        sfx##_filter_i32, sfx##_filter_f32, sfx##_filter_f64, \
+        sfx##_ksum_f32, sfx##_ksum_f64 \
+    };
+
+/* Filter loop bodies bound to each prefix's vector types */
+#if defined(__x86_64__) || defined(__i386__)
+#define ELEGANT_SIMD_X86 1
+
+#define sse2_FILTER_LOOP_filter_i32(CMP) ELEGANT_VECTOR_FILTER_LOOP(sse2, int, sse2_vi32, sse2_vi32, CMP)
+#define sse2_FILTER_LOOP_filter_f32(CMP) ELEGANT_VECTOR_FILTER_LOOP(sse2, float, sse2_vf32, sse2_vi32, CMP)
+#define sse2_FILTER_LOOP_filter_f64(CMP) ELEGANT_VECTOR_FILTER_LOOP(sse2, double, sse2_vf64, sse2_vi64, CMP)
+#define avx2_FILTER_LOOP_filter_i32(CMP) ELEGANT_VECTOR_FILTER_LOOP(avx2, int, avx2_vi32, avx2_vi32, CMP)
+#define avx2_FILTER_LOOP_filter_f32(CMP) ELEGANT_VECTOR_FILTER_LOOP(avx2, float, avx2_vf32, avx2_vi32, CMP)
+#define avx2_FILTER_LOOP_filter_f64(CMP) ELEGANT_VECTOR_FILTER_LOOP(avx2, double, avx2_vf64, avx2_vi64, CMP)
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+ELEGANT_DEFINE_VECTOR_KERNELS(sse2, __attribute__((target("sse2"))), 16)
+ELEGANT_DEFINE_VECTOR_KERNELS(avx2, __attribute__((target("avx2"))), 32)
+#pragma GCC diagnostic pop
+
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define ELEGANT_SIMD_NEON 1
+
+#define neon_FILTER_LOOP_filter_i32(CMP) ELEGANT_VECTOR_FILTER_LOOP(neon, int, neon_vi32, neon_vi32, CMP)
+#define neon_FILTER_LOOP_filter_f32(CMP) ELEGANT_VECTOR_FILTER_LOOP(neon, float, neon_vf32, neon_vi32, CMP)
+#define neon_FILTER_LOOP_filter_f64(CMP) ELEGANT_VECTOR_FILTER_LOOP(neon, double, neon_vf64, neon_vi64, CMP)
+
+ELEGANT_DEFINE_VECTOR_KERNELS(neon, , 16)
+#endif
+
+/* Runtime selection */
+static elegant_simd_level_t elegant_simd_detected = ELEGANT_SIMD_SCALAR;
+static elegant_simd_level_t elegant_simd_current = ELEGANT_SIMD_SCALAR;
+static const elegant_simd_kernels_t* elegant_simd_active = &elegant_kernels_scalar;
+static pthread_once_t elegant_simd_once = PTHREAD_ONCE_INIT;
+
+static const elegant_simd_kernels_t* elegant_simd_table(elegant_simd_level_t level) {
+    switch (level) {
+#ifdef ELEGANT_SIMD_X86
+        case ELEGANT_SIMD_AVX2: return &elegant_kernels_avx2;
+        case ELEGANT_SIMD_SSE2: return &elegant_kernels_sse2;
+#endif
+#ifdef ELEGANT_SIMD_NEON
+        case ELEGANT_SIMD_NEON: return &elegant_kernels_neon;
+#endif
+        default: return &elegant_kernels_scalar;
+    }
+}
+
+static void elegant_simd_use(elegant_simd_level_t level) {
+    __atomic_store_n(&elegant_simd_current, level, __ATOMIC_RELAXED);
+    __atomic_store_n(&elegant_simd_active, elegant_simd_table(level), __ATOMIC_RELEASE);
+}
+
+static void elegant_simd_detect(void) {
+#ifdef ELEGANT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        elegant_simd_detected = ELEGANT_SIMD_AVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        elegant_simd_detected = ELEGANT_SIMD_SSE2;
+    }
+#elif defined(ELEGANT_SIMD_NEON)
+    elegant_simd_detected = ELEGANT_SIMD_NEON;
+#endif
+    elegant_simd_use(elegant_simd_detected);
+}
+
+static inline const elegant_simd_kernels_t* elegant_simd_kernels(void) {
+    pthread_once(&elegant_simd_once, elegant_simd_detect);
+    return __atomic_load_n(&elegant_simd_active, __ATOMIC_ACQUIRE);
+}
+
+elegant_simd_level_t elegant_simd_get_level(void) {
+    pthread_once(&elegant_simd_once, elegant_simd_detect);
+    return __atomic_load_n(&elegant_simd_current, __ATOMIC_RELAXED);
+}
+
+elegant_simd_level_t elegant_simd_set_level(elegant_simd_level_t level) {
+    pthread_once(&elegant_simd_once, elegant_simd_detect);
+    
+    /* Never select a kernel set the CPU cannot run */
+    if (elegant_simd_detected == ELEGANT_SIMD_NEON) {
+        level = (level == ELEGANT_SIMD_SCALAR) ? ELEGANT_SIMD_SCALAR : ELEGANT_SIMD_NEON;
+    } else if (level > elegant_simd_detected) {
+        level = elegant_simd_detected;
+    }
+    
+    elegant_simd_use(level);
+    return level;
+}
+
+const char* elegant_simd_level_name(elegant_simd_level_t level) {
+    switch (level) {
+        case ELEGANT_SIMD_SSE2: return "sse2";
+        case ELEGANT_SIMD_AVX2: return "avx2";
+        case ELEGANT_SIMD_NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+/* Public array-level entry points */
+
+#define ELEGANT_DEFINE_SUM(name, T, kernel, COMBINE) \
+    T name(elegant_array_t* src, T initial) { \
+        if (!src) return initial; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (!data || len == 0) return initial; \
+        T total = elegant_simd_kernels()->kernel(data, len); \
+        elegant_stats_end(&probe, ELEGANT_OP_SIMD_REDUCE, len); \
+        return COMBINE(initial, total); \
+    }
+
+#define ELEGANT_WRAPPING_ADD(a, b) ((int)((uint32_t)(a) + (uint32_t)(b)))
+#define ELEGANT_PLAIN_ADD(a, b) ((a) + (b))
+
+ELEGANT_DEFINE_SUM(elegant_sum_int, int, sum_i32, ELEGANT_WRAPPING_ADD)
+ELEGANT_DEFINE_SUM(elegant_sum_float, float, sum_f32, ELEGANT_PLAIN_ADD)
+ELEGANT_DEFINE_SUM(elegant_sum_double, double, sum_f64, ELEGANT_PLAIN_ADD)
+
+/*
+ * Compensated sums run the kernel over fixed ELEGANT_KSUM_BLOCK slices, on
+ * the pool when the array is large, and fold the partials in index order;
+ * the blocking doesn't depend on the thread count, so neither does the
+ * result. A non-finite total (an infinity cancels into NaN under Kahan)
+ * falls back to the plain sum.
+ */
+#define ELEGANT_KSUM_BLOCK ((size_t)64 * 1024)
+
+#define ELEGANT_DEFINE_KSUM(name, T, kernel, plain) \
+    typedef struct { \
+        const T* data; \
+        size_t length; \
+        T* sums; \
+        T* errors; \
+    } name##_ctx_t; \
+    static void name##_block(void* arg, size_t block) { \
+        name##_ctx_t* ctx = arg; \
+        size_t first = block * ELEGANT_KSUM_BLOCK; \
+        size_t count = ctx->length - first < ELEGANT_KSUM_BLOCK ? ctx->length - first : ELEGANT_KSUM_BLOCK; \
+        ctx->sums[block] = elegant_simd_kernels()->kernel(ctx->data + first, count, &ctx->errors[block]); \
+    } \
+    T name(elegant_array_t* src, T initial) { \
+        if (!src) return initial; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (!data || len == 0) return initial; \
+        size_t blocks = (len + ELEGANT_KSUM_BLOCK - 1) / ELEGANT_KSUM_BLOCK; \
+        T local[2]; \
+        T* partials = blocks == 1 ? local : malloc(2 * blocks * sizeof(T)); \
+        if (!partials) return plain(src, initial); \
+        name##_ctx_t ctx = { data, len, partials, partials + blocks }; \
+        if (len < ELEGANT_SUM_PARALLEL_MIN || elegant_parallel_for(blocks, name##_block, &ctx) != 0) { \
+            for (size_t b = 0; b < blocks; b++) name##_block(&ctx, b); \
+        } \
+        T total = initial, c = 0; \
+        for (size_t b = 0; b < blocks; b++) { \
+            ELEGANT_NEUMAIER_ADD(T, total, c, partials[b]); \
+            c += partials[blocks + b]; \
+        } \
+        if (partials != local) free(partials); \
+        T result = total + c; \
+        elegant_stats_end(&probe, ELEGANT_OP_SIMD_REDUCE, len); \
+        return result - result == 0 ? result : plain(src, initial); \
+    }
+
+ELEGANT_DEFINE_KSUM(elegant_sum_kahan_float, float, ksum_f32, elegant_sum_float)
+ELEGANT_DEFINE_KSUM(elegant_sum_kahan_double, double, ksum_f64, elegant_sum_double)
+
+#define ELEGANT_DEFINE_PICK(name, T, kernel) \
+    T name(elegant_array_t* src, T initial) { \
+        if (!src) return initial; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (!data || len == 0) return initial; \
+        T result = elegant_simd_kernels()->kernel(data, len, initial); \
+        elegant_stats_end(&probe, ELEGANT_OP_SIMD_REDUCE, len); \
+        return result; \
+    }
+
+ELEGANT_DEFINE_PICK(elegant_min_int, int, min_i32)
+ELEGANT_DEFINE_PICK(elegant_min_float, float, min_f32)
+ELEGANT_DEFINE_PICK(elegant_min_double, double, min_f64)
+ELEGANT_DEFINE_PICK(elegant_max_int, int, max_i32)
+ELEGANT_DEFINE_PICK(elegant_max_float, float, max_f32)
+ELEGANT_DEFINE_PICK(elegant_max_double, double, max_f64)
+
+#define ELEGANT_DEFINE_MAP(name, T, kernel) \
+    elegant_array_t* name(elegant_array_t* src, T k) { \
+        if (!src) return NULL; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (len > 0 && !data) return NULL; \
+        elegant_array_t* result = elegant_array_create_uninit(sizeof(T), len); \
+        if (!result) return NULL; \
+        if (len > 0) { \
+            elegant_simd_kernels()->kernel((T*)elegant_array_get_data(result), data, len, k); \
+        } \
+        elegant_stats_end(&probe, ELEGANT_OP_SIMD_MAP, len); \
+        return result; \
+    }
+
+ELEGANT_DEFINE_MAP(elegant_scale_int, int, scale_i32)
+ELEGANT_DEFINE_MAP(elegant_scale_float, float, scale_f32)
+ELEGANT_DEFINE_MAP(elegant_scale_double, double, scale_f64)
+ELEGANT_DEFINE_MAP(elegant_add_int, int, add_i32)
+ELEGANT_DEFINE_MAP(elegant_add_float, float, add_f32)
+ELEGANT_DEFINE_MAP(elegant_add_double, double, add_f64)
+
+/* Output is sized for the worst case, then trimmed */
+#define ELEGANT_DEFINE_FILTER(name, T, kernel) \
+    elegant_array_t* name(elegant_array_t* src, elegant_cmp_op_t op, T value) { \
+        if (!src) return NULL; \
+        elegant_array_advise_scan(src); \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        size_t len = elegant_array_get_length(src); \
+        const T* data = (const T*)elegant_array_get_data(src); \
+        if (len > 0 && !data) return NULL; \
+        elegant_array_t* result = elegant_array_create_output(sizeof(T), len); \
+        if (!result) return NULL; \
+        size_t count = 0; \
+        if (len > 0) { \
+            count = elegant_simd_kernels()->kernel( \
+                (T*)elegant_array_get_data(result), data, len, op, value); \
+        } \
+        elegant_array_finish_output(result, count); \
+        elegant_stats_end(&probe, ELEGANT_OP_SIMD_FILTER, len); \
+        return result; \
+    }
+
+ELEGANT_DEFINE_FILTER(elegant_filter_cmp_int, int, filter_i32)
+ELEGANT_DEFINE_FILTER(elegant_filter_cmp_float, float, filter_f32)
+ELEGANT_DEFINE_FILTER(elegant_filter_cmp_double, double, filter_f64)
@@ -0,0 +1,474 @@
+/*
+ * Elegant - Sorting and Searching
+ * Radix sorts map each element to an unsigned key with the same order,
+ * sort the keys with 8-bit LSD passes and map them back. The comparator
+ * path is a bottom-up merge sort over insertion-sorted runs. Large arrays
+ * are split into blocks for the thread pool: per-block digit histograms
+ * and scatters for radix, sorted blocks merged pairwise for merge sort.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#define ELEGANT_SORT_RUN 32              /* insertion-sorted run length */
+#define ELEGANT_RADIX_BUCKETS 256
+#define ELEGANT_SORT_MIN_BLOCK 4096      /* elements per parallel block */
+
+typedef int (*elegant_compare_fn)(const void*, const void*);
+
+/* Run body over every block on the pool, or here when the pool can't take it */
+static void elegant_sort_for(size_t blocks, void (*body)(void* ctx, size_t block), void* ctx) {
+    if (elegant_parallel_for(blocks, body, ctx) != 0) {
+        for (size_t b = 0; b < blocks; b++) body(ctx, b);
+    }
+}
+
+/* Blocks for a parallel pass over n elements, or 0 to stay sequential */
+static size_t elegant_sort_blocks(size_t n) {
+    if (n < ELEGANT_SORT_PARALLEL_MIN) return 0;
+
+    size_t threads = elegant_parallel_get_threads();
+    if (threads < 2) return 0;
+
+    size_t blocks = threads * 4;
+    if (n / blocks < ELEGANT_SORT_MIN_BLOCK) blocks = n / ELEGANT_SORT_MIN_BLOCK;
+    return blocks >= 2 ? blocks : 0;
+}
+
+static inline void elegant_sort_block_bounds(size_t n, size_t blocks, size_t block,
+                                             size_t* first, size_t* last) {
+    *first = n * block / blocks;
+    *last = n * (block + 1) / blocks;
+}
+
+/* Order-preserving keys: flip the sign bit of integers, and for IEEE floats
+   also invert negative values so their magnitude order reverses */
+static inline uint32_t elegant_key_int32(uint32_t bits) { return bits ^ 0x80000000u; }
+static inline uint32_t elegant_unkey_int32(uint32_t key) { return key ^ 0x80000000u; }
+static inline uint32_t elegant_key_float32(uint32_t bits) {
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+static inline uint32_t elegant_unkey_float32(uint32_t key) {
+    return (key & 0x80000000u) ? key & ~0x80000000u : ~key;
+}
+static inline uint64_t elegant_key_float64(uint64_t bits) {
+    return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+}
+static inline uint64_t elegant_unkey_float64(uint64_t key) {
+    return (key & 0x8000000000000000ull) ? key & ~0x8000000000000000ull : ~key;
+}
+
+/*
+ * LSD radix sort of unsigned keys of one width. Passes whose digit is the
+ * same for every key are skipped, so narrow value ranges cost fewer passes.
+ * Results always end up back in keys.
+ */
+#define ELEGANT_DEFINE_RADIX(W) \
+    static void elegant_insertion_sort_u##W(uint##W##_t* keys, size_t n) { \
+        for (size_t i = 1; i < n; i++) { \
+            uint##W##_t key = keys[i]; \
+            size_t j = i; \
+            for (; j > 0 && keys[j - 1] > key; j--) keys[j] = keys[j - 1]; \
+            keys[j] = key; \
+        } \
+    } \
+    \
+    static void elegant_radix_serial_u##W(uint##W##_t* keys, uint##W##_t* temp, size_t n) { \
+        size_t counts[W / 8][ELEGANT_RADIX_BUCKETS] = {{0}}; \
+        for (size_t i = 0; i < n; i++) { \
+            uint##W##_t key = keys[i]; \
+            for (unsigned d = 0; d < W / 8; d++) counts[d][(key >> (8 * d)) & 0xff]++; \
+        } \
+        \
+        uint##W##_t* src = keys; \
+        uint##W##_t* dst = temp; \
+        for (unsigned d = 0; d < W / 8; d++) { \
+            size_t* offsets = counts[d]; \
+            unsigned shift = 8 * d; \
+            if (offsets[(src[0] >> shift) & 0xff] == n) continue; \
+            \
+            size_t running = 0; \
+            for (size_t b = 0; b < ELEGANT_RADIX_BUCKETS; b++) { \
+                size_t count = offsets[b]; \
+                offsets[b] = running; \
+                running += count; \
+            } \
+            for (size_t i = 0; i < n; i++) { \
+                uint##W##_t key = src[i]; \
+                dst[offsets[(key >> shift) & 0xff]++] = key; \
+            } \
+            uint##W##_t* swap = src; \
+            src = dst; \
+            dst = swap; \
+        } \
+        if (src != keys) memcpy(keys, src, n * sizeof(uint##W##_t)); \
+    } \
+    \
+    typedef struct { \
+        const uint##W##_t* src; \
+        uint##W##_t* dst; \
+        size_t length; \
+        size_t blocks; \
+        unsigned shift; \
+        size_t* counts;  /* blocks rows of ELEGANT_RADIX_BUCKETS */ \
+    } elegant_radix_ctx_u##W##_t; \
+    \
+    static void elegant_radix_histogram_u##W(void* arg, size_t block) { \
+        elegant_radix_ctx_u##W##_t* ctx = arg; \
+        size_t first, last; \
+        elegant_sort_block_bounds(ctx->length, ctx->blocks, block, &first, &last); \
+        size_t* counts = ctx->counts + block * ELEGANT_RADIX_BUCKETS; \
+        memset(counts, 0, ELEGANT_RADIX_BUCKETS * sizeof(size_t)); \
+        for (size_t i = first; i < last; i++) counts[(ctx->src[i] >> ctx->shift) & 0xff]++; \
+    } \
+    \
+    static void elegant_radix_scatter_u##W(void* arg, size_t block) { \
+        elegant_radix_ctx_u##W##_t* ctx = arg; \
+        size_t first, last; \
+        elegant_sort_block_bounds(ctx->length, ctx->blocks, block, &first, &last); \
+        size_t* offsets = ctx->counts + block * ELEGANT_RADIX_BUCKETS; \
+        for (size_t i = first; i < last; i++) { \
+            uint##W##_t key = ctx->src[i]; \
+            ctx->dst[offsets[(key >> ctx->shift) & 0xff]++] = key; \
+        } \
+    } \
+    \
+    /* Offsets run digit-major, then block order, which keeps every pass stable */ \
+    static int elegant_radix_parallel_u##W(uint##W##_t* keys, uint##W##_t* temp, size_t n, size_t blocks) { \
+        size_t* counts = malloc(blocks * ELEGANT_RADIX_BUCKETS * sizeof(size_t)); \
+        if (!counts) return ENOMEM; \
+        \
+        elegant_radix_ctx_u##W##_t ctx = { keys, temp, n, blocks, 0, counts }; \
+        for (unsigned d = 0; d < W / 8; d++) { \
+            ctx.shift = 8 * d; \
+            elegant_sort_for(blocks, elegant_radix_histogram_u##W, &ctx); \
+            \
+            size_t running = 0; \
+            bool single_digit = false; \
+            for (size_t digit = 0; digit < ELEGANT_RADIX_BUCKETS; digit++) { \
+                size_t before = running; \
+                for (size_t b = 0; b < blocks; b++) { \
+                    size_t count = counts[b * ELEGANT_RADIX_BUCKETS + digit]; \
+                    counts[b * ELEGANT_RADIX_BUCKETS + digit] = running; \
+                    running += count; \
+                } \
+                if (running - before == n) single_digit = true; \
+            } \
+            if (single_digit) continue; \
+            \
+            elegant_sort_for(blocks, elegant_radix_scatter_u##W, &ctx); \
+            uint##W##_t* swap = (uint##W##_t*)ctx.src; \
+            ctx.src = ctx.dst; \
+            ctx.dst = swap; \
+        } \
+        if (ctx.src != keys) memcpy(keys, ctx.src, n * sizeof(uint##W##_t)); \
+        free(counts); \
+        return 0; \
+    } \
+    \
+    static int elegant_radix_sort_u##W(uint##W##_t* keys, size_t n) { \
+        if (n <= ELEGANT_SORT_RUN) { \
+            elegant_insertion_sort_u##W(keys, n); \
+            return 0; \
+        } \
+        uint##W##_t* temp = malloc(n * sizeof(uint##W##_t)); \
+        if (!temp) return ENOMEM; \
+        \
+        size_t blocks = elegant_sort_blocks(n); \
+        if (!blocks || elegant_radix_parallel_u##W(keys, temp, n, blocks) != 0) { \
+            elegant_radix_serial_u##W(keys, temp, n); \
+        } \
+        free(temp); \
+        return 0; \
+    }
+
+ELEGANT_DEFINE_RADIX(32)
+ELEGANT_DEFINE_RADIX(64)
+
+/* Key the elements in place, sort the keys, then turn them back into values */
+#define ELEGANT_DEFINE_KEY_SORT(suffix, T, W, key_fn, unkey_fn) \
+    int elegant_sort_##suffix(elegant_array_t* arr) { \
+        if (!arr || arr->element_size != sizeof(T)) return EINVAL; \
+        elegant_op_probe_t probe = elegant_stats_begin(); \
+        \
+        size_t n = elegant_array_get_length(arr); \
+        uint##W##_t* keys = n > 0 ? elegant_array_get_mutable_data(arr) : NULL; \
+        if (n > 0 && !keys) return ENOMEM; \
+        \
+        for (size_t i = 0; i < n; i++) keys[i] = key_fn(keys[i]); \
+        int err = elegant_radix_sort_u##W(keys, n); \
+        for (size_t i = 0; i < n; i++) keys[i] = unkey_fn(keys[i]); \
+        if (err) return err; \
+        \
+        elegant_stats_end(&probe, ELEGANT_OP_SORT, n); \
+        return 0; \
+    }
+
+ELEGANT_DEFINE_KEY_SORT(int, int, 32, elegant_key_int32, elegant_unkey_int32)
+ELEGANT_DEFINE_KEY_SORT(float, float, 32, elegant_key_float32, elegant_unkey_float32)
+ELEGANT_DEFINE_KEY_SORT(double, double, 64, elegant_key_float64, elegant_unkey_float64)
+
+/* Stable merge sort for arbitrary element sizes */
+
+static void elegant_insertion_sort_bytes(char* base, size_t n, size_t es, elegant_compare_fn compare, char* hold) {
+    for (size_t i = 1; i < n; i++) {
+        char* element = base + i * es;
+        if (compare(element - es, element) <= 0) continue;
+
+        size_t j = i - 1;
+        while (j > 0 && compare(base + (j - 1) * es, element) > 0) j--;
+        memcpy(hold, element, es);
+        memmove(base + (j + 1) * es, base + j * es, (i - j) * es);
+        memcpy(base + j * es, hold, es);
+    }
+}
+
+/* Ties take the left run first, which is what keeps the sort stable */
+static void elegant_merge_runs(const char* left, size_t left_n, const char* right, size_t right_n,
+                               char* out, size_t es, elegant_compare_fn compare) {
+    while (left_n > 0 && right_n > 0) {
+        if (compare(left, right) <= 0) {
+            memcpy(out, left, es);
+            left += es;
+            left_n--;
+        } else {
+            memcpy(out, right, es);
+            right += es;
+            right_n--;
+        }
+        out += es;
+    }
+    memcpy(out, left, left_n * es);
+    memcpy(out + left_n * es, right, right_n * es);
+}
+
+/* Sorts base[0, n) with temp[0, n) as scratch; the result ends up in base */
+static void elegant_merge_sort_range(char* base, char* temp, size_t n, size_t es, elegant_compare_fn compare) {
+    for (size_t start = 0; start < n; start += ELEGANT_SORT_RUN) {
+        size_t run = n - start < ELEGANT_SORT_RUN ? n - start : ELEGANT_SORT_RUN;
+        elegant_insertion_sort_bytes(base + start * es, run, es, compare, temp);
+    }
+
+    char* src = base;
+    char* dst = temp;
+    for (size_t width = ELEGANT_SORT_RUN; width < n; width *= 2) {
+        for (size_t start = 0; start < n; start += 2 * width) {
+            size_t mid = start + width < n ? start + width : n;
+            size_t end = start + 2 * width < n ? start + 2 * width : n;
+            elegant_merge_runs(src + start * es, mid - start, src + mid * es, end - mid,
+                               dst + start * es, es, compare);
+        }
+        char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != base) memcpy(base, src, n * es);
+}
+
+typedef struct {
+    char* src;
+    char* dst;
+    size_t length;
+    size_t blocks;
+    size_t width;           /* blocks per run in the current merge pass */
+    size_t element_size;
+    elegant_compare_fn compare;
+} elegant_merge_ctx_t;
+
+static void elegant_merge_sort_block(void* arg, size_t block) {
+    elegant_merge_ctx_t* ctx = arg;
+    size_t first, last;
+    elegant_sort_block_bounds(ctx->length, ctx->blocks, block, &first, &last);
+    elegant_merge_sort_range(ctx->src + first * ctx->element_size, ctx->dst + first * ctx->element_size,
+                             last - first, ctx->element_size, ctx->compare);
+}
+
+static void elegant_merge_block_pair(void* arg, size_t pair) {
+    elegant_merge_ctx_t* ctx = arg;
+    size_t es = ctx->element_size;
+    size_t first_block = pair * 2 * ctx->width;
+    size_t mid_block = first_block + ctx->width < ctx->blocks ? first_block + ctx->width : ctx->blocks;
+    size_t end_block = first_block + 2 * ctx->width < ctx->blocks ? first_block + 2 * ctx->width : ctx->blocks;
+
+    size_t first = ctx->length * first_block / ctx->blocks;
+    size_t mid = ctx->length * mid_block / ctx->blocks;
+    size_t end = ctx->length * end_block / ctx->blocks;
+    elegant_merge_runs(ctx->src + first * es, mid - first, ctx->src + mid * es, end - mid,
+                       ctx->dst + first * es, es, ctx->compare);
+}
+
+int elegant_sort(elegant_array_t* arr, int (*compare)(const void*, const void*)) {
+    if (!arr || !compare || arr->element_size == 0) return EINVAL;
+    elegant_op_probe_t probe = elegant_stats_begin();
+
+    size_t n = elegant_array_get_length(arr);
+    size_t es = arr->element_size;
+    char* base = n > 0 ? elegant_array_get_mutable_data(arr) : NULL;
+    if (n > 0 && !base) return ENOMEM;
+
+    if (n > 1) {
+        /* Short arrays use one slot of scratch for the insertion sort */
+        char* temp = malloc((n > ELEGANT_SORT_RUN ? n : 1) * es);
+        if (!temp) return ENOMEM;
+
+        size_t blocks = elegant_sort_blocks(n);
+        if (blocks == 0) {
+            elegant_merge_sort_range(base, temp, n, es, compare);
+        } else {
+            elegant_merge_ctx_t ctx = { base, temp, n, blocks, 0, es, compare };
+            elegant_sort_for(blocks, elegant_merge_sort_block, &ctx);
+
+            for (ctx.width = 1; ctx.width < blocks; ctx.width *= 2) {
+                size_t pairs = (blocks + 2 * ctx.width - 1) / (2 * ctx.width);
+                elegant_sort_for(pairs, elegant_merge_block_pair, &ctx);
+                char* swap = ctx.src;
+                ctx.src = ctx.dst;
+                ctx.dst = swap;
+            }
+            if (ctx.src != base) memcpy(base, ctx.src, n * es);
+        }
+        free(temp);
+    }
+
+    elegant_stats_end(&probe, ELEGANT_OP_SORT, n);
+    return 0;
+}
+
+#define ELEGANT_DEFINE_COMPARE(suffix, T) \
+    int elegant_compare_##suffix(const void* a, const void* b) { \
+        T x = *(const T*)a; \
+        T y = *(const T*)b; \
+        return (x > y) - (x < y); \
+    }
+
+ELEGANT_DEFINE_COMPARE(int, int)
+ELEGANT_DEFINE_COMPARE(float, float)
+ELEGANT_DEFINE_COMPARE(double, double)
+
+/* Searching */
+
+/* First index where compare(element, key) > or >= 0, by `strict` */
+static size_t elegant_partition_point(elegant_array_t* arr, const void* key, elegant_compare_fn compare, bool strict) {
+    size_t n = elegant_array_get_length(arr);
+    const char* data = elegant_array_get_data(arr);
+    if (!data) return n;
+
+    size_t es = arr->element_size;
+    size_t lo = 0;
+    while (n > 0) {
+        size_t half = n / 2;
+        int order = compare(data + (lo + half) * es, key);
+        if (order < 0 || (strict && order == 0)) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+size_t elegant_lower_bound(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*)) {
+    if (!arr || !key || !compare) return 0;
+    return elegant_partition_point(arr, key, compare, false);
+}
+
+size_t elegant_upper_bound(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*)) {
+    if (!arr || !key || !compare) return 0;
+    return elegant_partition_point(arr, key, compare, true);
+}
+
+void* elegant_binary_search(elegant_array_t* arr, const void* key, int (*compare)(const void*, const void*)) {
+    if (!arr || !key || !compare) return NULL;
+
+    size_t index = elegant_partition_point(arr, key, compare, false);
+    if (index >= elegant_array_get_length(arr)) return NULL;
+
+    char* element = (char*)elegant_array_get_data(arr) + index * arr->element_size;
+    return compare(element, key) == 0 ? element : NULL;
+}
+
+/* Typed lower bounds: the halving loop has no data-dependent branch */
+#define ELEGANT_DEFINE_LOWER_BOUND(suffix, T) \
+    size_t elegant_lower_bound_##suffix(elegant_array_t* arr, T key) { \
+        if (!arr || arr->element_size != sizeof(T)) return 0; \
+        size_t n = elegant_array_get_length(arr); \
+        const T* data = elegant_array_get_data(arr); \
+        if (!data || n == 0) return n; \
+        \
+        const T* base = data; \
+        while (n > 1) { \
+            size_t half = n / 2; \
+            base = base[half] < key ? base + half : base; \
+            n -= half; \
+        } \
+        return (size_t)(base - data) + (*base < key); \
+    }
+
+ELEGANT_DEFINE_LOWER_BOUND(int, int)
+ELEGANT_DEFINE_LOWER_BOUND(float, float)
+ELEGANT_DEFINE_LOWER_BOUND(double, double)
+
+int elegant_merge_join(elegant_array_t* left, elegant_array_t* right,
+                       int (*compare)(const void*, const void*),
+                       elegant_array_t** left_selection, elegant_array_t** right_selection) {
+    if (!left || !right || !compare || !left_selection || !right_selection) return EINVAL;
+
+    size_t left_n = elegant_array_get_length(left);
+    size_t right_n = elegant_array_get_length(right);
+    const char* left_data = elegant_array_get_data(left);
+    const char* right_data = elegant_array_get_data(right);
+    if ((left_n > 0 && !left_data) || (right_n > 0 && !right_data)) return ENOMEM;
+
+    size_t left_es = left->element_size;
+    size_t right_es = right->element_size;
+    size_t guess = left_n < right_n ? left_n : right_n;
+
+    elegant_array_builder_t left_out, right_out;
+    elegant_builder_init(&left_out, sizeof(size_t), guess);
+    elegant_builder_init(&right_out, sizeof(size_t), guess);
+
+    int err = 0;
+    size_t i = 0, j = 0;
+    while (!err && i < left_n && j < right_n) {
+        int order = compare(left_data + i * left_es, right_data + j * right_es);
+        if (order < 0) {
+            i++;
+        } else if (order > 0) {
+            j++;
+        } else {
+            size_t left_end = i + 1;
+            while (left_end < left_n && compare(left_data + left_end * left_es, right_data + j * right_es) == 0) {
+                left_end++;
+            }
+            size_t right_end = j + 1;
+            while (right_end < right_n && compare(left_data + i * left_es, right_data + right_end * right_es) == 0) {
+                right_end++;
+            }
+
+            for (size_t a = i; a < left_end && !err; a++) {
+                for (size_t b = j; b < right_end && !err; b++) {
+                    err = elegant_builder_push(&left_out, &a);
+                    if (!err) err = elegant_builder_push(&right_out, &b);
+                }
+            }
+            i = left_end;
+            j = right_end;
+        }
+    }
+
+    elegant_array_t* left_result = err ? NULL : elegant_builder_finish(&left_out);
+    elegant_array_t* right_result = left_result ? elegant_builder_finish(&right_out) : NULL;
+    if (!right_result) {
+        elegant_array_destroy(left_result);
+        elegant_builder_discard(&left_out);
+        elegant_builder_discard(&right_out);
+        return err ? err : ENOMEM;
+    }
+
+    *left_selection = left_result;
+    *right_selection = right_result;
+    return 0;
+}
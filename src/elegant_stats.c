@@ -0,0 +1,295 @@
+/*
+ * Elegant - Runtime statistics
+ * Per-thread counter blocks, process-wide snapshots and exporters
+ */
+
+#define _POSIX_C_SOURCE 200112L  /* clock_gettime */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <time.h>
+
+__thread elegant_thread_stats_t elegant_thread_stats;
+int elegant_stats_timing = 0;
+
+/* Listed threads, and the folded totals of threads that have exited */
+static pthread_mutex_t elegant_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static elegant_thread_stats_t* elegant_stats_threads = NULL;
+static elegant_stats_snapshot_t elegant_stats_exited;
+
+static pthread_once_t elegant_stats_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t elegant_stats_key;
+
+static const char* const elegant_op_names[ELEGANT_OP_COUNT] = {
+    "map", "filter", "reduce", "fold", "find", "zip", "concat", "take", "drop",
+    "reverse", "slice", "copy", "gather", "simd_map", "simd_filter", "simd_reduce",
+    "par_map", "par_filter", "par_reduce", "stream", "sort", "group", "chain"
+};
+
+const char* elegant_op_name(elegant_op_t op) {
+    return (unsigned)op < ELEGANT_OP_COUNT ? elegant_op_names[op] : "unknown";
+}
+
+uint64_t elegant_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void elegant_stats_set_timing(bool enabled) {
+    __atomic_store_n(&elegant_stats_timing, enabled ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+bool elegant_stats_get_timing(void) {
+    return __atomic_load_n(&elegant_stats_timing, __ATOMIC_RELAXED) != 0;
+}
+
+/* Add one block's counters into a snapshot (maxima are combined as maxima) */
+static void elegant_stats_accumulate(elegant_stats_snapshot_t* out, const elegant_thread_stats_t* t) {
+#define LOAD(field) __atomic_load_n(&t->field, __ATOMIC_RELAXED)
+#define MAX(field, value) do { uint64_t v_ = (value); if (v_ > out->field) out->field = v_; } while (0)
+    for (int i = 0; i < ELEGANT_OP_COUNT; i++) {
+        out->ops[i].calls += LOAD(ops[i].calls);
+        out->ops[i].elements += LOAD(ops[i].elements);
+        out->ops[i].bytes_allocated += LOAD(ops[i].bytes_allocated);
+        out->ops[i].time_ns += LOAD(ops[i].time_ns);
+    }
+    out->allocated_bytes += LOAD(allocated_bytes);
+    out->freed_bytes += LOAD(freed_bytes);
+    out->peak_bytes += LOAD(peak_bytes);
+    out->live_allocations += LOAD(allocations) - LOAD(frees);
+    out->scope_enters += LOAD(scope_enters);
+    out->scope_depth += LOAD(scope_depth);
+    MAX(scope_max_depth, LOAD(scope_max_depth));
+    out->scope_frame_arrays += LOAD(scope_frame_arrays);
+    MAX(scope_max_frame_arrays, LOAD(scope_max_frame_arrays));
+    MAX(scope_max_arena_bytes, LOAD(scope_max_arena_bytes));
+#undef MAX
+#undef LOAD
+}
+
+static void elegant_stats_finish(elegant_stats_snapshot_t* out) {
+    out->live_bytes = out->allocated_bytes > out->freed_bytes ? out->allocated_bytes - out->freed_bytes : 0;
+}
+
+/* Add one snapshot into another */
+static void elegant_stats_merge(elegant_stats_snapshot_t* out, const elegant_stats_snapshot_t* in) {
+    for (int i = 0; i < ELEGANT_OP_COUNT; i++) {
+        out->ops[i].calls += in->ops[i].calls;
+        out->ops[i].elements += in->ops[i].elements;
+        out->ops[i].bytes_allocated += in->ops[i].bytes_allocated;
+        out->ops[i].time_ns += in->ops[i].time_ns;
+    }
+    out->allocated_bytes += in->allocated_bytes;
+    out->freed_bytes += in->freed_bytes;
+    out->peak_bytes += in->peak_bytes;
+    out->live_allocations += in->live_allocations;
+    out->scope_enters += in->scope_enters;
+    out->scope_depth += in->scope_depth;
+    if (in->scope_max_depth > out->scope_max_depth) out->scope_max_depth = in->scope_max_depth;
+    out->scope_frame_arrays += in->scope_frame_arrays;
+    if (in->scope_max_frame_arrays > out->scope_max_frame_arrays) {
+        out->scope_max_frame_arrays = in->scope_max_frame_arrays;
+    }
+    if (in->scope_max_arena_bytes > out->scope_max_arena_bytes) {
+        out->scope_max_arena_bytes = in->scope_max_arena_bytes;
+    }
+    out->threads += in->threads;
+}
+
+/* Runs as the thread exits: fold its counters in and drop it from the list */
+static void elegant_stats_thread_exit(void* arg) {
+    elegant_thread_stats_t* self = arg;
+    elegant_stats_snapshot_t folded;
+    memset(&folded, 0, sizeof(folded));
+    elegant_stats_accumulate(&folded, self);
+    folded.threads = 1;
+
+    pthread_mutex_lock(&elegant_stats_lock);
+    for (elegant_thread_stats_t** link = &elegant_stats_threads; *link; link = &(*link)->next) {
+        if (*link == self) {
+            *link = self->next;
+            break;
+        }
+    }
+    elegant_stats_merge(&elegant_stats_exited, &folded);
+    pthread_mutex_unlock(&elegant_stats_lock);
+
+    /* Later activity on this thread is no longer reported */
+    self->state = 2;
+}
+
+static void elegant_stats_make_key(void) {
+    pthread_key_create(&elegant_stats_key, elegant_stats_thread_exit);
+}
+
+void elegant_stats_register_thread(void) {
+    elegant_thread_stats_t* self = &elegant_thread_stats;
+    if (self->state != 0) return;
+
+    pthread_once(&elegant_stats_key_once, elegant_stats_make_key);
+
+    pthread_mutex_lock(&elegant_stats_lock);
+    self->next = elegant_stats_threads;
+    elegant_stats_threads = self;
+    self->state = 1;
+    pthread_mutex_unlock(&elegant_stats_lock);
+
+    pthread_setspecific(elegant_stats_key, self);
+}
+
+void elegant_stats_thread_snapshot(elegant_stats_snapshot_t* snapshot) {
+    if (!snapshot) return;
+    memset(snapshot, 0, sizeof(*snapshot));
+    elegant_stats_accumulate(snapshot, &elegant_thread_stats);
+    elegant_stats_finish(snapshot);
+    snapshot->threads = 1;
+}
+
+void elegant_stats_snapshot(elegant_stats_snapshot_t* snapshot) {
+    if (!snapshot) return;
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    /* The calling thread counts even if it has not reported anything yet */
+    elegant_stats_register_thread();
+
+    pthread_mutex_lock(&elegant_stats_lock);
+    for (elegant_thread_stats_t* t = elegant_stats_threads; t; t = t->next) {
+        elegant_stats_accumulate(snapshot, t);
+        snapshot->threads++;
+    }
+    elegant_stats_merge(snapshot, &elegant_stats_exited);
+    pthread_mutex_unlock(&elegant_stats_lock);
+
+    elegant_stats_finish(snapshot);
+}
+
+/* Bounded appender with snprintf semantics */
+typedef struct elegant_stats_writer {
+    char* buffer;
+    size_t size;
+    size_t length;
+} elegant_stats_writer_t;
+
+static void elegant_stats_printf(elegant_stats_writer_t* w, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t room = w->length < w->size ? w->size - w->length : 0;
+    int n = vsnprintf(room ? w->buffer + w->length : NULL, room, format, args);
+    va_end(args);
+    if (n > 0) w->length += (size_t)n;
+}
+
+static size_t elegant_stats_writer_end(elegant_stats_writer_t* w) {
+    if (w->size > 0 && w->length >= w->size) w->buffer[w->size - 1] = '\0';
+    return w->length;
+}
+
+size_t elegant_stats_to_json(const elegant_stats_snapshot_t* s, char* buffer, size_t size) {
+    elegant_stats_writer_t w = { buffer, buffer ? size : 0, 0 };
+    if (!s) return 0;
+
+    elegant_stats_printf(&w, "{\"threads\":%llu,\"memory\":{\"allocated_bytes\":%llu,"
+                         "\"freed_bytes\":%llu,\"live_bytes\":%llu,\"peak_bytes\":%llu,"
+                         "\"live_allocations\":%llu},",
+                         (unsigned long long)s->threads, (unsigned long long)s->allocated_bytes,
+                         (unsigned long long)s->freed_bytes, (unsigned long long)s->live_bytes,
+                         (unsigned long long)s->peak_bytes, (unsigned long long)s->live_allocations);
+    elegant_stats_printf(&w, "\"scopes\":{\"enters\":%llu,\"depth\":%llu,\"max_depth\":%llu,"
+                         "\"frame_arrays\":%llu,\"max_frame_arrays\":%llu,\"max_arena_bytes\":%llu},",
+                         (unsigned long long)s->scope_enters, (unsigned long long)s->scope_depth,
+                         (unsigned long long)s->scope_max_depth, (unsigned long long)s->scope_frame_arrays,
+                         (unsigned long long)s->scope_max_frame_arrays,
+                         (unsigned long long)s->scope_max_arena_bytes);
+    elegant_stats_printf(&w, "\"operations\":{");
+    for (int i = 0; i < ELEGANT_OP_COUNT; i++) {
+        const elegant_op_stats_t* op = &s->ops[i];
+        elegant_stats_printf(&w, "%s\"%s\":{\"calls\":%llu,\"elements\":%llu,"
+                             "\"bytes_allocated\":%llu,\"time_ns\":%llu}",
+                             i ? "," : "", elegant_op_names[i], (unsigned long long)op->calls,
+                             (unsigned long long)op->elements, (unsigned long long)op->bytes_allocated,
+                             (unsigned long long)op->time_ns);
+    }
+    elegant_stats_printf(&w, "}}\n");
+
+    return elegant_stats_writer_end(&w);
+}
+
+size_t elegant_stats_to_prometheus(const elegant_stats_snapshot_t* s, char* buffer, size_t size) {
+    elegant_stats_writer_t w = { buffer, buffer ? size : 0, 0 };
+    if (!s) return 0;
+
+    static const struct {
+        const char* name;
+        const char* type;
+        const char* help;
+        size_t offset;
+    } scalars[] = {
+        { "elegant_allocated_bytes_total", "counter", "Bytes allocated through the library.",
+          offsetof(elegant_stats_snapshot_t, allocated_bytes) },
+        { "elegant_freed_bytes_total", "counter", "Bytes freed through the library.",
+          offsetof(elegant_stats_snapshot_t, freed_bytes) },
+        { "elegant_live_bytes", "gauge", "Bytes currently allocated.",
+          offsetof(elegant_stats_snapshot_t, live_bytes) },
+        { "elegant_peak_bytes", "gauge", "Sum of per-thread peak live bytes.",
+          offsetof(elegant_stats_snapshot_t, peak_bytes) },
+        { "elegant_live_allocations", "gauge", "Blocks currently allocated.",
+          offsetof(elegant_stats_snapshot_t, live_allocations) },
+        { "elegant_scope_enters_total", "counter", "Scope frames entered.",
+          offsetof(elegant_stats_snapshot_t, scope_enters) },
+        { "elegant_scope_depth", "gauge", "Scope frames currently open.",
+          offsetof(elegant_stats_snapshot_t, scope_depth) },
+        { "elegant_scope_max_depth", "gauge", "Deepest scope nesting seen.",
+          offsetof(elegant_stats_snapshot_t, scope_max_depth) },
+        { "elegant_scope_frame_arrays_total", "counter", "Arrays registered with exited scope frames.",
+          offsetof(elegant_stats_snapshot_t, scope_frame_arrays) },
+        { "elegant_scope_max_frame_arrays", "gauge", "Most arrays registered with one frame.",
+          offsetof(elegant_stats_snapshot_t, scope_max_frame_arrays) },
+        { "elegant_scope_max_arena_bytes", "gauge", "Most bytes used by one arena frame.",
+          offsetof(elegant_stats_snapshot_t, scope_max_arena_bytes) },
+        { "elegant_threads", "gauge", "Threads that have reported statistics.",
+          offsetof(elegant_stats_snapshot_t, threads) },
+    };
+
+    for (size_t i = 0; i < sizeof(scalars) / sizeof(scalars[0]); i++) {
+        uint64_t value = *(const uint64_t*)((const char*)s + scalars[i].offset);
+        elegant_stats_printf(&w, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n",
+                             scalars[i].name, scalars[i].help, scalars[i].name, scalars[i].type,
+                             scalars[i].name, (unsigned long long)value);
+    }
+
+    static const struct {
+        const char* name;
+        const char* help;
+        size_t offset;
+    } counters[] = {
+        { "elegant_op_calls_total", "Successful collection operation calls.",
+          offsetof(elegant_op_stats_t, calls) },
+        { "elegant_op_elements_total", "Input elements processed.",
+          offsetof(elegant_op_stats_t, elements) },
+        { "elegant_op_allocated_bytes_total", "Bytes allocated inside operations.",
+          offsetof(elegant_op_stats_t, bytes_allocated) },
+        { "elegant_op_time_seconds_total", "Time spent inside operations (timing enabled).",
+          offsetof(elegant_op_stats_t, time_ns) },
+    };
+
+    for (size_t c = 0; c < sizeof(counters) / sizeof(counters[0]); c++) {
+        bool seconds = counters[c].offset == offsetof(elegant_op_stats_t, time_ns);
+        elegant_stats_printf(&w, "# HELP %s %s\n# TYPE %s counter\n",
+                             counters[c].name, counters[c].help, counters[c].name);
+        for (int i = 0; i < ELEGANT_OP_COUNT; i++) {
+            uint64_t value = *(const uint64_t*)((const char*)&s->ops[i] + counters[c].offset);
+            if (seconds) {
+                elegant_stats_printf(&w, "%s{op=\"%s\"} %.9f\n", counters[c].name,
+                                     elegant_op_names[i], (double)value / 1e9);
+            } else {
+                elegant_stats_printf(&w, "%s{op=\"%s\"} %llu\n", counters[c].name,
+                                     elegant_op_names[i], (unsigned long long)value);
+            }
+        }
+    }
+
+    return elegant_stats_writer_end(&w);
+}
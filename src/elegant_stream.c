@@ -0,0 +1,501 @@
+/*
+ * Elegant - Chunked Streams
+ * Each stream fills one reusable chunk buffer from its source; transforms
+ * pull a chunk from upstream and rewrite it into their own.
+ */
+
+#define _POSIX_C_SOURCE 200112L  /* sched_yield, nanosleep */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
+#define ELEGANT_RING_YIELDS 64           /* waits spent yielding before sleeping */
+#define ELEGANT_RING_MAX_SLEEP_NS 1000000
+
+struct elegant_stream {
+    elegant_stream_pull_t pull;
+    void (*release)(void* ctx);
+    void* ctx;
+    elegant_array_t chunk;  /* embedded header over buffer; never freed on its own */
+    void* buffer;
+    int error;
+    bool done;
+};
+
+elegant_stream_t* elegant_stream_create(size_t element_size, size_t chunk_length,
+                                        elegant_stream_pull_t pull, void* ctx,
+                                        void (*release)(void* ctx)) {
+    if (element_size == 0 || !pull) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (chunk_length == 0) {
+        chunk_length = ELEGANT_STREAM_CHUNK_BYTES / element_size;
+        if (chunk_length == 0) chunk_length = 1;
+    }
+    if (chunk_length > SIZE_MAX / element_size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    
+    elegant_stream_t* stream = malloc(sizeof(elegant_stream_t));
+    void* buffer = malloc(chunk_length * element_size);
+    if (!stream || !buffer) {
+        fprintf(stderr, "Elegant: Failed to allocate stream\n");
+        free(stream);
+        free(buffer);
+        return NULL;
+    }
+    
+    stream->pull = pull;
+    stream->release = release;
+    stream->ctx = ctx;
+    stream->buffer = buffer;
+    stream->error = 0;
+    stream->done = false;
+    
+    /* A plain owning heap array as far as the collection functions can tell */
+    memset(&stream->chunk, 0, sizeof(stream->chunk));
+    stream->chunk.data = buffer;
+    stream->chunk.element_size = element_size;
+    stream->chunk.capacity = chunk_length;
+    stream->chunk.ref_count = 1;
+    return stream;
+}
+
+void elegant_stream_close(elegant_stream_t* stream) {
+    if (!stream) return;
+    if (stream->release) stream->release(stream->ctx);
+    free(stream->buffer);
+    free(stream);
+}
+
+/* One pull into buffer; 0 at the end or on error */
+static size_t elegant_stream_fill(elegant_stream_t* stream, void* buffer) {
+    if (stream->done) return 0;
+    
+    /* Stacked transforms pull through each other, so each stage is counted */
+    elegant_op_probe_t probe = elegant_stats_begin();
+    size_t count = stream->pull(stream->ctx, buffer, stream->chunk.capacity);
+    if (count == ELEGANT_STREAM_ERROR || count == 0) {
+        if (count == ELEGANT_STREAM_ERROR) stream->error = errno ? errno : EIO;
+        stream->done = true;
+        return 0;
+    }
+    elegant_stats_end(&probe, ELEGANT_OP_STREAM, count);
+    return count;
+}
+
+elegant_array_t* elegant_stream_next(elegant_stream_t* stream) {
+    if (!stream) return NULL;
+    
+    size_t count = elegant_stream_fill(stream, stream->buffer);
+    if (count == 0) return NULL;
+    
+    /* The chunk may have been written through; point it back at the buffer */
+    stream->chunk.data = stream->buffer;
+    stream->chunk.length = count;
+    return &stream->chunk;
+}
+
+size_t elegant_stream_read(elegant_stream_t* stream, void* buffer, size_t capacity) {
+    if (!stream || !buffer || capacity < stream->chunk.capacity) {
+        if (stream) stream->error = EINVAL;
+        return 0;
+    }
+    return elegant_stream_fill(stream, buffer);
+}
+
+int elegant_stream_error(const elegant_stream_t* stream) {
+    return stream ? stream->error : EINVAL;
+}
+
+size_t elegant_stream_element_size(const elegant_stream_t* stream) {
+    return stream ? stream->chunk.element_size : 0;
+}
+
+size_t elegant_stream_chunk_length(const elegant_stream_t* stream) {
+    return stream ? stream->chunk.capacity : 0;
+}
+
+/* File descriptor source: fills whole chunks, a trailing partial element is dropped */
+typedef struct {
+    int fd;
+    size_t element_size;
+} elegant_fd_source_t;
+
+static size_t elegant_fd_pull(void* ctx, void* buffer, size_t capacity) {
+    elegant_fd_source_t* source = ctx;
+    size_t want = capacity * source->element_size;
+    size_t got = 0;
+    
+    while (got < want) {
+        ssize_t n = read(source->fd, (char*)buffer + got, want - got);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return ELEGANT_STREAM_ERROR;
+        }
+        if (n == 0) break;
+        got += (size_t)n;
+    }
+    return got / source->element_size;
+}
+
+elegant_stream_t* elegant_stream_from_fd(int fd, size_t element_size, size_t chunk_length) {
+    if (fd < 0 || element_size == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    elegant_fd_source_t* source = malloc(sizeof(elegant_fd_source_t));
+    if (!source) return NULL;
+    source->fd = fd;
+    source->element_size = element_size;
+    
+    elegant_stream_t* stream = elegant_stream_create(element_size, chunk_length,
+                                                     elegant_fd_pull, source, free);
+    if (!stream) free(source);
+    return stream;
+}
+
+/* Array source: copies consecutive slices of a retained array */
+typedef struct {
+    elegant_array_t* array;
+    size_t offset;
+} elegant_array_source_t;
+
+static size_t elegant_array_pull(void* ctx, void* buffer, size_t capacity) {
+    elegant_array_source_t* source = ctx;
+    size_t length = elegant_array_get_length(source->array);
+    size_t count = length - source->offset;
+    if (count > capacity) count = capacity;
+    if (count == 0) return 0;
+    
+    const char* data = elegant_array_get_data(source->array);
+    if (!data) {
+        errno = ENOMEM;
+        return ELEGANT_STREAM_ERROR;
+    }
+    
+    size_t element_size = source->array->element_size;
+    memcpy(buffer, data + source->offset * element_size, count * element_size);
+    source->offset += count;
+    return count;
+}
+
+static void elegant_array_source_release(void* ctx) {
+    elegant_array_source_t* source = ctx;
+    elegant_array_release(source->array);
+    free(source);
+}
+
+elegant_stream_t* elegant_stream_from_array(elegant_array_t* arr, size_t chunk_length) {
+    if (!arr) {
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    elegant_array_source_t* source = malloc(sizeof(elegant_array_source_t));
+    if (!source) return NULL;
+    source->array = elegant_array_retain(arr);
+    source->offset = 0;
+    
+    elegant_stream_t* stream = elegant_stream_create(arr->element_size, chunk_length,
+                                                     elegant_array_pull, source,
+                                                     elegant_array_source_release);
+    if (!stream) elegant_array_source_release(source);
+    return stream;
+}
+
+/* SPSC ring: free-running head/tail counters on separate cache lines */
+struct elegant_ring {
+    char* data;
+    size_t element_size;
+    size_t mask;
+    int closed;
+    size_t head __attribute__((aligned(ELEGANT_CACHE_LINE_SIZE)));  /* next to pop */
+    size_t tail __attribute__((aligned(ELEGANT_CACHE_LINE_SIZE)));  /* next to push */
+};
+
+elegant_ring_t* elegant_ring_create(size_t element_size, size_t capacity) {
+    if (element_size == 0 || capacity == 0 || capacity > (SIZE_MAX >> 1) / element_size) {
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    size_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+    
+    elegant_ring_t* ring = NULL;
+    if (posix_memalign((void**)&ring, ELEGANT_CACHE_LINE_SIZE, sizeof(elegant_ring_t)) != 0) {
+        return NULL;
+    }
+    ring->data = malloc(slots * element_size);
+    if (!ring->data) {
+        free(ring);
+        return NULL;
+    }
+    
+    ring->element_size = element_size;
+    ring->mask = slots - 1;
+    ring->closed = 0;
+    ring->head = 0;
+    ring->tail = 0;
+    return ring;
+}
+
+/* Yield for short waits, then back off to sleeps so an idle end costs no CPU */
+static void elegant_ring_wait(unsigned* waits) {
+    if (*waits < ELEGANT_RING_YIELDS) {
+        (*waits)++;
+        sched_yield();
+        return;
+    }
+    
+    /* 1 us doubling to the cap, which is reached after ten sleeps */
+    unsigned step = *waits - ELEGANT_RING_YIELDS;
+    long ns = 1000L << step;
+    if (ns >= ELEGANT_RING_MAX_SLEEP_NS) ns = ELEGANT_RING_MAX_SLEEP_NS;
+    else (*waits)++;
+    
+    struct timespec delay = { 0, ns };
+    nanosleep(&delay, NULL);
+}
+
+/* Copy `count` elements between the ring and a flat buffer, wrapping at the end */
+static void elegant_ring_copy(elegant_ring_t* ring, size_t position, void* flat, size_t count, bool into_ring) {
+    size_t slots = ring->mask + 1;
+    size_t start = position & ring->mask;
+    size_t first = count < slots - start ? count : slots - start;
+    size_t size = ring->element_size;
+    char* slot = ring->data + start * size;
+    
+    if (into_ring) {
+        memcpy(slot, flat, first * size);
+        memcpy(ring->data, (char*)flat + first * size, (count - first) * size);
+    } else {
+        memcpy(flat, slot, first * size);
+        memcpy((char*)flat + first * size, ring->data, (count - first) * size);
+    }
+}
+
+size_t elegant_ring_push(elegant_ring_t* ring, const void* elements, size_t count) {
+    if (!ring || !elements) return 0;
+    
+    size_t pushed = 0;
+    size_t tail = ring->tail;
+    unsigned waits = 0;
+    while (pushed < count) {
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE)) break;
+        
+        size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        size_t room = ring->mask + 1 - (tail - head);
+        if (room == 0) {
+            elegant_ring_wait(&waits);
+            continue;
+        }
+        waits = 0;
+        
+        size_t n = count - pushed < room ? count - pushed : room;
+        elegant_ring_copy(ring, tail, (char*)elements + pushed * ring->element_size, n, true);
+        tail += n;
+        pushed += n;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    return pushed;
+}
+
+size_t elegant_ring_pop(elegant_ring_t* ring, void* elements, size_t max_count) {
+    if (!ring || !elements || max_count == 0) return 0;
+    
+    size_t head = ring->head;
+    unsigned waits = 0;
+    for (;;) {
+        /* Read closed before tail so a final push is never missed */
+        int closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+        size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        size_t available = tail - head;
+        
+        if (available > 0) {
+            size_t n = available < max_count ? available : max_count;
+            elegant_ring_copy(ring, head, elements, n, false);
+            __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+            return n;
+        }
+        if (closed) return 0;
+        elegant_ring_wait(&waits);
+    }
+}
+
+void elegant_ring_close(elegant_ring_t* ring) {
+    if (ring) __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+}
+
+void elegant_ring_destroy(elegant_ring_t* ring) {
+    if (!ring) return;
+    free(ring->data);
+    free(ring);
+}
+
+static size_t elegant_ring_pull(void* ctx, void* buffer, size_t capacity) {
+    return elegant_ring_pop(ctx, buffer, capacity);
+}
+
+elegant_stream_t* elegant_stream_from_ring(elegant_ring_t* ring, size_t chunk_length) {
+    if (!ring) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return elegant_stream_create(ring->element_size, chunk_length, elegant_ring_pull, ring, NULL);
+}
+
+/* Transforms */
+typedef struct {
+    elegant_stream_t* upstream;
+    void (*map)(void* out, void* in);
+    int (*predicate)(void*);
+    size_t out_size;
+} elegant_transform_t;
+
+static void elegant_transform_release(void* ctx) {
+    elegant_transform_t* transform = ctx;
+    elegant_stream_close(transform->upstream);
+    free(transform);
+}
+
+/* Upstream end or failure, as a pull result */
+static inline size_t elegant_transform_end(elegant_transform_t* transform) {
+    if (!transform->upstream->error) return 0;
+    errno = transform->upstream->error;
+    return ELEGANT_STREAM_ERROR;
+}
+
+/* Chunk lengths match upstream, so one upstream chunk always fits */
+static size_t elegant_map_pull(void* ctx, void* buffer, size_t capacity) {
+    elegant_transform_t* transform = ctx;
+    (void)capacity;
+    
+    elegant_array_t* chunk = elegant_stream_next(transform->upstream);
+    if (!chunk) return elegant_transform_end(transform);
+    
+    size_t in_size = chunk->element_size;
+    size_t out_size = transform->out_size;
+    char* in = chunk->data;
+    char* out = buffer;
+    for (size_t i = 0; i < chunk->length; i++) {
+        transform->map(out + i * out_size, in + i * in_size);
+    }
+    return chunk->length;
+}
+
+/* Keeps pulling until something passes, since an empty chunk would end the stream */
+static size_t elegant_filter_pull(void* ctx, void* buffer, size_t capacity) {
+    elegant_transform_t* transform = ctx;
+    (void)capacity;
+    
+    for (;;) {
+        elegant_array_t* chunk = elegant_stream_next(transform->upstream);
+        if (!chunk) return elegant_transform_end(transform);
+        
+        size_t element_size = chunk->element_size;
+        char* in = chunk->data;
+        char* out = buffer;
+        size_t count = 0;
+        for (size_t i = 0; i < chunk->length; i++) {
+            char* element = in + i * element_size;
+            if (transform->predicate(element)) {
+                memcpy(out + count * element_size, element, element_size);
+                count++;
+            }
+        }
+        if (count > 0) return count;
+    }
+}
+
+static elegant_stream_t* elegant_stream_transform(elegant_stream_t* src, size_t out_size,
+                                                  elegant_stream_pull_t pull,
+                                                  void (*map)(void*, void*), int (*predicate)(void*)) {
+    elegant_transform_t* transform = malloc(sizeof(elegant_transform_t));
+    if (!transform) {
+        elegant_stream_close(src);
+        return NULL;
+    }
+    transform->upstream = src;
+    transform->map = map;
+    transform->predicate = predicate;
+    transform->out_size = out_size;
+    
+    elegant_stream_t* stream = elegant_stream_create(out_size, src->chunk.capacity, pull,
+                                                     transform, elegant_transform_release);
+    if (!stream) elegant_transform_release(transform);
+    return stream;
+}
+
+elegant_stream_t* elegant_stream_map_generic(elegant_stream_t* src, void (*func)(void* out, void* in),
+                                             size_t src_element_size, size_t dst_element_size) {
+    if (!src || !func || src_element_size != src->chunk.element_size || dst_element_size == 0) {
+        elegant_stream_close(src);
+        errno = EINVAL;
+        return NULL;
+    }
+    return elegant_stream_transform(src, dst_element_size, elegant_map_pull, func, NULL);
+}
+
+elegant_stream_t* elegant_stream_filter_generic(elegant_stream_t* src, int (*predicate)(void*),
+                                                size_t element_size) {
+    if (!src || !predicate || element_size != src->chunk.element_size) {
+        elegant_stream_close(src);
+        errno = EINVAL;
+        return NULL;
+    }
+    return elegant_stream_transform(src, element_size, elegant_filter_pull, NULL, predicate);
+}
+
+/* Terminal operations */
+int elegant_stream_reduce_generic(elegant_stream_t* src, void* (*func)(void*, void*),
+                                  void* accumulator, size_t element_size) {
+    if (!src || !func || !accumulator || element_size != src->chunk.element_size) return EINVAL;
+    
+    STREAM_FOR_EACH_CHUNK(chunk, src) {
+        char* data = chunk->data;
+        for (size_t i = 0; i < chunk->length; i++) {
+            memcpy(accumulator, func(accumulator, data + i * element_size), element_size);
+        }
+    }
+    return src->error;
+}
+
+void* elegant_stream_find_generic(elegant_stream_t* src, int (*predicate)(void*), size_t element_size) {
+    if (!src || !predicate || element_size != src->chunk.element_size) return NULL;
+    
+    STREAM_FOR_EACH_CHUNK(chunk, src) {
+        char* data = chunk->data;
+        for (size_t i = 0; i < chunk->length; i++) {
+            if (predicate(data + i * element_size)) return data + i * element_size;
+        }
+    }
+    return NULL;
+}
+
+elegant_array_t* elegant_stream_collect(elegant_stream_t* src) {
+    if (!src) return NULL;
+    
+    elegant_array_builder_t builder;
+    elegant_builder_init(&builder, src->chunk.element_size, 0);
+    
+    STREAM_FOR_EACH_CHUNK(chunk, src) {
+        if (elegant_builder_extend(&builder, chunk->data, chunk->length) != 0) {
+            elegant_builder_discard(&builder);
+            return NULL;
+        }
+    }
+    if (src->error) {
+        elegant_builder_discard(&builder);
+        return NULL;
+    }
+    return elegant_builder_finish(&builder);
+}
@@ -0,0 +1,197 @@
+/*
+ * Elegant - Columnar Tables
+ * A struct stored field by field: one array per column, all of one length.
+ */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <errno.h>
+
+/* Scope-registered columns belong to their frame, so the table takes a reference of its own */
+static elegant_array_t* elegant_table_hold(elegant_array_t* column) {
+    if (column->flags & ELEGANT_ARRAY_SCOPED) elegant_array_retain(column);
+    return column;
+}
+
+/* Temporaries the table made itself; a scope frame frees its own */
+static void elegant_table_drop(elegant_array_t* temp) {
+    if (temp && !(temp->flags & ELEGANT_ARRAY_SCOPED)) elegant_array_destroy(temp);
+}
+
+static elegant_table_t* elegant_table_alloc(const elegant_column_desc_t* schema, size_t column_count,
+                                            size_t record_size) {
+    if (!schema || column_count == 0 || record_size == 0) return NULL;
+
+    for (size_t i = 0; i < column_count; i++) {
+        if (schema[i].size == 0 || schema[i].offset > record_size ||
+            schema[i].size > record_size - schema[i].offset) {
+            fprintf(stderr, "Elegant: Column %zu does not fit a %zu-byte record\n", i, record_size);
+            return NULL;
+        }
+    }
+
+    elegant_table_t* table = malloc(sizeof(elegant_table_t));
+    elegant_column_desc_t* copy = malloc(column_count * sizeof(elegant_column_desc_t));
+    elegant_array_t** columns = calloc(column_count, sizeof(elegant_array_t*));
+    if (!table || !copy || !columns) {
+        fprintf(stderr, "Elegant: Failed to allocate table\n");
+        free(table);
+        free(copy);
+        free(columns);
+        return NULL;
+    }
+
+    memcpy(copy, schema, column_count * sizeof(elegant_column_desc_t));
+    table->columns = columns;
+    table->schema = copy;
+    table->column_count = column_count;
+    table->record_size = record_size;
+    return table;
+}
+
+void elegant_table_destroy(elegant_table_t* table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < table->column_count; i++) {
+        elegant_array_destroy(table->columns[i]);
+    }
+    free(table->columns);
+    free(table->schema);
+    free(table);
+}
+
+static elegant_table_t* elegant_table_alloc_columns(const elegant_column_desc_t* schema, size_t column_count,
+                                                    size_t record_size, size_t length, bool zero) {
+    elegant_table_t* table = elegant_table_alloc(schema, column_count, record_size);
+    if (!table) return NULL;
+
+    for (size_t i = 0; i < column_count; i++) {
+        elegant_array_t* column = zero ? elegant_array_create(schema[i].size, length)
+                                       : elegant_array_create_uninit(schema[i].size, length);
+        if (!column) {
+            elegant_table_destroy(table);
+            return NULL;
+        }
+        table->columns[i] = elegant_table_hold(column);
+    }
+    return table;
+}
+
+elegant_table_t* elegant_table_create(const elegant_column_desc_t* schema, size_t column_count,
+                                      size_t record_size, size_t length) {
+    return elegant_table_alloc_columns(schema, column_count, record_size, length, true);
+}
+
+elegant_table_t* elegant_table_from_records(const elegant_column_desc_t* schema, size_t column_count,
+                                            size_t record_size, const void* records, size_t length) {
+    if (!records && length > 0) return NULL;
+
+    elegant_table_t* table = elegant_table_alloc_columns(schema, column_count, record_size, length, false);
+    if (!table) return NULL;
+
+    /* Column at a time, so each output column is written sequentially */
+    const char* base = records;
+    for (size_t c = 0; c < column_count; c++) {
+        size_t offset = schema[c].offset;
+        size_t size = schema[c].size;
+        char* out = elegant_array_get_data(table->columns[c]);
+        for (size_t row = 0; row < length; row++) {
+            memcpy(out + row * size, base + row * record_size + offset, size);
+        }
+    }
+    return table;
+}
+
+size_t elegant_table_length(const elegant_table_t* table) {
+    return table ? table->columns[0]->length : 0;
+}
+
+size_t elegant_table_column_index(const elegant_table_t* table, const char* name) {
+    if (!table || !name) return ELEGANT_TABLE_NO_COLUMN;
+
+    for (size_t i = 0; i < table->column_count; i++) {
+        if (table->schema[i].name && strcmp(table->schema[i].name, name) == 0) return i;
+    }
+    return ELEGANT_TABLE_NO_COLUMN;
+}
+
+elegant_array_t* elegant_table_column(elegant_table_t* table, size_t index) {
+    if (!table || index >= table->column_count) return NULL;
+    return table->columns[index];
+}
+
+elegant_array_t* elegant_table_column_named(elegant_table_t* table, const char* name) {
+    return elegant_table_column(table, elegant_table_column_index(table, name));
+}
+
+int elegant_table_get_record(elegant_table_t* table, size_t row, void* record) {
+    if (!table || !record) return EINVAL;
+    if (row >= elegant_table_length(table)) return ERANGE;
+
+    for (size_t c = 0; c < table->column_count; c++) {
+        const char* data = elegant_array_get_data(table->columns[c]);
+        if (!data) return ENOMEM;
+        memcpy((char*)record + table->schema[c].offset, data + row * table->schema[c].size,
+               table->schema[c].size);
+    }
+    return 0;
+}
+
+int elegant_table_set_record(elegant_table_t* table, size_t row, const void* record) {
+    if (!table || !record) return EINVAL;
+    if (row >= elegant_table_length(table)) return ERANGE;
+
+    for (size_t c = 0; c < table->column_count; c++) {
+        char* data = elegant_array_get_mutable_data(table->columns[c]);
+        if (!data) return ENOMEM;
+        memcpy(data + row * table->schema[c].size, (const char*)record + table->schema[c].offset,
+               table->schema[c].size);
+    }
+    return 0;
+}
+
+int elegant_table_to_records(elegant_table_t* table, void* records) {
+    if (!table || !records) return EINVAL;
+
+    size_t length = elegant_table_length(table);
+    char* base = records;
+    for (size_t c = 0; c < table->column_count; c++) {
+        size_t offset = table->schema[c].offset;
+        size_t size = table->schema[c].size;
+        const char* data = elegant_array_get_data(table->columns[c]);
+        if (!data && length > 0) return ENOMEM;
+        for (size_t row = 0; row < length; row++) {
+            memcpy(base + row * table->record_size + offset, data + row * size, size);
+        }
+    }
+    return 0;
+}
+
+elegant_table_t* elegant_table_gather(elegant_table_t* table, elegant_array_t* selection) {
+    if (!table || !selection) return NULL;
+
+    elegant_table_t* result = elegant_table_alloc(table->schema, table->column_count, table->record_size);
+    if (!result) return NULL;
+
+    for (size_t c = 0; c < table->column_count; c++) {
+        elegant_array_t* column = elegant_array_gather(table->columns[c], selection);
+        if (!column) {
+            elegant_table_destroy(result);
+            return NULL;
+        }
+        result->columns[c] = elegant_table_hold(column);
+    }
+    return result;
+}
+
+elegant_table_t* elegant_table_filter(elegant_table_t* table, size_t column, int (*predicate)(void*)) {
+    if (!table || column >= table->column_count || !predicate) return NULL;
+
+    elegant_array_t* selection = elegant_filter_select_generic(table->columns[column], predicate,
+                                                               table->schema[column].size);
+    if (!selection) return NULL;
+
+    elegant_table_t* result = elegant_table_gather(table, selection);
+    elegant_table_drop(selection);
+    return result;
+}
@@ -0,0 +1,109 @@
+/*
+ * Elegant Library - allocation wrapper tests
+ * elegant_malloc/realloc/free hand real sizes to the allocator and the
+ * byte counts, and return each block to the allocator that produced it.
+ */
+
+#include "test_common.h"
+#include <stdlib.h>
+
+static size_t live_bytes(void) {
+    return elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+}
+
+static uint64_t peak_bytes(void) {
+    elegant_stats_snapshot_t snapshot;
+    elegant_stats_thread_snapshot(&snapshot);
+    return snapshot.peak_bytes;
+}
+
+/* libc underneath, remembering the last sizes it was given */
+typedef struct {
+    size_t outstanding;
+    size_t last_free_size;
+    size_t last_old_size;
+    int frees;
+} recorder_t;
+
+static void* recorder_alloc(void* ctx, size_t size) {
+    ((recorder_t*)ctx)->outstanding += size;
+    return malloc(size);
+}
+
+static void* recorder_alloc_aligned(void* ctx, size_t size, size_t alignment) {
+    return elegant_libc_allocator.alloc_aligned(ctx, size, alignment);
+}
+
+static void* recorder_realloc(void* ctx, void* ptr, size_t old_size, size_t new_size) {
+    recorder_t* recorder = ctx;
+    recorder->last_old_size = old_size;
+    recorder->outstanding += new_size - old_size;
+    return realloc(ptr, new_size);
+}
+
+static void recorder_free(void* ctx, void* ptr, size_t size) {
+    recorder_t* recorder = ctx;
+    recorder->last_free_size = size;
+    recorder->outstanding -= size;
+    recorder->frees++;
+    free(ptr);
+}
+
+static void test_realloc_loop_balances(void) {
+    size_t before = live_bytes();
+    uint64_t peak = peak_bytes();
+
+    for (int round = 0; round < 100; round++) {
+        char* block = elegant_malloc(16);
+        for (size_t size = 32; size <= 4096; size *= 2) block = elegant_realloc(block, size);
+        block[4095] = 1;
+        elegant_free(block);
+    }
+    TEST_ASSERT(live_bytes() == before, "realloc and free release what they count");
+    TEST_ASSERT(peak_bytes() < peak + 2 * 4096 + 1024, "peak stays near the largest block");
+
+    int* zeroed = elegant_calloc(100, sizeof(int));
+    TEST_ASSERT(zeroed && zeroed[0] == 0 && zeroed[99] == 0, "calloc zeroes");
+    TEST_ASSERT(elegant_realloc(zeroed, 0) == NULL && live_bytes() == before, "realloc to zero frees");
+}
+
+static void test_sizes_reach_allocator(void) {
+    recorder_t recorder = { 0, 0, 0, 0 };
+    elegant_allocator_t allocator = {
+        recorder_alloc, NULL, recorder_alloc_aligned, recorder_realloc, recorder_free, &recorder
+    };
+
+    elegant_set_allocator(&allocator);
+    char* block = elegant_malloc(100);
+    size_t first = recorder.outstanding;
+    block = elegant_realloc(block, 300);
+    TEST_ASSERT(block && recorder.last_old_size == first, "realloc passes the old size");
+    elegant_set_allocator(NULL);
+
+    /* Freed after switching back to libc: still goes to the recorder */
+    memset(block, 7, 300);
+    elegant_free(block);
+    TEST_ASSERT(recorder.frees == 1 && recorder.last_free_size > 300 && recorder.outstanding == 0,
+                "free returns the real size to the allocator that served the block");
+    TEST_ASSERT(elegant_get_allocator() == &elegant_libc_allocator, "allocator restored");
+}
+
+static void test_aligned_sized(void) {
+    size_t before = live_bytes();
+    double* aligned = elegant_alloc_aligned(1000, 64);
+    TEST_ASSERT(aligned && ((uintptr_t)aligned & 63) == 0, "aligned allocation");
+    elegant_free_sized(aligned, 1000);
+    TEST_ASSERT(live_bytes() == before, "sized free balances an aligned allocation");
+    elegant_free(NULL);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    TEST_RUN(test_realloc_loop_balances);
+    TEST_RUN(test_sizes_reach_allocator);
+    TEST_RUN(test_aligned_sized);
+
+    return test_end();
+}
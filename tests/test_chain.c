@@ -0,0 +1,111 @@
+/*
+ * Elegant Library - fused chain tests
+ * CHAIN against the equivalent MAP/FILTER/TAKE/DROP steps, trimming of
+ * the worst-case output, early stops at an exhausted TAKE, and stats.
+ */
+
+#include "test_common.h"
+
+#define TEST_LENGTH 100000
+
+static elegant_array_t* make_ints(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(int), n);
+    int* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = (int)(i * 7919 % 100003);
+    return arr;
+}
+
+static int same_ints(elegant_array_t* a, elegant_array_t* b) {
+    if (!a || !b || elegant_array_get_length(a) != elegant_array_get_length(b)) return 0;
+    for (size_t i = 0; i < elegant_array_get_length(a); i++) {
+        if (ELEGANT_GET(a, i, int) != ELEGANT_GET(b, i, int)) return 0;
+    }
+    return 1;
+}
+
+static void test_matches_steps(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+
+    elegant_array_t* chained = CHAIN(src, CHAIN_OP_MAP(x * 3), CHAIN_OP_FILTER(x % 100 == 0),
+                                     CHAIN_OP_DROP(5), CHAIN_OP_MAP(x + 1));
+    elegant_array_t* mapped = MAP(src, x * 3, int);
+    elegant_array_t* filtered = FILTER(mapped, x % 100 == 0, int);
+    elegant_array_t* dropped = elegant_drop(filtered, 5);
+    elegant_array_t* expected = MAP(dropped, x + 1, int);
+    TEST_ASSERT(same_ints(chained, expected), "CHAIN matches the separate steps");
+
+    /* Sized for every element; a 1% filter must not keep that much */
+    TEST_ASSERT(chained && chained->capacity == elegant_array_get_length(chained),
+                "worst-case output is trimmed");
+
+    elegant_array_destroy(expected);
+    elegant_array_destroy(dropped);
+    elegant_array_destroy(filtered);
+    elegant_array_destroy(mapped);
+    elegant_array_destroy(chained);
+    elegant_array_destroy(src);
+}
+
+static int calls;
+
+static int counted(int x) {
+    calls++;
+    return x;
+}
+
+static void test_take_stops_early(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    calls = 0;
+    elegant_array_t* first = CHAIN(src, CHAIN_OP_MAP(counted(x)), CHAIN_OP_TAKE(10));
+    TEST_ASSERT(first && elegant_array_get_length(first) == 10 && calls == 10, "TAKE ends the pass");
+    TEST_ASSERT(ELEGANT_GET(first, 9, int) == ELEGANT_GET(src, 9, int), "TAKE keeps the prefix");
+
+    elegant_array_t* none = CHAIN(src, CHAIN_OP_FILTER(x < 0));
+    TEST_ASSERT(none && elegant_array_get_length(none) == 0, "chain with no output");
+
+    int sum = CHAIN_REDUCE_INT(src, acc + x, 0, CHAIN_OP_DROP(2), CHAIN_OP_TAKE(3));
+    TEST_ASSERT(sum == ELEGANT_GET(src, 2, int) + ELEGANT_GET(src, 3, int) + ELEGANT_GET(src, 4, int),
+                "CHAIN_REDUCE_INT over a window");
+
+    elegant_array_destroy(none);
+    elegant_array_destroy(first);
+    elegant_array_destroy(src);
+}
+
+static elegant_op_stats_t chain_stats(void) {
+    elegant_stats_snapshot_t snapshot;
+    elegant_stats_thread_snapshot(&snapshot);
+    return snapshot.ops[ELEGANT_OP_CHAIN];
+}
+
+static void test_stats(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_op_stats_t before = chain_stats();
+
+    elegant_array_t* all = CHAIN(src, CHAIN_OP_MAP(x + 1));
+    elegant_op_stats_t after_run = chain_stats();
+    TEST_ASSERT(after_run.calls == before.calls + 1 && after_run.elements == before.elements + TEST_LENGTH &&
+                after_run.bytes_allocated > before.bytes_allocated, "CHAIN is counted");
+
+    CHAIN_REDUCE_INT(src, acc + x, 0, CHAIN_OP_TAKE(7));
+    elegant_op_stats_t after_reduce = chain_stats();
+    TEST_ASSERT(after_reduce.calls == after_run.calls + 1 && after_reduce.elements == after_run.elements + 7,
+                "CHAIN_REDUCE_INT counts the elements it read");
+
+    elegant_array_destroy(all);
+    elegant_array_destroy(src);
+    TEST_ASSERT(strcmp(elegant_op_name(ELEGANT_OP_CHAIN), "chain") == 0, "op name");
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    size_t before = elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+
+    TEST_RUN(test_matches_steps);
+    TEST_RUN(test_take_stops_early);
+    TEST_RUN(test_stats);
+
+    TEST_ASSERT(elegant_get_allocated_bytes() - elegant_get_freed_bytes() == before, "chains free everything");
+    return test_end();
+}
@@ -0,0 +1,45 @@
+/*
+ * Elegant Library - shared test helpers
+ * Each test program exits non-zero if any check fails; a watchdog alarm
+ * turns a hang (e.g. a deadlocked pool) into a failure.
+ */
+
+#ifndef ELEGANT_TEST_COMMON_H
+#define ELEGANT_TEST_COMMON_H
+
+#define _POSIX_C_SOURCE 200112L  /* alarm */
+
+#include "elegant.h"
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define TEST_TIMEOUT_SECONDS 120
+
+static int test_failures = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s (%s:%d)\n", message, __FILE__, __LINE__); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RUN(test) \
+    do { \
+        int _before = test_failures; \
+        test(); \
+        printf("%s: %s\n", test_failures == _before ? "PASS" : "FAIL", #test); \
+    } while (0)
+
+static inline void test_begin(void) {
+    alarm(TEST_TIMEOUT_SECONDS);
+    setvbuf(stdout, NULL, _IONBF, 0);
+}
+
+static inline int test_end(void) {
+    return test_failures ? 1 : 0;
+}
+
+#endif /* ELEGANT_TEST_COMMON_H */
@@ -0,0 +1,146 @@
+/*
+ * Elegant Library - copy-on-write copy tests
+ * elegant_array_copy shares the payload until a handle is written, leaves
+ * the source's own layout alone, and the last handle takes the buffer back.
+ */
+
+#include "test_common.h"
+
+static size_t live_bytes(void) {
+    return elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+}
+
+static void test_write_isolation(void) {
+    elegant_array_t* arr = elegant_create_array_int(1, 2, 3);
+    const void* data = elegant_array_get_data(arr);
+    elegant_array_t* copy1 = elegant_array_copy(arr);
+    elegant_array_t* copy2 = elegant_array_copy(copy1);
+
+    TEST_ASSERT(copy1 && copy2 && copy1 != arr && copy2 != copy1, "copies are separate handles");
+    TEST_ASSERT(elegant_array_get_data(copy1) == data && elegant_array_get_data(copy2) == data,
+                "copies share the payload");
+    TEST_ASSERT(!elegant_array_is_view(arr) && elegant_array_get_data(arr) == data &&
+                (arr->flags & ELEGANT_ARRAY_INLINE_DATA), "copying leaves the source as it was");
+
+    ELEGANT_SET(copy1, 0, 100, int);
+    TEST_ASSERT(ELEGANT_GET(copy1, 0, int) == 100, "write lands in the copy");
+    TEST_ASSERT(ELEGANT_GET(arr, 0, int) == 1 && ELEGANT_GET(copy2, 0, int) == 1,
+                "write through a copy leaves the others unchanged");
+
+    ELEGANT_SET(arr, 2, 300, int);
+    TEST_ASSERT(ELEGANT_GET(copy2, 2, int) == 3 && ELEGANT_GET(copy1, 2, int) == 3,
+                "write through the source leaves the copies unchanged");
+
+    elegant_array_destroy(arr);
+    TEST_ASSERT(ELEGANT_GET(copy2, 1, int) == 2, "copy outlives its source");
+    elegant_array_destroy(copy1);
+    elegant_array_destroy(copy2);
+}
+
+static void test_last_handle_reclaims(void) {
+    /* Large enough for a separate payload buffer, which keeps its address */
+    elegant_array_t* arr = elegant_array_create(sizeof(double), 300000);
+    void* payload = elegant_array_get_data(arr);
+    elegant_array_t* copy = elegant_array_copy(arr);
+
+    elegant_array_destroy(arr);
+    ELEGANT_SET(copy, 7, 7.0, double);
+    TEST_ASSERT(elegant_array_get_data(copy) == payload, "last handle writes in place");
+    TEST_ASSERT(!elegant_array_is_view(copy), "last handle owns the buffer again");
+    TEST_ASSERT(elegant_array_push(copy, &(double){ 1.0 }) == 0 &&
+                ELEGANT_GET(copy, 300000, double) == 1.0, "reclaimed array grows");
+    elegant_array_destroy(copy);
+
+    /* A copy outliving a write to its source ends up with the source's old buffer */
+    elegant_array_t* written = elegant_array_create(sizeof(double), 300000);
+    void* original = elegant_array_get_data(written);
+    elegant_array_t* snapshot = elegant_array_copy(written);
+    ELEGANT_SET(written, 0, 1.0, double);
+    TEST_ASSERT(elegant_array_get_data(written) != original && ELEGANT_GET(snapshot, 0, double) == 0.0,
+                "written source copies, the snapshot keeps the old buffer");
+    ELEGANT_SET(snapshot, 1, 2.0, double);
+    TEST_ASSERT(elegant_array_get_data(snapshot) == original && !elegant_array_is_view(snapshot),
+                "snapshot takes the buffer over once it is the last reader");
+    elegant_array_destroy(snapshot);
+    elegant_array_destroy(written);
+}
+
+static void test_unread_source_writes_in_place(void) {
+    /* Inline sources never move for a copy; they copy only when written while read */
+    elegant_array_t* small = elegant_create_array_int(4, 5, 6);
+    const void* data = elegant_array_get_data(small);
+    elegant_array_t* copy = elegant_array_copy(small);
+    elegant_array_destroy(copy);
+    ELEGANT_SET(small, 0, 40, int);
+    TEST_ASSERT(elegant_array_get_data(small) == data && ELEGANT_GET(small, 0, int) == 40,
+                "source written after its copies are gone stays in place");
+
+    copy = elegant_array_copy(small);
+    ELEGANT_SET(small, 1, 50, int);
+    TEST_ASSERT(elegant_array_get_data(small) != data && elegant_array_get_data(copy) == data,
+                "source written while copied moves, the copy stays");
+    elegant_array_destroy(small);
+    TEST_ASSERT(ELEGANT_GET(copy, 1, int) == 5, "copy keeps the source's old block alive");
+    elegant_array_destroy(copy);
+}
+
+static void test_referenced_source_shares(void) {
+    /* Another holder of the source doesn't stop the copy sharing its payload */
+    elegant_array_t* arr = elegant_create_array_int(1, 2, 3, 4);
+    elegant_array_retain(arr);
+    elegant_array_t* view = elegant_take(arr, 2);
+    elegant_array_t* copy = elegant_array_copy(arr);
+
+    TEST_ASSERT(copy && elegant_array_get_data(copy) == elegant_array_get_data(arr), "copy shares the payload");
+    TEST_ASSERT(!elegant_array_is_view(arr), "source is left as it was");
+
+    ELEGANT_SET(arr, 0, 10, int);
+    TEST_ASSERT(ELEGANT_GET(copy, 0, int) == 1 && ELEGANT_GET(view, 0, int) == 1,
+                "copy and view keep the old value");
+
+    elegant_array_destroy(copy);
+    elegant_array_destroy(view);
+    elegant_array_release(arr);
+    elegant_array_destroy(arr);
+}
+
+static void test_viewed_source_shares(void) {
+    /* Views made while nothing else holds the source share its payload */
+    elegant_array_t* arr = elegant_create_array_int(1, 2, 3, 4);
+    elegant_array_t* view = elegant_drop(arr, 1);
+    elegant_array_t* copy = elegant_array_copy(arr);
+
+    TEST_ASSERT(elegant_array_get_data(copy) == elegant_array_get_data(arr), "viewed source copies in O(1)");
+    ELEGANT_SET(copy, 1, 20, int);
+    TEST_ASSERT(ELEGANT_GET(view, 0, int) == 2 && ELEGANT_GET(arr, 1, int) == 2,
+                "write through the copy reaches no view");
+
+    elegant_array_destroy(view);
+    elegant_array_destroy(copy);
+    elegant_array_destroy(arr);
+}
+
+static void test_shared_arrays(void) {
+    elegant_array_t* arr = elegant_create_array_int(1, 2);
+    elegant_array_share(arr);
+    elegant_array_t* same = elegant_array_copy(arr);
+    TEST_ASSERT(same == arr, "shared arrays are retained, not restructured");
+    elegant_array_destroy(same);
+    elegant_array_destroy(arr);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    size_t before = live_bytes();
+
+    TEST_RUN(test_write_isolation);
+    TEST_RUN(test_last_handle_reclaims);
+    TEST_RUN(test_unread_source_writes_in_place);
+    TEST_RUN(test_referenced_source_shares);
+    TEST_RUN(test_viewed_source_shares);
+    TEST_RUN(test_shared_arrays);
+
+    TEST_ASSERT(live_bytes() == before, "every payload and header is freed");
+    return test_end();
+}
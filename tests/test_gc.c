@@ -0,0 +1,147 @@
+/*
+ * Elegant Library - incremental collector tests
+ * Unreachable arrays are freed, pins, scopes and views keep arrays alive,
+ * and a small pause budget splits a cycle into many steps.
+ */
+
+#include "test_common.h"
+
+static size_t live_bytes(void) {
+    return elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+}
+
+static int destroyed;
+
+static void count_destroy(void* data) {
+    (void)data;
+    destroyed++;
+}
+
+static elegant_array_t* tracked_array(int value) {
+    elegant_array_t* arr = elegant_create_array_int(value, value + 1, value + 2);
+    arr->destructor = count_destroy;
+    return arr;
+}
+
+static size_t tracked(void) {
+    elegant_gc_stats_t stats;
+    elegant_gc_get_stats(&stats);
+    return stats.tracked_arrays;
+}
+
+static void test_unreachable_freed(void) {
+    destroyed = 0;
+    elegant_gc_stats_t before, after;
+    elegant_gc_get_stats(&before);
+
+    elegant_array_t* arr = tracked_array(1);
+    TEST_ASSERT(tracked() == 1, "collector owns the new array");
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 0 && ELEGANT_GET(arr, 0, int) == 1, "creator's pin keeps it alive");
+
+    elegant_array_destroy(arr);
+    TEST_ASSERT(destroyed == 0, "destroy only unpins");
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 1 && tracked() == 0, "unpinned array is collected");
+
+    elegant_gc_get_stats(&after);
+    TEST_ASSERT(after.freed_arrays == before.freed_arrays + 1 && after.freed_bytes > before.freed_bytes &&
+                after.collections > before.collections, "stats count the collection");
+}
+
+static void test_pins(void) {
+    destroyed = 0;
+    elegant_array_t* arr = tracked_array(1);
+    elegant_gc_pin(arr);
+    elegant_array_destroy(arr);
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 0 && ELEGANT_GET(arr, 2, int) == 3, "extra pin survives a collection");
+
+    elegant_gc_unpin(arr);
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 1, "last unpin lets it go");
+}
+
+static void test_scope_roots(void) {
+    destroyed = 0;
+    ELEGANT_SCOPE {
+        elegant_array_t* arr = tracked_array(7);
+        elegant_array_t* doubled = MAP(arr, x * 2, int);
+        elegant_gc_collect();
+        TEST_ASSERT(destroyed == 0 && ELEGANT_GET(doubled, 1, int) == 16, "scope roots its arrays");
+    }
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 1 && tracked() == 0, "arrays go once their scope exits");
+}
+
+static void test_views_keep_owners(void) {
+    destroyed = 0;
+    elegant_array_t* arr = tracked_array(10);
+    elegant_array_t* view = elegant_drop(arr, 1);
+    elegant_array_destroy(arr);
+
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 0 && ELEGANT_GET(view, 1, int) == 12, "view keeps its owner alive");
+
+    elegant_array_destroy(view);
+    elegant_gc_collect();
+    TEST_ASSERT(destroyed == 1 && tracked() == 0, "owner goes with its last view");
+}
+
+#define CHURN_ARRAYS 20000
+
+static void test_incremental_steps(void) {
+    destroyed = 0;
+    for (int i = 0; i < CHURN_ARRAYS; i++) elegant_array_destroy(tracked_array(i));
+    elegant_array_t* kept = tracked_array(-1);
+
+    elegant_gc_stats_t before, after;
+    elegant_gc_get_stats(&before);
+    elegant_gc_set_threshold(1);
+    elegant_gc_set_pause_budget(1);
+
+    size_t steps = 0;
+    while (elegant_gc_step() && steps < 10 * CHURN_ARRAYS) steps++;
+    elegant_gc_get_stats(&after);
+
+    TEST_ASSERT(steps > 1 && after.steps - before.steps > 1, "a tight budget splits the cycle");
+    TEST_ASSERT(after.collections == before.collections + 1, "the cycle completes");
+    TEST_ASSERT(destroyed == CHURN_ARRAYS && after.tracked_arrays == 1, "every unpinned array is freed");
+    TEST_ASSERT(after.max_pause_ns >= before.max_pause_ns, "pauses are recorded");
+
+    elegant_gc_set_threshold(ELEGANT_GC_THRESHOLD);
+    elegant_gc_set_pause_budget(ELEGANT_GC_PAUSE_BUDGET_NS);
+    TEST_ASSERT(!elegant_gc_step(), "nothing due below the threshold");
+
+    elegant_array_destroy(kept);
+    elegant_gc_collect();
+    TEST_ASSERT(tracked() == 0, "collector empty");
+}
+
+static void test_pool_allocator(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(256 * 1024);
+    ELEGANT_ALLOCATOR_SCOPE(elegant_pool_allocator(pool)) {
+        for (int i = 0; i < 200; i++) elegant_array_destroy(tracked_array(i));
+    }
+    TEST_ASSERT(pool->live_allocations > 0, "collected arrays come from the pool");
+    elegant_gc_collect();
+    TEST_ASSERT(pool->live_allocations == 0, "arrays and the object list go back to the pool");
+    elegant_destroy_safe_pool(pool);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(GARBAGE_COLLECTION);
+    size_t before = live_bytes();
+
+    TEST_RUN(test_unreachable_freed);
+    TEST_RUN(test_pins);
+    TEST_RUN(test_scope_roots);
+    TEST_RUN(test_views_keep_owners);
+    TEST_RUN(test_incremental_steps);
+    TEST_RUN(test_pool_allocator);
+
+    TEST_ASSERT(live_bytes() == before, "collector releases everything");
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    return test_end();
+}
@@ -0,0 +1,180 @@
+/*
+ * Elegant Library - hash aggregation tests
+ * GROUP_BY, COUNT_BY and DISTINCT against a direct-indexed reference, with
+ * large inputs partitioned across the pool and on a single thread.
+ */
+
+#include "test_common.h"
+#include <stdint.h>
+
+#define KEY_RANGE 5003
+#define LARGE_LENGTH (ELEGANT_GROUP_PARALLEL_MIN + 100003)
+
+typedef struct {
+    size_t groups;
+    int keys[KEY_RANGE];              /* in first-appearance order */
+    size_t counts[KEY_RANGE];
+    unsigned int hashes[KEY_RANGE];   /* order-sensitive fold of the values */
+} reference_t;
+
+static reference_t reference;
+
+static elegant_array_t* make_input(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(int), n);
+    int* data = elegant_array_get_mutable_data(arr);
+    unsigned int seed = 99;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (int)(seed >> 8);
+    }
+    return arr;
+}
+
+/* The same grouping done the obvious way */
+static void build_reference(elegant_array_t* arr) {
+    static int slot[KEY_RANGE];
+    memset(slot, -1, sizeof(slot));
+    reference.groups = 0;
+
+    const int* data = elegant_array_get_data(arr);
+    for (size_t i = 0; i < elegant_array_get_length(arr); i++) {
+        int key = data[i] % KEY_RANGE;
+        if (slot[key] < 0) {
+            slot[key] = (int)reference.groups++;
+            reference.keys[slot[key]] = key;
+            reference.counts[slot[key]] = 0;
+            reference.hashes[slot[key]] = (unsigned int)data[i];
+        } else {
+            reference.hashes[slot[key]] = reference.hashes[slot[key]] * 31u + (unsigned int)data[i];
+        }
+        reference.counts[slot[key]]++;
+    }
+}
+
+static int matches_reference(const elegant_groups_t* groups, int with_values) {
+    if (elegant_array_get_length(groups->keys) != reference.groups ||
+        elegant_array_get_length(groups->counts) != reference.groups) {
+        return 0;
+    }
+    for (size_t g = 0; g < reference.groups; g++) {
+        if (ELEGANT_GET(groups->keys, g, int) != reference.keys[g] ||
+            ELEGANT_GET(groups->counts, g, size_t) != reference.counts[g]) {
+            return 0;
+        }
+        if (with_values && ELEGANT_GET(groups->values, g, unsigned int) != reference.hashes[g]) return 0;
+    }
+    return 1;
+}
+
+static void check_grouping(size_t n) {
+    elegant_array_t* arr = make_input(n);
+    build_reference(arr);
+
+    elegant_groups_t groups;
+    int err = GROUP_BY(arr, x % KEY_RANGE, (unsigned int)x, acc * 31u + x, int, int, unsigned int, &groups);
+    TEST_ASSERT(err == 0 && matches_reference(&groups, 1),
+                "GROUP_BY keeps first-appearance order and folds values in element order");
+    elegant_groups_destroy(&groups);
+
+    err = COUNT_BY(arr, x % KEY_RANGE, int, int, &groups);
+    TEST_ASSERT(err == 0 && groups.values == NULL && matches_reference(&groups, 0), "COUNT_BY");
+    elegant_groups_destroy(&groups);
+
+    elegant_array_destroy(arr);
+}
+
+static void test_small_input(void) {
+    check_grouping(10000);
+}
+
+static void test_partitioned_input(void) {
+    check_grouping(LARGE_LENGTH);
+}
+
+static void test_single_thread_input(void) {
+    elegant_parallel_set_threads(1);
+    check_grouping(LARGE_LENGTH);
+    elegant_parallel_set_threads(4);
+}
+
+static void test_distinct(void) {
+    elegant_array_t* arr = elegant_create_array_int(4, 1, 4, 2, 1, 3);
+    elegant_array_t* unique = DISTINCT(arr);
+    static const int want[] = { 4, 1, 2, 3 };
+    int ok = unique && elegant_array_get_length(unique) == 4;
+    for (size_t i = 0; ok && i < 4; i++) ok &= ELEGANT_GET(unique, i, int) == want[i];
+    TEST_ASSERT(ok, "DISTINCT in first-appearance order");
+    elegant_array_destroy(unique);
+    elegant_array_destroy(arr);
+
+    elegant_array_t* large = make_input(LARGE_LENGTH);
+    elegant_array_t* keys = MAP(large, x % KEY_RANGE, int);
+    build_reference(keys);
+    unique = DISTINCT(keys);
+    ok = unique && elegant_array_get_length(unique) == reference.groups;
+    for (size_t i = 0; ok && i < reference.groups; i++) ok &= ELEGANT_GET(unique, i, int) == reference.keys[i];
+    TEST_ASSERT(ok, "partitioned DISTINCT keeps the same order");
+    elegant_array_destroy(unique);
+    elegant_array_destroy(keys);
+    elegant_array_destroy(large);
+
+    elegant_array_t* empty = elegant_array_create(sizeof(int), 0);
+    unique = DISTINCT(empty);
+    TEST_ASSERT(unique && elegant_array_get_length(unique) == 0, "DISTINCT of an empty array");
+    elegant_array_destroy(unique);
+    elegant_array_destroy(empty);
+}
+
+typedef struct {
+    int32_t region;
+    int32_t product;
+} sale_key_t;
+
+static void test_struct_keys(void) {
+    elegant_array_t* arr = elegant_create_array_int(11, 12, 21, 11, 22, 12);
+    elegant_groups_t groups;
+    int err = GROUP_BY(arr, ((sale_key_t){ x / 10, x % 10 }), x, acc + x, int, sale_key_t, int, &groups);
+    TEST_ASSERT(err == 0 && elegant_array_get_length(groups.keys) == 4, "struct keys");
+    sale_key_t first = ELEGANT_GET(groups.keys, 0, sale_key_t);
+    TEST_ASSERT(first.region == 1 && first.product == 1 && ELEGANT_GET(groups.values, 0, int) == 22 &&
+                ELEGANT_GET(groups.counts, 3, size_t) == 1, "struct key aggregates");
+    elegant_groups_destroy(&groups);
+    elegant_array_destroy(arr);
+}
+
+static void test_invalid_specs(void) {
+    elegant_array_t* arr = elegant_create_array_int(1, 2);
+    elegant_groups_t groups;
+
+    elegant_group_spec_t no_key = { 0, NULL, 0, NULL, NULL };
+    TEST_ASSERT(elegant_group_by(arr, &no_key, &groups) == EINVAL && groups.keys == NULL,
+                "zero key size is refused and groups are zeroed");
+
+    elegant_group_spec_t wrong_size = { sizeof(short), NULL, 0, NULL, NULL };
+    TEST_ASSERT(elegant_group_by(arr, &wrong_size, &groups) == EINVAL, "element key of the wrong size");
+
+    elegant_group_spec_t no_combine = { sizeof(int), NULL, sizeof(int), NULL, NULL };
+    TEST_ASSERT(elegant_group_by(arr, &no_combine, &groups) == EINVAL, "values without a combine");
+
+    TEST_ASSERT(elegant_group_by(NULL, &no_key, &groups) == EINVAL, "NULL source");
+    TEST_ASSERT(elegant_group_by(arr, NULL, &groups) == EINVAL, "NULL spec");
+    TEST_ASSERT(elegant_distinct(NULL) == NULL, "DISTINCT of NULL");
+    elegant_groups_destroy(&groups);
+    elegant_array_destroy(arr);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    elegant_parallel_set_threads(4);
+
+    TEST_RUN(test_small_input);
+    TEST_RUN(test_partitioned_input);
+    TEST_RUN(test_single_thread_input);
+    TEST_RUN(test_distinct);
+    TEST_RUN(test_struct_keys);
+    TEST_RUN(test_invalid_specs);
+
+    elegant_parallel_shutdown();
+    return test_end();
+}
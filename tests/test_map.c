@@ -0,0 +1,65 @@
+/*
+ * Elegant Library - file-mapped array tests
+ * Whole-file and offset mappings, copy-on-write of mapped data, and
+ * ranges past the end of the file refused instead of faulting later.
+ */
+
+#include "test_common.h"
+
+#define FILE_INTS 3000   /* a little under three pages */
+
+static FILE* make_file(void) {
+    FILE* file = tmpfile();
+    for (int i = 0; file && i < FILE_INTS; i++) fwrite(&i, sizeof(int), 1, file);
+    if (file) fflush(file);
+    return file;
+}
+
+static void test_map_ranges(void) {
+    FILE* file = make_file();
+    TEST_ASSERT(file != NULL, "create a temporary file");
+    if (!file) return;
+    int fd = fileno(file);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    elegant_array_t* all = elegant_array_map_fd(fd, 0, sizeof(int), FILE_INTS, 0);
+    TEST_ASSERT(all && elegant_array_is_mapped(all) && ELEGANT_GET(all, FILE_INTS - 1, int) == FILE_INTS - 1,
+                "map the whole file");
+
+    size_t skipped = page / sizeof(int);
+    elegant_array_t* tail = elegant_array_map_fd(fd, page, sizeof(int), FILE_INTS - skipped, 0);
+    TEST_ASSERT(tail && ELEGANT_GET(tail, 0, int) == (int)skipped, "map from a page offset");
+
+    int* data = elegant_array_get_mutable_data(all);
+    data[0] = -1;
+    TEST_ASSERT(ELEGANT_GET(all, 0, int) == -1, "mapped data can be written");
+    int on_disk = 0;
+    TEST_ASSERT(lseek(fd, 0, SEEK_SET) == 0 && read(fd, &on_disk, sizeof(int)) == sizeof(int) && on_disk == 0,
+                "the file is not modified");
+
+    errno = 0;
+    TEST_ASSERT(elegant_array_map_fd(fd, 0, sizeof(int), FILE_INTS + 1, 0) == NULL && errno == EINVAL,
+                "length past the end of the file is refused");
+    errno = 0;
+    TEST_ASSERT(elegant_array_map_fd(fd, 4 * page, sizeof(int), 1, 0) == NULL && errno == EINVAL,
+                "offset past the end of the file is refused");
+    TEST_ASSERT(elegant_array_map_fd(fd, 1, sizeof(int), 1, 0) == NULL && errno == EINVAL,
+                "unaligned offset");
+
+    elegant_array_t* empty = elegant_array_map_fd(fd, 4 * page, sizeof(int), 0, 0);
+    TEST_ASSERT(empty && elegant_array_get_length(empty) == 0, "empty mapping anywhere");
+
+    elegant_array_destroy(empty);
+    elegant_array_destroy(tail);
+    elegant_array_destroy(all);
+    fclose(file);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    TEST_RUN(test_map_ranges);
+
+    return test_end();
+}
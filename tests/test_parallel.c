@@ -0,0 +1,151 @@
+/*
+ * Elegant Library - thread pool tests
+ * Parallel MAP/FILTER/REDUCE against the sequential path, parallel_for
+ * coverage, and nested parallel calls from callbacks on every participant.
+ */
+
+#include "test_common.h"
+
+#define TEST_LENGTH 300001
+
+static elegant_array_t* make_ints(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(int), n);
+    int* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = (int)(i * 7919 % 100003);
+    return arr;
+}
+
+static int same_ints(elegant_array_t* a, elegant_array_t* b) {
+    if (!a || !b || elegant_array_get_length(a) != elegant_array_get_length(b)) return 0;
+    const int* x = elegant_array_get_data(a);
+    const int* y = elegant_array_get_data(b);
+    for (size_t i = 0; i < elegant_array_get_length(a); i++) {
+        if (x[i] != y[i]) return 0;
+    }
+    return 1;
+}
+
+static void test_matches_sequential(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+
+    elegant_array_t* seq_map = MAP(src, x * 3 + 1, int);
+    elegant_array_t* par_map = PAR_MAP(src, x * 3 + 1, int);
+    TEST_ASSERT(same_ints(seq_map, par_map), "PAR_MAP matches MAP");
+
+    elegant_array_t* seq_filter = FILTER(src, x % 3 == 0, int);
+    elegant_array_t* par_filter = PAR_FILTER(src, x % 3 == 0, int);
+    TEST_ASSERT(same_ints(seq_filter, par_filter), "PAR_FILTER keeps FILTER's order");
+
+    elegant_array_t* none = PAR_FILTER(src, x < 0, int);
+    TEST_ASSERT(none && elegant_array_get_length(none) == 0, "PAR_FILTER with no matches");
+
+    int seq_xor = REDUCE(src, acc ^ x, 0, int);
+    int par_xor = PAR_REDUCE(src, acc ^ x, 0, int);
+    TEST_ASSERT(par_xor == seq_xor, "PAR_REDUCE matches REDUCE");
+
+    int max = PAR_REDUCE(src, acc > x ? acc : x, -1, int);
+    TEST_ASSERT(max == 100002, "PAR_REDUCE maximum");
+
+    elegant_array_destroy(seq_map);
+    elegant_array_destroy(par_map);
+    elegant_array_destroy(seq_filter);
+    elegant_array_destroy(par_filter);
+    elegant_array_destroy(none);
+    elegant_array_destroy(src);
+}
+
+static int calls[4096];
+
+static void count_block(void* ctx, size_t block) {
+    (void)ctx;
+    __atomic_fetch_add(&calls[block], 1, __ATOMIC_RELAXED);
+}
+
+static void test_parallel_for(void) {
+    TEST_ASSERT(elegant_parallel_for(4096, count_block, NULL) == 0, "parallel_for runs");
+    int once = 1;
+    for (size_t i = 0; i < 4096; i++) once &= calls[i] == 1;
+    TEST_ASSERT(once, "parallel_for visits every block once");
+    TEST_ASSERT(elegant_parallel_for(0, count_block, NULL) == 0, "parallel_for over no blocks");
+    TEST_ASSERT(elegant_parallel_for(1, NULL, NULL) == EINVAL, "parallel_for without a body");
+}
+
+/* Called from map callbacks, on workers and on the submitting thread */
+static elegant_array_t* nested_src;
+static __thread int on_submitter;
+static int submitter_nested;
+
+static int nested_work(void) {
+    if (on_submitter) __atomic_store_n(&submitter_nested, 1, __ATOMIC_RELAXED);
+    int ok = elegant_parallel_get_threads() == 1;
+    ok &= elegant_parallel_set_threads(2) == EBUSY;
+    ok &= elegant_parallel_for(8, count_block, NULL) == EAGAIN;
+
+    elegant_array_t* inner = PAR_MAP(nested_src, x + 1, int);
+    ok &= inner && elegant_array_get_length(inner) == elegant_array_get_length(nested_src);
+    ok &= ELEGANT_GET(inner, 1, int) == ELEGANT_GET(nested_src, 1, int) + 1;
+    elegant_array_destroy(inner);
+    return ok;
+}
+
+static void test_nested_calls(void) {
+    nested_src = make_ints(200000);
+    elegant_array_t* outer = make_ints(TEST_LENGTH);
+    int* data = elegant_array_get_mutable_data(outer);
+    /* Markers in every block, so whichever participant runs one nests */
+    for (size_t i = 0; i < TEST_LENGTH; i += 1000) data[i] = -1;
+
+    on_submitter = 1;
+    elegant_array_t* result = PAR_MAP(outer, x == -1 ? nested_work() : 1, int);
+    on_submitter = 0;
+    TEST_ASSERT(result != NULL, "outer PAR_MAP completes");
+
+    int all = result != NULL;
+    for (size_t i = 0; result && i < TEST_LENGTH; i++) all &= ELEGANT_GET(result, i, int) == 1;
+    TEST_ASSERT(all, "nested calls see a sequential pool");
+    TEST_ASSERT(submitter_nested, "nested call from the submitting thread");
+
+    elegant_array_destroy(result);
+    elegant_array_destroy(outer);
+    elegant_array_destroy(nested_src);
+    TEST_ASSERT(elegant_parallel_get_threads() == 4, "pool size restored after the job");
+}
+
+static void test_scoped_results(void) {
+    ELEGANT_SET_MODE(STACK_ARENA);
+    ELEGANT_SCOPE {
+        elegant_array_t* src = make_ints(TEST_LENGTH);
+        elegant_array_t* par = PAR_MAP(src, x - 5, int);
+        elegant_array_t* seq = MAP(src, x - 5, int);
+        TEST_ASSERT(same_ints(par, seq), "PAR_MAP inside an arena scope");
+    }
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+}
+
+static void test_single_thread(void) {
+    TEST_ASSERT(elegant_parallel_set_threads(1) == 0, "shrink the pool");
+    TEST_ASSERT(elegant_parallel_for(4, count_block, NULL) == EAGAIN, "one thread runs nothing");
+
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_array_t* par = PAR_FILTER(src, x & 1, int);
+    elegant_array_t* seq = FILTER(src, x & 1, int);
+    TEST_ASSERT(same_ints(par, seq), "PAR_FILTER on a single-thread pool");
+    elegant_array_destroy(par);
+    elegant_array_destroy(seq);
+    elegant_array_destroy(src);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    elegant_parallel_set_threads(4);
+
+    TEST_RUN(test_matches_sequential);
+    TEST_RUN(test_parallel_for);
+    TEST_RUN(test_nested_calls);
+    TEST_RUN(test_scoped_results);
+    TEST_RUN(test_single_thread);
+
+    elegant_parallel_shutdown();
+    return test_end();
+}
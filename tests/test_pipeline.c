@@ -0,0 +1,210 @@
+/*
+ * Elegant Library - overlapped pipeline tests
+ * Stage output against the sequential MAP/FILTER path, early stops from a
+ * sink, stage and source errors, and shutdown before and during a run.
+ */
+
+#include "test_common.h"
+
+#define TEST_LENGTH 300001
+#define CHUNK 4096
+
+static elegant_array_t* make_ints(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(int), n);
+    int* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = (int)(i * 7919 % 100003);
+    return arr;
+}
+
+static void test_matches_sequential(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(elegant_stream_from_array(src, CHUNK), 3);
+    TEST_ASSERT(pipeline != NULL, "create pipeline");
+    TEST_ASSERT(PIPELINE_MAP(pipeline, x * 3 + 1, int) == 0, "add map stage");
+    TEST_ASSERT(PIPELINE_FILTER(pipeline, x % 4 == 0, int) == 0, "add filter stage");
+    TEST_ASSERT(PIPELINE_MAP_TO(pipeline, x * 1000LL, int, long long) == 0, "add widening stage");
+    elegant_array_t* piped = elegant_pipeline_collect(pipeline);
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == 0, "close after collect");
+
+    elegant_array_t* mapped = MAP(src, x * 3 + 1, int);
+    elegant_array_t* filtered = FILTER(mapped, x % 4 == 0, int);
+    size_t n = elegant_array_get_length(filtered);
+    int same = piped && elegant_array_get_length(piped) == n && piped->element_size == sizeof(long long);
+    for (size_t i = 0; same && i < n; i++) {
+        same &= ELEGANT_GET(piped, i, long long) == ELEGANT_GET(filtered, i, int) * 1000LL;
+    }
+    TEST_ASSERT(same, "pipeline matches MAP/FILTER in order");
+
+    elegant_array_destroy(piped);
+    elegant_array_destroy(filtered);
+    elegant_array_destroy(mapped);
+    elegant_array_destroy(src);
+}
+
+static void test_next_chunks(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(elegant_stream_from_array(src, CHUNK), 0);
+    PIPELINE_MAP(pipeline, x + 1, int);
+
+    size_t seen = 0;
+    int in_order = 1;
+    for (elegant_array_t* chunk; (chunk = elegant_pipeline_next(pipeline)); ) {
+        for (size_t i = 0; i < elegant_array_get_length(chunk); i++, seen++) {
+            in_order &= ELEGANT_GET(chunk, i, int) == ELEGANT_GET(src, seen, int) + 1;
+        }
+    }
+    TEST_ASSERT(seen == TEST_LENGTH && in_order, "next yields every element in order");
+    TEST_ASSERT(elegant_pipeline_next(pipeline) == NULL, "next stays at the end");
+    TEST_ASSERT(PIPELINE_MAP(pipeline, x, int) == EBUSY, "no stages once started");
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == 0, "clean end");
+    elegant_array_destroy(src);
+}
+
+typedef struct {
+    int chunks;
+    int stop_after;
+} sink_state_t;
+
+static int stopping_sink(void* ctx, elegant_array_t* chunk) {
+    sink_state_t* state = ctx;
+    (void)chunk;
+    return ++state->chunks == state->stop_after ? 42 : 0;
+}
+
+static void test_sink_stops_early(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(elegant_stream_from_array(src, CHUNK), 2);
+    PIPELINE_MAP(pipeline, x * 2, int);
+
+    sink_state_t state = { 0, 3 };
+    TEST_ASSERT(elegant_pipeline_drain(pipeline, stopping_sink, &state) == 42, "sink result ends drain");
+    TEST_ASSERT(state.chunks == 3, "sink is not called after stopping");
+    TEST_ASSERT(elegant_pipeline_error(pipeline) == 42, "sink result becomes the error");
+    TEST_ASSERT(elegant_pipeline_next(pipeline) == NULL, "stopped pipeline yields nothing");
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == 42, "close reports the error");
+    elegant_array_destroy(src);
+}
+
+/* Copies chunks through and fails on the fifth */
+static size_t failing_stage(void* ctx, const void* in, size_t count, void* out, size_t capacity) {
+    int* calls = ctx;
+    (void)capacity;
+    if (++*calls == 5) {
+        errno = EIO;
+        return ELEGANT_STREAM_ERROR;
+    }
+    memcpy(out, in, count * sizeof(int));
+    return count;
+}
+
+static int count_sink(void* ctx, elegant_array_t* chunk) {
+    *(size_t*)ctx += elegant_array_get_length(chunk);
+    return 0;
+}
+
+static void test_stage_error(void) {
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(elegant_stream_from_array(src, CHUNK), 2);
+    int calls = 0;
+    TEST_ASSERT(elegant_pipeline_stage(pipeline, failing_stage, &calls, sizeof(int), sizeof(int)) == 0,
+                "add custom stage");
+    PIPELINE_MAP(pipeline, x - 1, int);
+
+    size_t received = 0;
+    TEST_ASSERT(elegant_pipeline_drain(pipeline, count_sink, &received) == EIO, "stage errno surfaces");
+    /* Chunks still in flight when a stage fails are dropped, never anything after it */
+    TEST_ASSERT(received <= 4 * CHUNK && received % CHUNK == 0, "nothing past the failure arrives");
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == EIO, "close keeps the stage error");
+    elegant_array_destroy(src);
+}
+
+static int source_calls;
+static int source_released;
+
+static size_t failing_pull(void* ctx, void* buffer, size_t capacity) {
+    (void)ctx;
+    if (++source_calls > 2) {
+        errno = EPROTO;
+        return ELEGANT_STREAM_ERROR;
+    }
+    memset(buffer, 0, capacity * sizeof(int));
+    return capacity;
+}
+
+static void note_release(void* ctx) {
+    (void)ctx;
+    source_released++;
+}
+
+static void test_source_error(void) {
+    source_calls = 0;
+    source_released = 0;
+    elegant_stream_t* stream = elegant_stream_create(sizeof(int), 64, failing_pull, NULL, note_release);
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(stream, 0);
+    PIPELINE_FILTER(pipeline, x == 0, int);
+
+    size_t received = 0;
+    TEST_ASSERT(elegant_pipeline_drain(pipeline, count_sink, &received) == EPROTO, "source errno surfaces");
+    TEST_ASSERT(received <= 128 && received % 64 == 0, "nothing past the failure arrives");
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == EPROTO && source_released == 1, "source closed once");
+}
+
+static void test_stage_arguments(void) {
+    elegant_array_t* src = make_ints(100);
+    elegant_pipeline_t* pipeline = elegant_pipeline_create(elegant_stream_from_array(src, 16), 0);
+    int calls = 0;
+    TEST_ASSERT(elegant_pipeline_stage(pipeline, failing_stage, &calls, sizeof(double), sizeof(int)) == EINVAL,
+                "input size must match the previous output");
+    TEST_ASSERT(elegant_pipeline_stage(pipeline, NULL, NULL, sizeof(int), sizeof(int)) == EINVAL,
+                "stage function required");
+    TEST_ASSERT(PIPELINE_MAP_TO(pipeline, (double)x, int, double) == 0, "change element type");
+    TEST_ASSERT(PIPELINE_FILTER(pipeline, x > 0, int) == EINVAL, "filter of the old type is refused");
+    TEST_ASSERT(elegant_pipeline_create(NULL, 0) == NULL, "pipeline needs a source");
+    TEST_ASSERT(elegant_pipeline_close(pipeline) == 0, "refused stages leave no error");
+    elegant_array_destroy(src);
+}
+
+static void test_shutdown(void) {
+    /* Never started: closing joins nothing and closes the source */
+    source_calls = 0;
+    source_released = 0;
+    elegant_pipeline_t* idle = elegant_pipeline_create(
+        elegant_stream_create(sizeof(int), 64, failing_pull, NULL, note_release), 0);
+    PIPELINE_MAP(idle, x + 1, int);
+    TEST_ASSERT(elegant_pipeline_close(idle) == 0 && source_released == 1 && source_calls == 0,
+                "close before start");
+
+    /* Mid-run: stages blocked on full links must still be stopped */
+    elegant_array_t* src = make_ints(TEST_LENGTH);
+    elegant_pipeline_t* running = elegant_pipeline_create(elegant_stream_from_array(src, 256), 1);
+    PIPELINE_MAP(running, x + 1, int);
+    PIPELINE_MAP(running, x + 1, int);
+    elegant_array_t* first = elegant_pipeline_next(running);
+    TEST_ASSERT(first && ELEGANT_GET(first, 0, int) == ELEGANT_GET(src, 0, int) + 2, "first chunk");
+    TEST_ASSERT(elegant_pipeline_close(running) == 0, "close mid-run");
+    elegant_array_destroy(src);
+
+    elegant_array_t* empty = elegant_array_create(sizeof(int), 0);
+    elegant_pipeline_t* nothing = elegant_pipeline_create(elegant_stream_from_array(empty, 16), 0);
+    elegant_array_t* collected = elegant_pipeline_collect(nothing);
+    TEST_ASSERT(collected && elegant_array_get_length(collected) == 0, "collect of an empty source");
+    TEST_ASSERT(elegant_pipeline_close(nothing) == 0, "close after an empty run");
+    elegant_array_destroy(collected);
+    elegant_array_destroy(empty);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    TEST_RUN(test_matches_sequential);
+    TEST_RUN(test_next_chunks);
+    TEST_RUN(test_sink_stops_early);
+    TEST_RUN(test_stage_error);
+    TEST_RUN(test_source_error);
+    TEST_RUN(test_stage_arguments);
+    TEST_RUN(test_shutdown);
+
+    return test_end();
+}
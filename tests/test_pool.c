@@ -0,0 +1,228 @@
+/*
+ * Elegant Library - slab pool tests
+ * Size-class alignment and reuse, large spans, reset, mark/rewind with
+ * blocks freed around a mark and nested marks, slot canaries, and arrays
+ * served from a pool with the libc fallback.
+ */
+
+#include "test_common.h"
+#include <stdint.h>
+
+#define POOL_BYTES (64 * 1024)
+
+static int in_pool(const elegant_safe_pool_t* pool, const void* ptr) {
+    const char* base = pool->base;
+    return (const char*)ptr >= base && (const char*)ptr < base + pool->size;
+}
+
+static void test_classes(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(POOL_BYTES);
+    TEST_ASSERT(pool != NULL, "create pool");
+
+    int aligned = 1;
+    for (size_t size = 1; size <= ELEGANT_POOL_MAX_SLOT; size *= 3) {
+        size_t slot = ELEGANT_POOL_ALIGN;
+        while (slot < size) slot *= 2;
+        void* ptr = elegant_pool_alloc(pool, size);
+        aligned &= ptr && (uintptr_t)ptr % slot == 0 && in_pool(pool, ptr);
+        elegant_pool_free(pool, ptr);
+    }
+    TEST_ASSERT(aligned, "slots are aligned to their class");
+
+    void* a = elegant_pool_alloc(pool, 100);
+    void* b = elegant_pool_alloc(pool, 100);
+    TEST_ASSERT(a && b && a != b && pool->live_allocations == 2, "two live slots");
+    elegant_pool_free(pool, a);
+    TEST_ASSERT(elegant_pool_alloc(pool, 120) == a, "freed slot is reused by its class");
+
+    size_t doubles = elegant_safety_stats.double_free_detected;
+    elegant_pool_free(pool, b);
+    elegant_pool_free(pool, b);
+    elegant_pool_free(pool, (char*)a + 16);
+    TEST_ASSERT(elegant_safety_stats.double_free_detected == doubles + 2,
+                "double and interior frees are refused");
+
+    void* big = elegant_pool_alloc(pool, 10000);
+    TEST_ASSERT(big && (uintptr_t)big % ELEGANT_POOL_ALIGN == 0, "large block spans runs");
+    memset(big, 0x5A, 10000);
+    elegant_pool_free(pool, big);
+    TEST_ASSERT(elegant_pool_alloc(pool, 9000) == big, "released span is reused");
+
+    TEST_ASSERT(elegant_pool_alloc(pool, 0) == NULL, "zero bytes");
+    TEST_ASSERT(elegant_pool_alloc(pool, 2 * POOL_BYTES) == NULL, "request larger than the pool");
+    elegant_destroy_safe_pool(pool);
+}
+
+static void test_reset_and_rewind(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(POOL_BYTES);
+
+    size_t count = 0;
+    void* first = elegant_pool_alloc(pool, 4096);
+    for (void* ptr = first; ptr; ptr = elegant_pool_alloc(pool, 4096)) count++;
+    TEST_ASSERT(count > 1 && pool->live_allocations == count, "allocate until exhausted");
+
+    elegant_pool_reset(pool);
+    TEST_ASSERT(pool->live_allocations == 0 && pool->used == 0, "reset empties the pool");
+    TEST_ASSERT(elegant_pool_alloc(pool, 4096) == first, "reset reuses the region from the start");
+
+    void* kept = elegant_pool_alloc(pool, 64);
+    size_t mark = elegant_pool_mark(pool);
+    size_t live = pool->live_allocations;
+
+    void* later = elegant_pool_alloc(pool, 256);
+    void* later_big = elegant_pool_alloc(pool, 20000);
+    void* later_slot = elegant_pool_alloc(pool, 512);
+    TEST_ASSERT(later && later_big && later_slot && pool->used > mark, "allocate past the mark");
+
+    elegant_pool_rewind(pool, mark);
+    TEST_ASSERT(pool->used == mark && pool->live_allocations == live && pool->mark_count == 0,
+                "rewind drops allocations after the mark");
+    TEST_ASSERT(elegant_pool_alloc(pool, 256) == later, "rewound runs are carved again");
+
+    /* Allocations before the mark survive and can still be freed */
+    memset(kept, 1, 64);
+    elegant_pool_free(pool, kept);
+    TEST_ASSERT(pool->live_allocations == live, "kept block frees normally");
+
+    size_t used = pool->used;
+    elegant_pool_rewind(pool, mark);
+    TEST_ASSERT(pool->used == used, "a mark only rewinds once");
+    elegant_destroy_safe_pool(pool);
+}
+
+static void test_rewind_reused_slots(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(POOL_BYTES);
+    void* freed = elegant_pool_alloc(pool, 64);
+    void* kept = elegant_pool_alloc(pool, 64);
+    void* freed_big = elegant_pool_alloc(pool, 10000);
+    elegant_pool_free(pool, freed);
+    elegant_pool_free(pool, freed_big);
+
+    /* Slots and spans freed before the mark are not handed out after it */
+    size_t mark = elegant_pool_mark(pool);
+    size_t live = pool->live_allocations;
+    void* slot = elegant_pool_alloc(pool, 64);
+    void* big = elegant_pool_alloc(pool, 10000);
+    TEST_ASSERT(slot != freed && big != freed_big && in_pool(pool, slot) && in_pool(pool, big),
+                "allocations after a mark start past it");
+
+    /* Blocks from before the mark are held while it is active */
+    elegant_pool_free(pool, kept);
+    TEST_ASSERT(elegant_pool_alloc(pool, 64) != kept, "blocks freed under a mark wait for the rewind");
+
+    elegant_pool_rewind(pool, mark);
+    TEST_ASSERT(pool->live_allocations == live - 1, "rewind drops every allocation made after the mark");
+
+    /* The first run's slots were all held; they now come back before any new run */
+    int below = 1, saw_freed = 0, saw_kept = 0;
+    for (size_t i = 0; i < ELEGANT_POOL_RUN_SIZE / 64; i++) {
+        void* again = elegant_pool_alloc(pool, 64);
+        below &= (char*)again < (char*)pool->base + mark;
+        saw_freed |= again == freed;
+        saw_kept |= again == kept;
+    }
+    TEST_ASSERT(below && saw_freed && saw_kept, "held slots are reused after the rewind");
+    TEST_ASSERT(elegant_pool_alloc(pool, 10000) == freed_big, "held spans are reused after the rewind");
+    elegant_destroy_safe_pool(pool);
+}
+
+static void test_nested_marks(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(POOL_BYTES);
+    void* base = elegant_pool_alloc(pool, 32);
+
+    size_t outer = elegant_pool_mark(pool);
+    void* outer_block = elegant_pool_alloc(pool, 32);
+    size_t inner = elegant_pool_mark(pool);
+    void* inner_block = elegant_pool_alloc(pool, 32);
+    elegant_pool_free(pool, outer_block);
+
+    elegant_pool_rewind(pool, inner);
+    TEST_ASSERT(pool->live_allocations == 1 && pool->mark_count == 1, "inner rewind keeps the outer mark");
+    int reused = 0;
+    for (size_t i = 0; i < ELEGANT_POOL_RUN_SIZE / 32 && !reused; i++) {
+        void* again = elegant_pool_alloc(pool, 32);
+        reused = again == outer_block;
+    }
+    TEST_ASSERT(reused && inner_block, "blocks above the outer mark are reused");
+
+    elegant_pool_free(pool, base);
+    TEST_ASSERT(elegant_pool_alloc(pool, 32) != base, "blocks below the outer mark stay held");
+
+    elegant_pool_rewind(pool, outer);
+    TEST_ASSERT(pool->live_allocations == 0 && pool->used == outer && pool->mark_count == 0,
+                "outer rewind drops both levels");
+
+    for (size_t i = 0; i < ELEGANT_POOL_MARKS; i++) {
+        elegant_pool_mark(pool);
+        elegant_pool_alloc(pool, 4096);
+    }
+    TEST_ASSERT(elegant_pool_mark(pool) == SIZE_MAX, "marks are bounded");
+    elegant_pool_rewind(pool, outer);
+    TEST_ASSERT(pool->mark_count == 0, "rewinding the first mark ends the rest");
+    elegant_destroy_safe_pool(pool);
+}
+
+static void test_canaries(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool_ex(POOL_BYTES, ELEGANT_POOL_CANARIES);
+    size_t overflows = elegant_safety_stats.buffer_overflow_detected;
+
+    /* 24 bytes plus the canary fill a 32-byte slot exactly */
+    char* ok = elegant_pool_alloc(pool, 24);
+    memset(ok, 0xAB, 24);
+    elegant_pool_free(pool, ok);
+    TEST_ASSERT(elegant_safety_stats.buffer_overflow_detected == overflows, "in-bounds writes pass");
+
+    char* bad = elegant_pool_alloc(pool, 24);
+    bad[24] = 0;
+    elegant_pool_free(pool, bad);
+    TEST_ASSERT(elegant_safety_stats.buffer_overflow_detected == overflows + 1, "tail overrun is caught");
+
+    char* big = elegant_pool_alloc(pool, 8000);
+    big[8000] = 0;
+    elegant_pool_free(pool, big);
+    TEST_ASSERT(elegant_safety_stats.buffer_overflow_detected == overflows + 1,
+                "large block pads before its canary");
+    elegant_destroy_safe_pool(pool);
+}
+
+static void test_array_pool(void) {
+    elegant_safe_pool_t* pool = elegant_create_safe_pool(POOL_BYTES);
+    elegant_set_array_pool(pool);
+    TEST_ASSERT(elegant_get_array_pool() == pool, "pool is the thread's allocator");
+
+    elegant_array_t* small = elegant_create_array_int(1, 2, 3);
+    elegant_array_t* mapped = MAP(small, x * 2, int);
+    TEST_ASSERT(in_pool(pool, small) && in_pool(pool, mapped), "arrays come from the pool");
+    TEST_ASSERT(ELEGANT_GET(mapped, 2, int) == 6, "pooled arrays work");
+
+    /* Too big for the pool: served by libc, freed back to it */
+    elegant_array_t* huge = elegant_array_create(sizeof(double), POOL_BYTES);
+    TEST_ASSERT(huge && !in_pool(pool, elegant_array_get_data(huge)), "full pool falls back to libc");
+    for (size_t i = 0; i < 1000; i++) ELEGANT_SET(huge, i, (double)i, double);
+    elegant_array_destroy(huge);
+
+    elegant_array_destroy(mapped);
+    elegant_array_destroy(small);
+    TEST_ASSERT(pool->live_allocations == 0, "destroyed arrays return their slots");
+
+    elegant_set_array_pool(NULL);
+    TEST_ASSERT(elegant_get_array_pool() == NULL, "NULL restores libc");
+    elegant_array_t* plain = elegant_create_array_int(4);
+    TEST_ASSERT(!in_pool(pool, plain), "arrays leave the pool once it is unset");
+    elegant_array_destroy(plain);
+    elegant_destroy_safe_pool(pool);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    TEST_RUN(test_classes);
+    TEST_RUN(test_reset_and_rewind);
+    TEST_RUN(test_rewind_reused_slots);
+    TEST_RUN(test_nested_marks);
+    TEST_RUN(test_canaries);
+    TEST_RUN(test_array_pool);
+
+    return test_end();
+}
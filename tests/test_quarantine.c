@@ -0,0 +1,188 @@
+/*
+ * Elegant Library - quarantine tests
+ * Freed blocks stay detectable until CAPACITY later frees evict them, a
+ * flush releases everything, concurrent frees keep the set consistent, and
+ * lookups racing a protected free never touch a protected header.
+ */
+
+#include "test_common.h"
+#include <pthread.h>
+#include <signal.h>
+#include <setjmp.h>
+
+#define THREADS 4
+#define FREES_PER_THREAD 20000
+
+static void test_freed_pointer_detected(void) {
+    elegant_safety_flush_quarantine();
+    int* live = elegant_safe_malloc(sizeof(int) * 4);
+    int* dead = elegant_safe_malloc(sizeof(int) * 4);
+    TEST_ASSERT(live && dead, "allocate");
+
+    elegant_safe_free(dead);
+    TEST_ASSERT(elegant_is_freed_pointer(dead), "freed pointer is quarantined");
+    TEST_ASSERT(!elegant_is_freed_pointer(live), "live pointer is not");
+    TEST_ASSERT(!elegant_validate_pointer(dead), "freed pointer fails validation");
+    TEST_ASSERT(elegant_validate_pointer(live), "live pointer validates");
+
+    size_t doubles = elegant_safety_stats.double_free_detected;
+    elegant_safe_free(dead);
+    TEST_ASSERT(elegant_safety_stats.double_free_detected == doubles + 1, "double free is caught");
+
+    elegant_safe_free(live);
+    elegant_safety_flush_quarantine();
+}
+
+static void test_fifo_eviction(void) {
+    elegant_safety_flush_quarantine();
+    void* first = elegant_safe_malloc(32);
+    elegant_safe_free(first);
+
+    int held = 1;
+    for (size_t i = 1; i < ELEGANT_QUARANTINE_CAPACITY; i++) {
+        elegant_safe_free(elegant_safe_malloc(32));
+        held &= elegant_is_freed_pointer(first);
+    }
+    TEST_ASSERT(held, "oldest block held while the ring fills");
+
+    void* last = elegant_safe_malloc(32);
+    elegant_safe_free(last);
+    TEST_ASSERT(!elegant_is_freed_pointer(first), "oldest block evicted once the ring is full");
+    TEST_ASSERT(elegant_is_freed_pointer(last), "newest block quarantined");
+
+    elegant_safety_flush_quarantine();
+    TEST_ASSERT(!elegant_is_freed_pointer(last), "flush releases every block");
+}
+
+static sigjmp_buf fault_jump;
+
+static void on_fault(int sig) {
+    (void)sig;
+    siglongjmp(fault_jump, 1);
+}
+
+static void test_protected_blocks_fault(void) {
+    elegant_safety_set_quarantine_protect(true);
+    volatile char* dead = elegant_safe_malloc(64);
+    elegant_safe_free((void*)dead);
+
+    struct sigaction action, old_segv, old_bus;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_fault;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &old_segv);
+    sigaction(SIGBUS, &action, &old_bus);
+
+    volatile int faulted = 0;
+    if (sigsetjmp(fault_jump, 1) == 0) {
+        (void)dead[0];
+    } else {
+        faulted = 1;
+    }
+    sigaction(SIGSEGV, &old_segv, NULL);
+    sigaction(SIGBUS, &old_bus, NULL);
+    TEST_ASSERT(faulted, "stale read of a protected block faults");
+
+    elegant_safety_set_quarantine_protect(false);
+    elegant_safety_flush_quarantine();
+    char* reused = elegant_safe_malloc(64);
+    reused[0] = 1;
+    TEST_ASSERT(reused[0] == 1, "flushed blocks are usable again");
+    elegant_safe_free(reused);
+    elegant_safety_flush_quarantine();
+}
+
+#define RACED_FREES (ELEGANT_QUARANTINE_CAPACITY / 2)   /* never enough to evict */
+#define RACED_ROUNDS 20
+
+static void* raced_block;
+static int raced_done;
+
+/* Validates whatever block the other thread is freeing right now */
+static void* validate_raced(void* arg) {
+    (void)arg;
+    while (!__atomic_load_n(&raced_done, __ATOMIC_ACQUIRE)) {
+        void* block = __atomic_load_n(&raced_block, __ATOMIC_ACQUIRE);
+        if (block) (void)elegant_validate_pointer(block);
+    }
+    return NULL;
+}
+
+static void test_lookup_races_protected_free(void) {
+    elegant_safety_set_quarantine_protect(true);
+    int quarantined = 1;
+    for (int round = 0; round < RACED_ROUNDS; round++) {
+        elegant_safety_flush_quarantine();
+        __atomic_store_n(&raced_block, NULL, __ATOMIC_RELEASE);
+        __atomic_store_n(&raced_done, 0, __ATOMIC_RELEASE);
+
+        pthread_t checker;
+        pthread_create(&checker, NULL, validate_raced, NULL);
+        for (int i = 0; i < RACED_FREES; i++) {
+            void* block = elegant_safe_malloc(64);
+            __atomic_store_n(&raced_block, block, __ATOMIC_RELEASE);
+            elegant_safe_free(block);
+            quarantined &= elegant_is_freed_pointer(block);
+        }
+        __atomic_store_n(&raced_done, 1, __ATOMIC_RELEASE);
+        pthread_join(checker, NULL);
+    }
+    TEST_ASSERT(quarantined, "lookups during protected frees do not fault");
+
+    elegant_safety_set_quarantine_protect(false);
+    elegant_safety_flush_quarantine();
+}
+
+static int thread_ok[THREADS];
+
+/* Quarantined blocks are not released, so no live block can share an address */
+static void* churn(void* arg) {
+    int id = (int)(size_t)arg;
+    void* keep = elegant_safe_malloc(48);
+    int ok = keep != NULL;
+    for (int i = 0; i < FREES_PER_THREAD; i++) {
+        void* block = elegant_safe_malloc(16 + (size_t)(i % 8) * 8);
+        ok &= !elegant_is_freed_pointer(block);
+        elegant_safe_free(block);
+        ok &= !elegant_is_freed_pointer(keep);
+    }
+    elegant_safe_free(keep);
+    thread_ok[id] = ok;
+    return NULL;
+}
+
+static void test_concurrent_frees(void) {
+    elegant_safety_flush_quarantine();
+    size_t freed = elegant_safety_stats.total_freed;
+    size_t active = elegant_safety_stats.active_allocations;
+
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, churn, (void*)i);
+    for (size_t i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+    int ok = 1;
+    for (size_t i = 0; i < THREADS; i++) ok &= thread_ok[i];
+    TEST_ASSERT(ok, "live blocks are never reported freed");
+    TEST_ASSERT(elegant_safety_stats.total_freed == freed + THREADS * (FREES_PER_THREAD + 1),
+                "every free is counted once");
+    TEST_ASSERT(elegant_safety_stats.active_allocations == active, "allocations balance");
+
+    /* Flush concurrently pushed entries; the set must come out empty */
+    elegant_safety_flush_quarantine();
+    void* probe = elegant_safe_malloc(16);
+    elegant_safe_free(probe);
+    TEST_ASSERT(elegant_is_freed_pointer(probe), "quarantine still works after the churn");
+    elegant_safety_flush_quarantine();
+}
+
+int main(void) {
+    test_begin();
+
+    TEST_RUN(test_freed_pointer_detected);
+    TEST_RUN(test_fifo_eviction);
+    TEST_RUN(test_protected_blocks_fault);
+    TEST_RUN(test_lookup_races_protected_free);
+    TEST_RUN(test_concurrent_frees);
+
+    return test_end();
+}
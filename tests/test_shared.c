@@ -0,0 +1,135 @@
+/*
+ * Elegant Library - shared reference counting tests
+ * Shared arrays and views retained and released from several threads are
+ * freed exactly once, and arrays keep the mode they were created under.
+ */
+
+#include "test_common.h"
+#include <pthread.h>
+
+#define THREADS 4
+#define ROUNDS 100000
+
+static size_t live_bytes(void) {
+    return elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+}
+
+static int destroyed;
+
+static void count_destroy(void* data) {
+    (void)data;
+    __atomic_fetch_add(&destroyed, 1, __ATOMIC_RELAXED);
+}
+
+static elegant_array_t* shared_arr;
+static int sums[THREADS];
+
+/* Each thread starts owning one reference and gives it up when done */
+static void* churn(void* arg) {
+    size_t id = (size_t)arg;
+    int sum = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        elegant_array_t* ref = elegant_array_retain(shared_arr);
+        sum += ELEGANT_GET(ref, (size_t)i % 4, int);
+        elegant_array_release(ref);
+    }
+    elegant_array_t* view = elegant_drop(shared_arr, 2);
+    sum += ELEGANT_GET(view, 0, int);
+    elegant_array_destroy(view);
+
+    sums[id] = sum;
+    elegant_array_release(shared_arr);
+    return NULL;
+}
+
+static void test_cross_thread_refcounts(void) {
+    destroyed = 0;
+    shared_arr = elegant_create_array_int(1, 2, 3, 4);
+    TEST_ASSERT(!elegant_array_is_shared(shared_arr), "arrays start unshared");
+    TEST_ASSERT(elegant_array_share(shared_arr) == shared_arr && elegant_array_is_shared(shared_arr),
+                "share switches to atomic counts");
+    shared_arr->destructor = count_destroy;
+
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        elegant_array_retain(shared_arr);
+        pthread_create(&threads[i], NULL, churn, (void*)i);
+    }
+    elegant_array_release(shared_arr);
+    for (size_t i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+    int ok = 1;
+    for (size_t i = 0; i < THREADS; i++) ok &= sums[i] == ROUNDS / 4 * 10 + 3;
+    TEST_ASSERT(ok, "every thread reads the shared data");
+    TEST_ASSERT(destroyed == 1, "the last release frees the array exactly once");
+}
+
+static void test_shared_views(void) {
+    elegant_array_t* arr = elegant_create_array_int(5, 6, 7);
+    elegant_array_t* view = elegant_take(arr, 2);
+    elegant_array_destroy(arr);
+
+    TEST_ASSERT(elegant_array_share(view) == view, "share a view");
+    TEST_ASSERT(elegant_array_is_shared(view), "a shared view counts atomically");
+
+    elegant_array_t* again = elegant_array_retain(view);
+    elegant_array_release(again);
+    TEST_ASSERT(ELEGANT_GET(view, 1, int) == 6, "view survives its source handle");
+    elegant_array_destroy(view);
+}
+
+static void test_creation_mode(void) {
+    ELEGANT_SET_MODE(SHARED_REFERENCE_COUNTING);
+    elegant_array_t* arr = elegant_create_array_int(1, 2);
+    elegant_array_t* mapped = MAP(arr, x + 1, int);
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    TEST_ASSERT(elegant_array_is_shared(arr) && elegant_array_is_shared(mapped),
+                "arrays created in shared mode start shared");
+    elegant_array_t* plain = elegant_create_array_int(3);
+    TEST_ASSERT(!elegant_array_is_shared(plain), "mode switch applies to new arrays only");
+
+    /* Destroy follows each array's own mode, not the thread's current one */
+    elegant_array_retain(arr);
+    elegant_array_destroy(arr);
+    TEST_ASSERT(ELEGANT_GET(arr, 1, int) == 2, "retained shared array outlives a destroy");
+    elegant_array_destroy(arr);
+    elegant_array_destroy(mapped);
+    elegant_array_destroy(plain);
+}
+
+static void test_share_refused(void) {
+    TEST_ASSERT(elegant_array_share(NULL) == NULL, "share NULL");
+
+    ELEGANT_SET_MODE(STACK_ARENA);
+    ELEGANT_ARENA_SCOPE {
+        elegant_array_t* arr = elegant_create_array_int(1, 2, 3);
+        TEST_ASSERT(elegant_array_share(arr) == NULL && !elegant_array_is_shared(arr),
+                    "arena arrays cannot be shared");
+        elegant_array_t* view = elegant_take(arr, 1);
+        TEST_ASSERT(elegant_array_share(view) == NULL, "views of arena arrays cannot be shared");
+    }
+
+    ELEGANT_SET_MODE(GARBAGE_COLLECTION);
+    elegant_array_t* collected = elegant_create_array_int(1);
+    TEST_ASSERT(elegant_array_share(collected) == NULL, "collected arrays cannot be shared");
+    elegant_array_destroy(collected);
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    elegant_gc_collect();
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+
+    /* The last release may run on any thread, so only the destructor count tells */
+    TEST_RUN(test_cross_thread_refcounts);
+
+    size_t before = live_bytes();
+    TEST_RUN(test_shared_views);
+    TEST_RUN(test_creation_mode);
+    TEST_ASSERT(live_bytes() == before, "shared arrays are fully freed");
+
+    TEST_RUN(test_share_refused);
+    return test_end();
+}
@@ -0,0 +1,248 @@
+/*
+ * Elegant Library - sort and search tests
+ * Radix and merge sorts, sequential and across the pool, against qsort;
+ * stability, special floating-point values, searches and merge join.
+ */
+
+#include "test_common.h"
+#include <limits.h>
+#include <math.h>
+
+#define SMALL_LENGTH 1000
+#define LARGE_LENGTH (ELEGANT_SORT_PARALLEL_MIN * 2 + 17)
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed;
+}
+
+static elegant_array_t* random_ints(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(int), n);
+    int* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = (int)(next_random() ^ (next_random() << 16));
+    if (n > 2) {
+        data[0] = INT_MAX;
+        data[1] = INT_MIN;
+    }
+    return arr;
+}
+
+static int matches_qsort(elegant_array_t* sorted, const void* original, size_t element_size,
+                         int (*compare)(const void*, const void*)) {
+    size_t n = elegant_array_get_length(sorted);
+    char* expected = malloc(n * element_size + 1);
+    memcpy(expected, original, n * element_size);
+    qsort(expected, n, element_size, compare);
+    const char* actual = elegant_array_get_data(sorted);
+    int same = 1;
+    for (size_t i = 0; i < n; i++) same &= compare(expected + i * element_size, actual + i * element_size) == 0;
+    free(expected);
+    return same;
+}
+
+static void check_int_sort(size_t n) {
+    elegant_array_t* arr = random_ints(n);
+    elegant_array_t* original = elegant_array_copy(arr);
+    TEST_ASSERT(elegant_sort_int(arr) == 0, "radix sort ints");
+    TEST_ASSERT(matches_qsort(arr, elegant_array_get_data(original), sizeof(int), elegant_compare_int),
+                "radix sort matches qsort");
+
+    elegant_array_t* merged = elegant_array_copy(original);
+    TEST_ASSERT(elegant_sort(merged, elegant_compare_int) == 0, "merge sort ints");
+    TEST_ASSERT(matches_qsort(merged, elegant_array_get_data(original), sizeof(int), elegant_compare_int),
+                "merge sort matches qsort");
+
+    int reversed = SORT(original, (a < b) - (a > b), int);
+    int descending = reversed == 0;
+    for (size_t i = 1; i < n; i++) descending &= ELEGANT_GET(original, i - 1, int) >= ELEGANT_GET(original, i, int);
+    TEST_ASSERT(descending, "SORT with a descending comparison");
+
+    elegant_array_destroy(merged);
+    elegant_array_destroy(original);
+    elegant_array_destroy(arr);
+}
+
+static void test_int_sorts(void) {
+    check_int_sort(SMALL_LENGTH);
+    check_int_sort(LARGE_LENGTH);
+}
+
+static void check_double_sort(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(double), n);
+    double* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = ((double)next_random() - 2147483648.0) / 1024.0;
+    data[n / 2] = -0.0;
+    data[n / 3] = 0.0;
+    data[n / 4] = INFINITY;
+    data[n / 5] = -INFINITY;
+
+    elegant_array_t* original = elegant_array_copy(arr);
+    TEST_ASSERT(elegant_sort_double(arr) == 0, "radix sort doubles");
+    TEST_ASSERT(matches_qsort(arr, elegant_array_get_data(original), sizeof(double), elegant_compare_double),
+                "double radix sort matches qsort");
+
+    const double* sorted = elegant_array_get_data(arr);
+    size_t zero = elegant_lower_bound_double(arr, 0.0);
+    TEST_ASSERT(sorted[0] == -INFINITY && sorted[n - 1] == INFINITY, "infinities at the ends");
+    TEST_ASSERT(zero + 1 < n && sorted[zero] == 0.0 && signbit(sorted[zero]) &&
+                sorted[zero + 1] == 0.0 && !signbit(sorted[zero + 1]), "-0.0 sorts before 0.0");
+
+    elegant_array_destroy(original);
+    elegant_array_destroy(arr);
+}
+
+static void test_floating_sorts(void) {
+    check_double_sort(SMALL_LENGTH);
+    check_double_sort(LARGE_LENGTH);
+
+    elegant_array_t* floats = elegant_create_array_float(2.5f, NAN, -1.0f, -NAN, 0.0f);
+    TEST_ASSERT(elegant_sort_float(floats) == 0, "radix sort floats");
+    const float* f = elegant_array_get_data(floats);
+    TEST_ASSERT(isnan(f[0]) && signbit(f[0]) && f[1] == -1.0f && f[2] == 0.0f && f[3] == 2.5f &&
+                isnan(f[4]) && !signbit(f[4]),
+                "NaNs go to the end matching their sign");
+    elegant_array_destroy(floats);
+}
+
+typedef struct {
+    int key;
+    int seq;
+} keyed_t;
+
+static int compare_keyed(const void* a, const void* b) {
+    const keyed_t* x = a;
+    const keyed_t* y = b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static void check_stable(size_t n) {
+    elegant_array_t* arr = elegant_array_create(sizeof(keyed_t), n);
+    keyed_t* data = elegant_array_get_mutable_data(arr);
+    for (size_t i = 0; i < n; i++) data[i] = (keyed_t){ (int)(next_random() % 97), (int)i };
+
+    TEST_ASSERT(elegant_sort(arr, compare_keyed) == 0, "merge sort records");
+    const keyed_t* sorted = elegant_array_get_data(arr);
+    int stable = 1;
+    for (size_t i = 1; i < n; i++) {
+        stable &= sorted[i - 1].key < sorted[i].key ||
+                  (sorted[i - 1].key == sorted[i].key && sorted[i - 1].seq < sorted[i].seq);
+    }
+    TEST_ASSERT(stable, "equal keys keep their order");
+    elegant_array_destroy(arr);
+}
+
+static void test_stability(void) {
+    check_stable(SMALL_LENGTH);
+    check_stable(LARGE_LENGTH);
+}
+
+static void test_sorting_views(void) {
+    elegant_array_t* arr = elegant_create_array_int(9, 5, 1, 4, 2, 3);
+    elegant_array_t* view = elegant_drop(arr, 1);
+    TEST_ASSERT(elegant_sort_int(view) == 0, "sort a view");
+
+    int ordered = 1;
+    for (size_t i = 0; i < 5; i++) ordered &= ELEGANT_GET(view, i, int) == (int)i + 1;
+    TEST_ASSERT(ordered, "view is sorted");
+    TEST_ASSERT(ELEGANT_GET(arr, 1, int) == 5 && ELEGANT_GET(arr, 5, int) == 3, "source is untouched");
+
+    elegant_array_t* reversed = elegant_reverse(arr);
+    TEST_ASSERT(elegant_sort_int(arr) == 0 && ELEGANT_GET(reversed, 0, int) == 3 &&
+                ELEGANT_GET(reversed, 5, int) == 9, "reversal is a copy");
+    elegant_array_destroy(reversed);
+
+    elegant_array_destroy(view);
+    elegant_array_destroy(arr);
+}
+
+static void test_searches(void) {
+    elegant_array_t* arr = elegant_create_array_int(1, 3, 3, 3, 7, 9);
+    int key = 3;
+    TEST_ASSERT(elegant_lower_bound(arr, &key, elegant_compare_int) == 1, "lower bound of a run");
+    TEST_ASSERT(elegant_upper_bound(arr, &key, elegant_compare_int) == 4, "upper bound of a run");
+    TEST_ASSERT(elegant_lower_bound_int(arr, 8) == 5, "lower bound between elements");
+    TEST_ASSERT(elegant_lower_bound_int(arr, 10) == 6, "lower bound past the end");
+    TEST_ASSERT(elegant_lower_bound_int(arr, 0) == 0, "lower bound before the start");
+
+    int* found = elegant_binary_search(arr, &key, elegant_compare_int);
+    TEST_ASSERT(found && *found == 3, "binary search finds a match");
+    key = 4;
+    TEST_ASSERT(elegant_binary_search(arr, &key, elegant_compare_int) == NULL, "binary search miss");
+
+    elegant_array_t* empty = elegant_array_create(sizeof(int), 0);
+    TEST_ASSERT(elegant_lower_bound_int(empty, 1) == 0 &&
+                elegant_binary_search(empty, &key, elegant_compare_int) == NULL, "search an empty array");
+    TEST_ASSERT(elegant_sort_int(empty) == 0, "sort an empty array");
+
+    elegant_array_destroy(empty);
+    elegant_array_destroy(arr);
+}
+
+static void test_merge_join(void) {
+    elegant_array_t* left = elegant_create_array_int(1, 2, 2, 4, 6);
+    elegant_array_t* right = elegant_create_array_int(2, 2, 3, 4, 5);
+    elegant_array_t* left_sel = NULL;
+    elegant_array_t* right_sel = NULL;
+
+    TEST_ASSERT(elegant_merge_join(left, right, elegant_compare_int, &left_sel, &right_sel) == 0, "merge join");
+    static const size_t want_left[] = { 1, 1, 2, 2, 3 };
+    static const size_t want_right[] = { 0, 1, 0, 1, 3 };
+    int pairs = left_sel && right_sel && elegant_array_get_length(left_sel) == 5 &&
+                elegant_array_get_length(right_sel) == 5;
+    for (size_t i = 0; pairs && i < 5; i++) {
+        pairs &= ELEGANT_GET(left_sel, i, size_t) == want_left[i] &&
+                 ELEGANT_GET(right_sel, i, size_t) == want_right[i];
+    }
+    TEST_ASSERT(pairs, "equal runs yield their cross product in order");
+    elegant_array_destroy(left_sel);
+    elegant_array_destroy(right_sel);
+
+    elegant_array_t* none = elegant_create_array_int(100);
+    TEST_ASSERT(elegant_merge_join(left, none, elegant_compare_int, &left_sel, &right_sel) == 0 &&
+                elegant_array_get_length(left_sel) == 0 && elegant_array_get_length(right_sel) == 0,
+                "no matches gives empty selections");
+    elegant_array_destroy(left_sel);
+    elegant_array_destroy(right_sel);
+
+    elegant_array_destroy(none);
+    elegant_array_destroy(right);
+    elegant_array_destroy(left);
+}
+
+static void test_invalid_arguments(void) {
+    elegant_array_t* doubles = elegant_create_array_double(1.0, 2.0);
+    elegant_array_t* shorts = elegant_array_create(sizeof(short), 4);
+    elegant_array_t* sel = NULL;
+
+    TEST_ASSERT(elegant_sort_int(NULL) == EINVAL, "sort NULL");
+    TEST_ASSERT(elegant_sort_int(doubles) == EINVAL, "radix sort of the wrong element size");
+    TEST_ASSERT(elegant_sort_float(shorts) == EINVAL, "float sort of shorts");
+    TEST_ASSERT(elegant_sort(doubles, NULL) == EINVAL, "sort without a comparator");
+    TEST_ASSERT(elegant_merge_join(doubles, NULL, elegant_compare_double, &sel, &sel) == EINVAL,
+                "merge join without a right side");
+    TEST_ASSERT(elegant_merge_join(doubles, doubles, elegant_compare_double, NULL, &sel) == EINVAL,
+                "merge join without outputs");
+    TEST_ASSERT(ELEGANT_GET(doubles, 0, double) == 1.0, "refused sort leaves the array alone");
+
+    elegant_array_destroy(shorts);
+    elegant_array_destroy(doubles);
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    elegant_parallel_set_threads(4);
+
+    TEST_RUN(test_int_sorts);
+    TEST_RUN(test_floating_sorts);
+    TEST_RUN(test_stability);
+    TEST_RUN(test_sorting_views);
+    TEST_RUN(test_searches);
+    TEST_RUN(test_merge_join);
+    TEST_RUN(test_invalid_arguments);
+
+    elegant_parallel_shutdown();
+    return test_end();
+}
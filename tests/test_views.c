@@ -0,0 +1,214 @@
+/*
+ * Elegant Library - slice view tests
+ * TAKE/DROP/slice return O(1) views that leave their source as it was;
+ * writes on either side of a view stay on that side, in heap and arena
+ * scopes alike, and several threads may slice one array at once.
+ */
+
+#include "test_common.h"
+#include <pthread.h>
+
+static void test_windows(void) {
+    elegant_array_t* arr = elegant_create_array_int(0, 1, 2, 3, 4, 5);
+    elegant_array_t* take = elegant_take(arr, 4);
+    elegant_array_t* drop = elegant_drop(arr, 2);
+    elegant_array_t* rev = elegant_reverse(arr);
+    elegant_array_t* inner = elegant_take(drop, 2);
+
+    TEST_ASSERT(elegant_array_is_view(take) && elegant_array_is_view(inner), "results are views");
+    TEST_ASSERT(!elegant_array_is_view(arr) && !elegant_array_is_view(rev), "source and reversal are not");
+    TEST_ASSERT(elegant_array_get_length(take) == 4 && elegant_array_get_length(drop) == 4,
+                "window lengths");
+    TEST_ASSERT(ELEGANT_GET(take, 3, int) == 3 && ELEGANT_GET(drop, 0, int) == 2, "window contents");
+    TEST_ASSERT(ELEGANT_GET(rev, 0, int) == 5 && ELEGANT_GET(rev, 5, int) == 0, "reversed order");
+    TEST_ASSERT(ELEGANT_GET(inner, 1, int) == 3, "view of a view");
+    TEST_ASSERT((const int*)elegant_array_get_data(drop) == (const int*)elegant_array_get_data(arr) + 2,
+                "windows point into the source");
+    TEST_ASSERT((arr->flags & ELEGANT_ARRAY_INLINE_DATA) && arr->capacity == 6,
+                "slicing leaves the source's storage alone");
+    elegant_array_t* all = elegant_take(arr, 100);
+    TEST_ASSERT(elegant_array_get_length(all) == 6, "take clamps");
+
+    elegant_array_destroy(all);
+
+    elegant_array_destroy(inner);
+    elegant_array_destroy(rev);
+    elegant_array_destroy(drop);
+    elegant_array_destroy(take);
+    elegant_array_destroy(arr);
+}
+
+static void test_source_writes_stay_put(void) {
+    elegant_array_t* arr = elegant_create_array_int(0, 1, 2, 3, 4, 5);
+    elegant_array_t* take = elegant_take(arr, 4);
+    elegant_array_t* rev = elegant_reverse(arr);
+
+    ELEGANT_SET(arr, 0, 999, int);
+    TEST_ASSERT(ELEGANT_GET(arr, 0, int) == 999, "source takes the write");
+    TEST_ASSERT(ELEGANT_GET(take, 0, int) == 0, "earlier view keeps its value");
+    TEST_ASSERT(ELEGANT_GET(rev, 5, int) == 0, "earlier reversed view keeps its value");
+
+    ELEGANT_SET(take, 1, 11, int);
+    TEST_ASSERT(ELEGANT_GET(arr, 1, int) == 1 && ELEGANT_GET(rev, 4, int) == 1,
+                "write through a view stays in the view");
+
+    elegant_array_t* later = elegant_take(arr, 1);
+    TEST_ASSERT(ELEGANT_GET(later, 0, int) == 999, "later view sees the source's writes");
+
+    elegant_array_destroy(later);
+    elegant_array_destroy(rev);
+    elegant_array_destroy(take);
+
+    /* Nothing reads it any more, so the next write stays in place */
+    const void* data = elegant_array_get_data(arr);
+    ELEGANT_SET(arr, 1, 111, int);
+    TEST_ASSERT(elegant_array_get_data(arr) == data, "unread source writes in place");
+    elegant_array_destroy(arr);
+}
+
+static void test_views_outlive_source(void) {
+    /* One inline source, one with a separate buffer */
+    elegant_array_t* small = elegant_create_array_int(1, 2, 3, 4);
+    elegant_array_t* large = elegant_array_create(sizeof(double), 300000);
+    ELEGANT_SET(large, 299999, 9.0, double);
+
+    elegant_array_t* small_view = elegant_drop(small, 2);
+    elegant_array_t* large_view = elegant_drop(large, 299990);
+    elegant_array_destroy(small);
+    elegant_array_destroy(large);
+
+    TEST_ASSERT(ELEGANT_GET(small_view, 1, int) == 4, "inline source's elements outlive it");
+    TEST_ASSERT(ELEGANT_GET(large_view, 9, double) == 9.0, "separate buffer outlives its source");
+    ELEGANT_SET(small_view, 0, 30, int);
+    TEST_ASSERT(ELEGANT_GET(small_view, 0, int) == 30 && ELEGANT_GET(small_view, 1, int) == 4,
+                "orphaned view detaches on write");
+
+    elegant_array_destroy(small_view);
+    elegant_array_destroy(large_view);
+}
+
+static void test_views_of_written_sources(void) {
+    /* Each write while read leaves a generation behind for its readers alone */
+    elegant_array_t* arr = elegant_array_create(sizeof(int), 4096);
+    elegant_array_t* first = elegant_take(arr, 8);
+    ELEGANT_SET(arr, 0, 1, int);
+    elegant_array_t* second = elegant_take(arr, 8);
+    ELEGANT_SET(arr, 0, 2, int);
+
+    TEST_ASSERT(ELEGANT_GET(first, 0, int) == 0 && ELEGANT_GET(second, 0, int) == 1 &&
+                ELEGANT_GET(arr, 0, int) == 2, "each view keeps its generation");
+    TEST_ASSERT(elegant_array_push(arr, &(int){ 5 }) == 0 && ELEGANT_GET(arr, 4096, int) == 5,
+                "source grows after copying");
+
+    elegant_array_destroy(first);
+    elegant_array_destroy(arr);
+    TEST_ASSERT(ELEGANT_GET(second, 0, int) == 1, "later generation outlives the source");
+    elegant_array_destroy(second);
+}
+
+static void test_mapped_source(void) {
+    FILE* file = tmpfile();
+    int values[1024];
+    for (int i = 0; i < 1024; i++) values[i] = i;
+    TEST_ASSERT(file && fwrite(values, sizeof(int), 1024, file) == 1024 && fflush(file) == 0, "write file");
+
+    elegant_array_t* arr = elegant_array_map_fd(fileno(file), 0, sizeof(int), 1024, 0);
+    elegant_array_t* view = elegant_drop(arr, 1000);
+    TEST_ASSERT(elegant_array_is_mapped(view), "view of a mapping is mapped");
+    ELEGANT_SET(arr, 1000, -1, int);
+    TEST_ASSERT(ELEGANT_GET(view, 0, int) == 1000 && ELEGANT_GET(arr, 1000, int) == -1,
+                "mapped source copies before its write");
+    TEST_ASSERT(elegant_array_is_mapped(view) && !elegant_array_is_mapped(arr),
+                "the view keeps the mapping");
+
+    elegant_array_destroy(arr);
+    elegant_array_destroy(view);
+    fclose(file);
+}
+
+static void test_arena_scope(void) {
+    ELEGANT_SET_MODE(STACK_ARENA);
+    ELEGANT_ARENA_SCOPE {
+        elegant_array_t* arr = elegant_create_array_int(5, 6, 7);
+        elegant_array_t* drop = elegant_drop(arr, 1);
+        ELEGANT_SET(arr, 1, 60, int);
+        TEST_ASSERT(ELEGANT_GET(drop, 0, int) == 6, "arena view keeps its value");
+
+        elegant_array_t* doubled = MAP(drop, x * 2, int);
+        TEST_ASSERT(ELEGANT_GET(doubled, 1, int) == 14, "operations read arena views");
+        TEST_ASSERT(elegant_array_push(arr, &(int){ 8 }) == 0 && ELEGANT_GET(arr, 3, int) == 8,
+                    "arena source grows after detaching");
+    }
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+}
+
+static void test_retained_source(void) {
+    /* Holders of the same array see its writes; its views don't */
+    elegant_array_t* arr = elegant_create_array_int(1, 2, 3);
+    elegant_array_t* held = elegant_array_retain(arr);
+    elegant_array_t* take = elegant_take(arr, 2);
+    ELEGANT_SET(arr, 0, 10, int);
+    TEST_ASSERT(ELEGANT_GET(held, 0, int) == 10, "retained handle reads the write");
+    TEST_ASSERT(ELEGANT_GET(take, 0, int) == 1, "view of a retained source keeps its value");
+    elegant_array_destroy(take);
+    elegant_array_release(held);
+    elegant_array_destroy(arr);
+}
+
+#define SLICE_THREADS 4
+#define SLICE_ROUNDS 200
+
+static elegant_array_t* sliced;
+
+static void* slice_repeatedly(void* arg) {
+    (void)arg;
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    int ok = 1;
+    for (int i = 0; i < 100; i++) {
+        elegant_array_t* view = elegant_drop(sliced, (size_t)i);
+        ok &= view && ELEGANT_GET(view, 0, int) == i;
+        elegant_array_destroy(view);
+    }
+    return ok ? arg : NULL;
+}
+
+static void test_concurrent_slices(void) {
+    /* Readers race to create the source's payload header and count on it */
+    int ok = 1;
+    for (int round = 0; round < SLICE_ROUNDS; round++) {
+        sliced = elegant_array_create(sizeof(int), 100);
+        for (int i = 0; i < 100; i++) ELEGANT_SET(sliced, (size_t)i, i, int);
+
+        pthread_t threads[SLICE_THREADS];
+        for (int t = 0; t < SLICE_THREADS; t++) pthread_create(&threads[t], NULL, slice_repeatedly, &ok);
+        for (int t = 0; t < SLICE_THREADS; t++) {
+            void* result;
+            pthread_join(threads[t], &result);
+            ok &= result != NULL;
+        }
+        ok &= !elegant_array_is_view(sliced);
+        elegant_array_destroy(sliced);
+    }
+    TEST_ASSERT(ok, "threads slice one array at once");
+}
+
+int main(void) {
+    test_begin();
+    ELEGANT_SET_MODE(REFERENCE_COUNTING);
+    size_t before = elegant_get_allocated_bytes() - elegant_get_freed_bytes();
+
+    TEST_RUN(test_windows);
+    TEST_RUN(test_source_writes_stay_put);
+    TEST_RUN(test_views_outlive_source);
+    TEST_RUN(test_views_of_written_sources);
+    TEST_RUN(test_mapped_source);
+    TEST_RUN(test_retained_source);
+
+    TEST_ASSERT(elegant_get_allocated_bytes() - elegant_get_freed_bytes() == before,
+                "views release everything");
+
+    /* Last: other threads' frees and cached arena chunks skew this thread's counts */
+    TEST_RUN(test_concurrent_slices);
+    TEST_RUN(test_arena_scope);
+    return test_end();
+}